@@ -2,7 +2,9 @@
 #define AVLTREE_H
 
 #include "Product.h"
+#include "NodePool.h"
 #include <iostream>
+#include <vector>
 using namespace std;
 
 class AVLNode{
@@ -12,28 +14,39 @@ class AVLNode{
     AVLNode* right;
     int height;
 
-    AVLNode(Product p): data(p), left(nullptr), right(nullptr), height(1){}
+    AVLNode(const Product& p): data(p), left(nullptr), right(nullptr), height(1){}
 };
 
 class AVLTree{
     private:
     AVLNode* root;
+    NodePool<AVLNode> nodePool;  // Owns every AVLNode, freed in bulk on destruction
 
     int getHeight(AVLNode* node);
     int getBalance(AVLNode* node);
     AVLNode* rotateRight(AVLNode* y);
     AVLNode* rotateLeft(AVLNode* x);
-    AVLNode* insertN(AVLNode* node, Product p);
+    AVLNode* insertN(AVLNode* node, const Product& p);
     AVLNode* deleteN(AVLNode* node, int id);
     AVLNode* minNode(AVLNode* node);
     void inorder(AVLNode* node);
+    int checkNode(AVLNode* node, bool hasLow, int low, bool hasHigh, int high, string& problem);
 
     public:
     AVLTree();
-    void insert(Product p);
+    void insert(const Product& p);      // Replaces the product if the ID is present
     void remove(int id);
     Product* search(int id);
     void inorderTraverse();
+
+    // In-order cursor: collect up to limit products (0 = all) with ID > afterId
+    // (or from the smallest ID if !hasAfter), after skipping `skip` of them.
+    // Returns true if more products follow.
+    bool collectAfter(bool hasAfter, int afterId, int skip, int limit, vector<Product>& out);
+
+    // Full walk checking ID order, stored heights and the AVL balance bound;
+    // false with the first violation in problem
+    bool checkInvariants(string& problem);
 };
 
 #endif
\ No newline at end of file
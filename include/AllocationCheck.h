@@ -0,0 +1,17 @@
+#ifndef ALLOCATIONCHECK_H
+#define ALLOCATIONCHECK_H
+
+// Steady-state allocation check for the order path.
+// Build with -DWAREHOUSE_COUNT_ALLOCS to replace the global operator new with a
+// counting version; without it run() only reports that counting is disabled.
+namespace AllocationCheck {
+    long long allocationCount();
+    void resetCount();
+
+    // Warm up a warehouse, then place and process `orders` orders, some of
+    // which sell products out, and fail (non-zero exit code) if any of them
+    // reached operator new; re-adding the sold-out products is not counted
+    int run(int orders);
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+#include "Product.h"
+#include <iostream>
+#include <vector>
+using namespace std;
+
+// Keys per node: 16 ints fill exactly one 64-byte cache line
+#define BPTREE_FANOUT 16
+#define BPTREE_MIN_KEYS (BPTREE_FANOUT / 2)
+#define BPTREE_MAX_DEPTH 32
+
+// Common header: the key line comes first so a node search touches one cache line
+struct BPlusNode {
+    alignas(64) int keys[BPTREE_FANOUT];
+    int count;
+    bool leaf;
+
+    BPlusNode(bool isLeaf);
+};
+
+struct BPlusInternal : BPlusNode {
+    BPlusNode* children[BPTREE_FANOUT + 1];
+
+    BPlusInternal() : BPlusNode(false) {}
+};
+
+// Leaves hold the products and are chained for ordered range scans
+struct BPlusLeaf : BPlusNode {
+    Product values[BPTREE_FANOUT];
+    BPlusLeaf* next;
+    BPlusLeaf* prev;
+
+    BPlusLeaf() : BPlusNode(true), next(nullptr), prev(nullptr) {}
+};
+
+// B+-tree keyed by product ID, a drop-in alternative to AVLTree.
+// Insert and delete are iterative; lookups do one SIMD key search per level.
+class BPlusTree {
+private:
+    BPlusNode* root;
+    int size;
+
+    // Number of keys < key / <= key among the first n keys of a node
+    static int countLess(const int* keys, int n, int key);
+    static int countLessEq(const int* keys, int n, int key);
+
+    BPlusLeaf* findLeaf(int id);
+    void insertIntoParent(BPlusNode** path, int* slots, int depth, int separator, BPlusNode* right);
+    void rebalance(BPlusNode** path, int* slots, int depth);
+    void freeAll();
+    bool checkNode(BPlusNode* node, int depth, bool hasLow, int low, bool hasHigh, int high,
+                   int& leafDepth, vector<BPlusLeaf*>& leaves, string& problem);
+
+public:
+    BPlusTree();
+    ~BPlusTree();
+
+    void insert(const Product& p);      // Replaces the product if the ID is present
+    void remove(int id);
+    Product* search(int id);
+    void inorderTraverse();
+
+    // Same contract as AVLTree::collectAfter, served from the leaf chain
+    bool collectAfter(bool hasAfter, int afterId, int skip, int limit, vector<Product>& out);
+
+    int getSize();
+
+    // Full walk checking key order against the separators, node fill, equal
+    // leaf depth, the leaf chain and the size; false with the first violation
+    bool checkInvariants(string& problem);
+};
+
+#endif
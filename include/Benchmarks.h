@@ -0,0 +1,67 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <string>
+using namespace std;
+
+// Micro-benchmarks run from the command line: warehouse bench <name> [size]
+namespace Benchmarks {
+    // AVLTree vs BPlusTree: insert, lookup, ordered range scan and delete
+    void orderedIndex(int keyCount);
+
+    // Sales-ranking heaps: binary vs d-ary, position index vs linear scan
+    void salesHeap(int productCount);
+
+    // Order routing across a federation of site threads
+    void federation(int orderCount);
+
+    // Skewed order fulfilment on the work-stealing pool against processNextOrder
+    void parallelFulfilment(int orderCount);
+
+    // Staged coroutine order pipeline against processNextOrder (needs C++20)
+    void orderPipeline(int orderCount);
+
+    // Order path with and without the lifecycle tracer, then its percentiles and trace dump
+    void orderTracing(int orderCount);
+
+    // A backlog fulfilled as one planned wave against processNextOrder
+    void wavePlanning(int orderCount);
+
+    // Order path with and without the operation recorder, then a replay of the recording
+    void operationTrace(int orderCount);
+
+    // Requests per second through WarehouseServer over a local Unix socket
+    void server(int requestCount);
+
+    // Order-path latency with and without a background checkpoint in progress
+    void checkpoint(int productCount);
+
+    // Columnar and CSV export throughput against a plain fwrite of the same size
+    void exportFormats(int productCount);
+
+    // Append rate, size and query latency of the processed-order history
+    void orderHistory(int orderCount);
+
+    // Predicate scans over ProductColumns against a loop over Product rows
+    void productFilter(int productCount);
+
+    // (price, id) index: repricing, range and cheapest-N against a column scan
+    void priceIndex(int productCount);
+
+    // HashMap insert / lookup tail latency with incremental and all-at-once resizing
+    void hashMapResize(int productCount);
+
+    // Lookups in the frozen perfect-hash table against the chained HashMap
+    void frozenCatalog(int productCount);
+
+    // Unknown-ID lookups with the cuckoo filter in front of the HashMap, and without
+    void cuckooFilter(int productCount);
+
+    // Name search: index build, then prefix, exact and misspelled queries
+    void nameIndex(int productCount);
+
+    // Dispatch "bench" sub-commands, returns the process exit code
+    int run(int argc, char* argv[]);
+}
+
+#endif
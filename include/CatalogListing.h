@@ -0,0 +1,74 @@
+#ifndef CATALOGLISTING_H
+#define CATALOGLISTING_H
+
+#include "Product.h"
+#include "ProductIndex.h"
+#include "VersionedCatalog.h"
+#include <string>
+#include <vector>
+using namespace std;
+
+enum ListingSort {
+    SORT_BY_ID,
+    SORT_BY_NAME,
+    SORT_BY_PRICE,
+    SORT_BY_QUANTITY,
+    SORT_BY_SALES
+};
+
+// Keyset cursor: the last row of the previous page
+struct ListingCursor {
+    bool valid;
+    Product last;
+
+    ListingCursor() : valid(false) {}
+};
+
+struct ListingQuery {
+    ListingSort sortBy;
+    bool descending;
+    int limit;              // Rows per page, 0 = no limit
+    int offset;             // Rows to skip (ignored when cursor is valid)
+    ListingCursor cursor;   // Continue after this row instead of using offset
+
+    ListingQuery() : sortBy(SORT_BY_ID), descending(false), limit(20), offset(0) {}
+};
+
+struct ListingPage {
+    vector<Product> rows;
+    int total;              // Products in the catalog
+    bool hasMore;
+    ListingCursor next;     // Pass back in ListingQuery::cursor for the next page
+
+    ListingPage() : total(0), hasMore(false) {}
+};
+
+// Strict weak ordering for a sort key, ties broken by ascending ID
+struct ListingOrder {
+    ListingSort sortBy;
+    bool descending;
+
+    ListingOrder(ListingSort s, bool desc) : sortBy(s), descending(desc) {}
+    bool before(const Product& a, const Product& b) const;
+    bool operator()(const Product* a, const Product* b) const { return before(*a, *b); }
+};
+
+// Sorted, paginated catalog listing.
+// ID order walks the ordered index from the cursor; other keys sort a snapshot in parallel.
+class CatalogListing {
+private:
+    static void listById(ProductIndex& tree, const ListingQuery& query, ListingPage& page);
+    static void listFromSnapshot(const CatalogSnapshot& snap, const ListingQuery& query, ListingPage& page);
+
+    // Sort the first k rows (k = 0: all) into place, chunks sorted on worker threads
+    static void parallelTopK(vector<const Product*>& rows, const ListingOrder& order, size_t k);
+
+public:
+    static ListingPage list(ProductIndex& tree, const CatalogSnapshot& snap, const ListingQuery& query);
+
+    // Render a page into one buffer, written with a single call
+    static string format(const ListingPage& page);
+    static void print(const ListingPage& page);
+};
+
+#endif
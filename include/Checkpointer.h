@@ -0,0 +1,70 @@
+#ifndef CHECKPOINTER_H
+#define CHECKPOINTER_H
+
+#include "WarehouseSystem.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+using namespace std;
+
+struct CheckpointStats {
+    int completed;             // Checkpoints written so far
+    int failed;
+    double lastSeconds;        // Snapshot handed off -> file renamed into place
+    double maxSeconds;
+    long long lastBytes;
+    long long lastVersion;     // Catalog version of the last checkpoint written
+
+    CheckpointStats() : completed(0), failed(0), lastSeconds(0), maxSeconds(0), lastBytes(0), lastVersion(0) {}
+};
+
+// Periodic checkpoints of a WarehouseSystem without pausing its owner.
+// The owner thread only pins a copy-on-write snapshot (O(1) for the catalog
+// plus a copy of the pending orders); a background thread serializes it at a
+// bounded write rate to "<path>.tmp" and renames it over <path>.
+class Checkpointer {
+private:
+    WarehouseSystem& warehouse;
+    string path;
+    double intervalSeconds;
+    long long bytesPerSecond;          // 0 = unthrottled
+
+    thread writer;
+    mutex lock;
+    condition_variable wake;
+    CatalogSnapshot queued;            // Handed off by the owner, guarded by lock
+    bool hasWork;
+    bool stopping;
+    atomic<bool> writing;              // Set from hand-off until the file is in place
+    CheckpointStats totals;            // Guarded by lock
+    chrono::steady_clock::time_point lastStart;
+
+    static void writerLoop(Checkpointer* self);
+
+public:
+    Checkpointer(WarehouseSystem& system, const string& filePath, double everySeconds, long long maxBytesPerSecond = 0);
+    ~Checkpointer();   // Lets a checkpoint in progress finish
+
+    // Owner thread: start a checkpoint if the interval has elapsed and none is running
+    bool tick();
+    // Owner thread: start a checkpoint now unless one is running
+    bool checkpointNow();
+
+    bool inProgress();
+    void waitIdle();
+    CheckpointStats stats();
+
+    // Serialize a snapshot to path (via path.tmp), throttled to bytesPerSecond if > 0
+    static bool write(const CatalogSnapshot& snap, const string& path, long long bytesPerSecond, long long* bytesWritten);
+
+    // Rebuild products and pending orders from a checkpoint file into an empty
+    // system. The whole file is parsed first: on false nothing has been added.
+    // missing (optional) tells a file that does not exist from an unreadable or
+    // damaged one.
+    static bool load(const string& path, WarehouseSystem& into, bool* missing = nullptr);
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef COLUMNAREXPORT_H
+#define COLUMNAREXPORT_H
+
+#include "Product.h"
+#include "Order.h"
+#include "VersionedCatalog.h"
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+#define EXPORT_BLOCK_ROWS 65536   // Rows buffered per block, bounds exporter memory
+
+enum ExportFormat {
+    EXPORT_COLUMNAR,   // Blocked binary columns, see ColumnarExport.cpp for the layout
+    EXPORT_CSV
+};
+
+// Buffered output file shared by the exporters
+class ExportFile {
+private:
+    FILE* file;
+    vector<unsigned char> buffer;
+    long long written;
+    bool failed;
+
+public:
+    ExportFile();
+    ~ExportFile();
+
+    bool open(const string& path);
+    bool isOpen() const { return file != nullptr; }
+    void put(const void* data, size_t n);
+    void put(const string& s) { put(s.data(), s.size()); }
+    bool close();
+    long long bytesWritten() const { return written; }
+};
+
+// Streams products (id, category, quantity, price, salesCount) to a file.
+// Columnar blocks: IDs delta + varint, category dictionary-coded, quantity and
+// salesCount varint, price raw 64-bit. New dictionary entries travel with the
+// block that first uses them, so memory stays at one block plus the dictionary.
+class ProductExporter {
+private:
+    ExportFile out;
+    ExportFormat format;
+    long long rows;
+    vector<int> ids, categories, quantities, sales;
+    vector<double> prices;
+    vector<string> dictionary;          // Category ID -> name
+    vector<int> newEntries;             // Dictionary IDs first used in the current block
+    unordered_map<string, int> categoryIds;
+    vector<unsigned char> scratch;      // One encoded column
+
+    void writeBlock();
+
+public:
+    ProductExporter(const string& path, ExportFormat fmt);
+    ~ProductExporter();
+
+    bool isOpen() const { return out.isOpen(); }
+    void append(const Product& p);
+    bool close();                       // Flush the last block and the trailer
+    long long rowCount() const { return rows; }
+    long long bytesWritten() const { return out.bytesWritten(); }
+};
+
+// Streams processed orders (orderId, productId, quantity, urgent), same framing
+class OrderExporter {
+private:
+    ExportFile out;
+    ExportFormat format;
+    long long rows;
+    vector<int> orderIds, productIds, quantities;
+    vector<bool> urgent;
+    vector<unsigned char> scratch;
+
+    void writeBlock();
+
+public:
+    OrderExporter(const string& path, ExportFormat fmt);
+    ~OrderExporter();
+
+    bool isOpen() const { return out.isOpen(); }
+    void append(const Order& o);
+    bool close();
+    long long rowCount() const { return rows; }
+    long long bytesWritten() const { return out.bytesWritten(); }
+};
+
+namespace ColumnarExport {
+    // Export every product of a snapshot, returns false on I/O failure
+    bool exportCatalog(const CatalogSnapshot& snap, const string& path, ExportFormat fmt);
+
+    // Decode columnar files back into rows (names are not exported).
+    // These load the whole file; they exist for tooling and round-trip checks.
+    bool readProducts(const string& path, vector<Product>& out);
+    bool readOrders(const string& path, vector<Order>& out);
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef CUCKOOFILTER_H
+#define CUCKOOFILTER_H
+
+#include <cstddef>
+#include <vector>
+using namespace std;
+
+#define CUCKOO_BUCKET_SLOTS 4     // Fingerprints per bucket (one 8-byte word, lookups rely on it)
+#define CUCKOO_MAX_KICKS 500      // Relocations tried before an insert reports the filter full
+#define CUCKOO_TARGET_LOAD 0.85   // Fill factor a fresh filter is sized for
+
+// Counters for a filter placed in front of exact lookups
+struct LookupFilterStats {
+    long long lookups;          // IDs looked up
+    long long rejected;         // Answered "absent" by the filter alone
+    long long falsePositives;   // Passed the filter but were absent
+
+    LookupFilterStats() : lookups(0), rejected(0), falsePositives(0) {}
+};
+
+// Approximate set of product IDs with deletion. Each ID is stored as a 16-bit
+// fingerprint in one of two buckets (the second is derived from the first and
+// the fingerprint, so entries can be moved without the ID). "No" answers are
+// exact; "maybe" is wrong about 2 * 4 / 65536 of the time.
+class CuckooFilter {
+private:
+    vector<unsigned short> table;   // bucketCount * CUCKOO_BUCKET_SLOTS fingerprints, 0 = empty
+    unsigned bucketMask;
+    int count;
+    unsigned kickState;             // xorshift state for picking eviction victims
+
+    static unsigned long long hashKey(int key);
+    void split(int key, unsigned& bucket, unsigned short& fp) const;
+    unsigned altBucket(unsigned bucket, unsigned short fp) const;
+    bool place(unsigned bucket, unsigned short fp);
+
+public:
+    CuckooFilter(int expectedKeys = 1024);
+
+    // Clear and size for this many keys
+    void reset(int expectedKeys);
+
+    // False when no slot could be freed; the filter is then missing one
+    // fingerprint and must be rebuilt larger by the caller
+    bool insert(int key);
+    bool mayContain(int key) const;
+    bool remove(int key);   // Only remove keys that were inserted
+
+    int size() const { return count; }
+    int slotCount() const { return (int)table.size(); }
+    size_t bytesUsed() const { return table.size() * sizeof(unsigned short); }
+};
+
+#endif
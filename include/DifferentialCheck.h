@@ -0,0 +1,105 @@
+#ifndef DIFFERENTIALCHECK_H
+#define DIFFERENTIALCHECK_H
+
+#include "WarehouseSystem.h"
+#include "WavePlanner.h"
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+#define VERIFY_RECENT_OPS 12       // Operations echoed when a mismatch is reported
+
+class OrderPipeline;             // Only with C++20 coroutines (OrderPipeline.h)
+
+// Kinds of random operation, each drawn with its own weight
+enum VerifyOp {
+    VERIFY_ADD, VERIFY_REMOVE, VERIFY_STOCK, VERIFY_PRICE, VERIFY_ORDER, VERIFY_PROCESS, VERIFY_DRAIN,
+    VERIFY_LOOKUP, VERIFY_FILTER, VERIFY_PRICE_RANGE, VERIFY_CHEAPEST, VERIFY_NAME, VERIFY_RANKING,
+    VERIFY_QUEUE, VERIFY_FREEZE, VERIFY_HEAP_POLICY,
+    VERIFY_OP_KINDS
+};
+
+struct VerifyConfig {
+    unsigned long long seed;
+    int operations;           // Random operations checked against the reference model
+    int idRange;              // Product IDs are drawn from [1, idRange]
+    int checkEvery;           // Operations between full consistency checks
+    int timedOperations;      // Operations per timed phase, 0 skips timing
+    int repeats;              // Timed runs, the fastest of each phase counts
+    double tolerance;         // Allowed slowdown per phase against the baseline (0.25 = 25%)
+    string baselinePath;      // Timings to compare against, empty = none
+    string recordPath;        // Where to write this run's timings as the new baseline
+
+    VerifyConfig()
+        : seed(1), operations(200000), idRange(4000), checkEvery(2000), timedOperations(100000),
+          repeats(3), tolerance(0.25) {}
+
+    // Apply "key=value" overrides, returns false on an unknown key
+    bool set(const string& key, const string& value);
+};
+
+// Reference model: the same warehouse kept in plain std containers
+struct ReferenceWarehouse {
+    map<int, Product> products;
+    deque<Order> queue;          // Front is the next order; urgent orders go in at the front
+    int nextOrderId;
+
+    ReferenceWarehouse() : nextOrderId(1) {}
+};
+
+// One timed phase of the throughput run
+struct PhaseTiming {
+    string name;
+    long long operations;
+    double seconds;           // Fastest repeat
+};
+
+// Randomized differential check: long seeded operation sequences run against
+// WarehouseSystem and the reference model, every answer is compared, and every
+// checkEvery operations all of the warehouse's indexes are cross-checked with
+// its product store (WarehouseSystem::checkConsistency: tree balance, heap
+// order, filter, catalog, columns, price and name indexes). Orders are drained
+// through processNextOrder, processOrdersParallel, planned waves (sometimes
+// with the stock changed between plan and commit) and (with C++20) the
+// coroutine pipeline alike. A separate timed run then measures each kind of
+// operation and compares it with a stored baseline.
+class DifferentialCheck {
+private:
+    VerifyConfig config;
+    unsigned long long state;                // splitmix64 state, same sequence on every platform
+    long long operationIndex;
+    string recent[VERIFY_RECENT_OPS];        // Ring of the last operations, for the report
+    string failure;                          // First mismatch, empty while everything agrees
+    long long counts[VERIFY_OP_KINDS];
+
+    unsigned long long nextRandom();
+    int below(int n);                        // Uniform in [0, n)
+    Product randomProduct(int id);
+
+    void note(const string& op);
+    bool fail(const string& what);
+
+    // Random operations and queries, each applied to both sides and compared
+    bool step(WarehouseSystem& warehouse, ReferenceWarehouse& model, WorkStealingPool& pool, WavePlanner& waves,
+              OrderPipeline* pipeline);
+    bool drain(WarehouseSystem& warehouse, ReferenceWarehouse& model, WorkStealingPool& pool, WavePlanner& waves,
+               OrderPipeline* pipeline);
+    bool compareProduct(WarehouseSystem& warehouse, ReferenceWarehouse& model, int id);
+    bool compareAll(WarehouseSystem& warehouse, ReferenceWarehouse& model);
+    bool checkNameScenarios();               // Fixed multi-word cases over common words
+
+    int runDifferential();
+    vector<PhaseTiming> runTimed();
+    int compareBaseline(const vector<PhaseTiming>& phases);
+
+public:
+    DifferentialCheck(const VerifyConfig& cfg);
+
+    // Differential run, then the timed run; returns the process exit code
+    // (non-zero on any mismatch or a phase slower than the baseline allows)
+    int run();
+};
+
+#endif
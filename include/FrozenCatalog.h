@@ -0,0 +1,58 @@
+#ifndef FROZENCATALOG_H
+#define FROZENCATALOG_H
+
+#include "Product.h"
+#include <vector>
+using namespace std;
+
+#define FROZEN_BUCKET_KEYS 4   // Average keys per CHD bucket
+
+// Read-optimized product table over a fixed set of IDs (CHD minimal perfect hash).
+// Keys hash to buckets; every bucket stores either a seed that sends its keys
+// to distinct free slots, or (single-key buckets) the slot itself. There are
+// exactly as many slots as keys and the products sit in slot order, so a
+// lookup is one seed read and one slot read, with no collisions to walk.
+// Slot IDs are also kept in a dense array so misses never touch a product.
+//
+// The key set is fixed at build time. Products can be changed in place,
+// removed (the slot is marked dead) and put back, but IDs that were not
+// frozen must live elsewhere until the next build.
+class FrozenCatalog {
+private:
+    vector<int> seeds;      // Per bucket: 0 empty, > 0 hash seed, < 0 -(slot + 1)
+    vector<Product> slots;
+    vector<int> keys;       // keys[i] == slots[i].id: lookups check the ID here, not in the product
+    vector<char> live;      // Slot not removed since the build
+    unsigned salt;          // Bucket hash seed, changed if a build attempt fails
+    int liveCount;
+
+    int bucketOf(int key) const;
+    bool tryBuild(vector<Product>& products);
+
+public:
+    FrozenCatalog();
+
+    // Replace the contents with these products (moved from, IDs must be distinct)
+    void build(vector<Product>& products);
+
+    // Slot holding this ID, -1 if it was not frozen (removed IDs keep their slot)
+    int slotOf(int productId) const;
+
+    Product* get(int productId);            // nullptr if not frozen or removed
+    bool put(Product&& product);            // Overwrite and revive a frozen ID's slot; false if not frozen
+    bool remove(int productId);             // Mark dead; false if not frozen or already removed
+
+    int size() const { return liveCount; }                // Live products
+    int keyCount() const { return (int)slots.size(); }     // IDs in the hash
+    int bucketCount() const { return (int)seeds.size(); }
+
+    // Visit every live product in slot order
+    template <typename Fn>
+    void forEach(Fn fn) {
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (live[i]) fn(slots[i]);
+        }
+    }
+};
+
+#endif
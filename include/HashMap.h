@@ -2,36 +2,67 @@
 #define HASHMAP_H
 
 #include "Product.h"
+#include "NodePool.h"
 #include <iostream>
+#include <string>
 using namespace std;
 
+#define HASHMAP_MIGRATE_STEP 4   // Old buckets moved per insert / remove while a resize is in progress
+
 // Node for chaining in hash table
 struct HashNode {
     int key;           // Product ID
     Product value;     // Product data
     HashNode* next;    // Pointer to next node in chain
 
-    HashNode(int k, Product v) : key(k), value(v), next(nullptr) {}
+    HashNode(int k, const Product& v) : key(k), value(v), next(nullptr) {}
+    HashNode(int k, Product&& v) : key(k), value(std::move(v)), next(nullptr) {}
 };
 
+// Chained hash map from product ID to Product.
+// Growing is incremental: when the load factor passes 0.75 a bucket array of
+// twice the size is allocated and the old one is kept; every later insert and
+// remove moves HASHMAP_MIGRATE_STEP old buckets across, so no single call pays
+// for rehashing the whole table. Old bucket i splits into new buckets i and
+// i + oldCapacity. Until it has moved, keys that hash to it are looked up,
+// inserted and removed in the old array, so the new array needs no clearing
+// up front and each new bucket is initialized when its old bucket moves.
 class HashMap {
 private:
     HashNode** buckets;    // Array of pointers to HashNode (buckets)
     int capacity;          // Size of the bucket array
     int size;              // Number of elements in the hash map
+    NodePool<HashNode> nodePool;  // Owns every HashNode, freed in bulk on destruction
+
+    HashNode** oldBuckets; // Array being drained during a resize, else nullptr
+    int oldCapacity;
+    int migrated;          // Old buckets [0, migrated) have been moved
+    bool incremental;      // False: a resize moves every bucket at once
 
     // Hash function: maps product ID to bucket index
     int hashFunction(int key);
 
-    // Helper function to resize the hash table when load factor is too high
+    // Head of the chain that holds (or would hold) this key, in either array
+    HashNode*& chainOf(int key);
+
+    // Start a resize when the load factor is too high
     void resize();
 
+    // Move up to n old buckets, freeing the old array after the last one
+    void migrate(int n);
+
+    template <typename Fn>
+    static void visitChain(HashNode* current, Fn& fn) {
+        for (; current != nullptr; current = current->next) fn(current->value);
+    }
+
 public:
     HashMap(int initialCapacity = 16);
     ~HashMap();
 
     // Insert or update a product in the hash map
-    void insert(Product product);
+    void insert(const Product& product);
+    void insert(Product&& product);   // Moves the product's strings into the node
 
     // Get a product by ID, returns nullptr if not found
     Product* get(int productId);
@@ -48,8 +79,40 @@ public:
     // Check if the hash map is empty
     bool isEmpty();
 
+    // Remove every product, keeping the bucket array
+    void clear();
+
+    // Resize all at once instead of incrementally (for comparison)
+    void setIncrementalResize(bool on);
+
+    // A resize is in progress
+    bool isResizing() const { return oldBuckets != nullptr; }
+
+    // Visit every product (bucket order)
+    template <typename Fn>
+    void forEach(Fn fn) {
+        if (oldBuckets == nullptr) {
+            for (int i = 0; i < capacity; i++) visitChain(buckets[i], fn);
+            return;
+        }
+        // Mid-resize: only the new buckets fed by moved old buckets are initialized
+        for (int i = 0; i < oldCapacity; i++) {
+            if (i < migrated) {
+                visitChain(buckets[i], fn);
+                visitChain(buckets[i + oldCapacity], fn);
+            } else {
+                visitChain(oldBuckets[i], fn);
+            }
+        }
+    }
+
     // Display all products in the hash map
     void display();
+
+    // Full walk checking that every node sits in the chain its key maps to
+    // (old or new array mid-resize) and that the count matches;
+    // false with the first violation in problem
+    bool checkInvariants(string& problem);
 };
 
 #endif
@@ -0,0 +1,180 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <iostream>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// Generic d-ary heap.
+//   T        element type, stored by value in one growable array
+//   Compare  Compare()(a, b) is true when a belongs closer to the root than b
+//   KeyOf    KeyOf()(item) gives the key used by find/update/contains
+//   Arity    children per node; with small elements a 4-ary node's children share a cache line
+//   Indexed  keep a key -> position index, making find/update O(1) + O(log n)
+//            instead of a linear scan
+template <typename T, typename Compare, typename KeyOf, int Arity = 4, bool Indexed = true>
+class Heap {
+public:
+    typedef typename decay<decltype(declval<KeyOf>()(declval<const T&>()))>::type Key;
+
+private:
+    static_assert(Arity >= 2, "Heap arity must be at least 2");
+
+    vector<T> items;
+    unordered_map<Key, int> position;
+    Compare before;
+    KeyOf keyOf;
+
+    static int parent(int i) { return (i - 1) / Arity; }
+    static int firstChild(int i) { return Arity * i + 1; }
+
+    void place(int i, T&& item) {
+        items[i] = std::move(item);
+        if (Indexed) position[keyOf(items[i])] = i;
+    }
+
+    // Move a hole up from i until item fits, then drop it in
+    void siftUp(int i) {
+        T item = std::move(items[i]);
+        while (i > 0 && before(item, items[parent(i)])) {
+            int p = parent(i);
+            place(i, std::move(items[p]));
+            i = p;
+        }
+        place(i, std::move(item));
+    }
+
+    // Move a hole down from i, promoting the best child each level
+    void siftDown(int i) {
+        int n = (int)items.size();
+        T item = std::move(items[i]);
+        while (true) {
+            int c = firstChild(i);
+            if (c >= n) break;
+            int best = c;
+            int last = (c + Arity < n) ? c + Arity : n;
+            for (int k = c + 1; k < last; k++) {
+                if (before(items[k], items[best])) best = k;
+            }
+            if (!before(items[best], item)) break;
+            place(i, std::move(items[best]));
+            i = best;
+        }
+        place(i, std::move(item));
+    }
+
+    int indexOf(const Key& key) const {
+        if (Indexed) {
+            typename unordered_map<Key, int>::const_iterator it = position.find(key);
+            return it == position.end() ? -1 : it->second;
+        }
+        for (int i = 0; i < (int)items.size(); i++) {
+            if (keyOf(items[i]) == key) return i;
+        }
+        return -1;
+    }
+
+public:
+    Heap(int initialCapacity = 16) {
+        if (initialCapacity > 0) {
+            items.reserve(initialCapacity);
+            if (Indexed) position.reserve(initialCapacity);
+        }
+    }
+
+    // Insert, growing the storage as needed. Returns false if the key is already present.
+    bool push(const T& item) {
+        if (Indexed && position.count(keyOf(item))) return false;
+        items.push_back(item);
+        siftUp((int)items.size() - 1);
+        return true;
+    }
+
+    const T& top() const { return items[0]; }
+
+    void pop() {
+        if (items.empty()) return;
+        if (Indexed) position.erase(keyOf(items[0]));
+        T last = std::move(items.back());
+        items.pop_back();
+        if (!items.empty()) {
+            items[0] = std::move(last);
+            siftDown(0);
+        }
+    }
+
+    // Replace the element with this key and restore the heap order.
+    // Returns false if no element has the key.
+    bool update(const Key& key, const T& value) {
+        int i = indexOf(key);
+        if (i < 0) return false;
+        bool up = before(value, items[i]);
+        items[i] = value;
+        if (up) siftUp(i);
+        else siftDown(i);
+        return true;
+    }
+
+    // Delete the element with this key: the last element fills its slot and
+    // moves up or down from there. Returns false if no element has the key.
+    bool remove(const Key& key) {
+        int i = indexOf(key);
+        if (i < 0) return false;
+        if (Indexed) position.erase(key);
+        T last = std::move(items.back());
+        items.pop_back();
+        if (i < (int)items.size()) {
+            bool up = before(last, items[i]);
+            items[i] = std::move(last);
+            if (up) siftUp(i);
+            else siftDown(i);
+        }
+        return true;
+    }
+
+    // Give back storage once the heap has shrunk to a quarter of it
+    void shrinkToFit() {
+        if (items.capacity() <= 64 || items.size() * 4 > items.capacity()) return;
+        vector<T> fitted;
+        fitted.reserve(items.size() * 2);
+        for (T& item : items) fitted.push_back(std::move(item));
+        items.swap(fitted);
+        if (Indexed) position.rehash(0);
+    }
+
+    const T* find(const Key& key) const {
+        int i = indexOf(key);
+        return i < 0 ? nullptr : &items[i];
+    }
+
+    bool contains(const Key& key) const { return indexOf(key) >= 0; }
+
+    // Every element ordered after its parent and, when indexed, found at its
+    // recorded position (a full O(n) pass, for consistency checks)
+    bool isValid() const {
+        for (int i = 1; i < (int)items.size(); i++) {
+            if (before(items[i], items[parent(i)])) return false;
+        }
+        if (Indexed) {
+            if (position.size() != items.size()) return false;
+            for (int i = 0; i < (int)items.size(); i++) {
+                if (indexOf(keyOf(items[i])) != i) return false;
+            }
+        }
+        return true;
+    }
+
+    // Elements in heap (array) order, at(0) is the root
+    const T& at(int i) const { return items[i]; }
+    int size() const { return (int)items.size(); }
+    bool isEmpty() const { return items.empty(); }
+    void reserve(int n) {
+        items.reserve(n);
+        if (Indexed) position.reserve(n);
+    }
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef LOADSIMULATOR_H
+#define LOADSIMULATOR_H
+
+#include "WarehouseSystem.h"
+#include <string>
+#include <vector>
+using namespace std;
+
+struct SimulationConfig {
+    unsigned long long seed;
+    int skuCount;             // Catalog size
+    double zipfExponent;      // Popularity skew, 0 = uniform
+    double orderRate;         // Mean order arrivals per simulated second (Poisson)
+    double serviceRate;       // Orders the floor can process per simulated second
+    double restockRate;       // Restock events per simulated second (Poisson)
+    double urgentRatio;       // Fraction of orders placed as urgent
+    double duration;          // Simulated seconds
+    int maxOrderQty;          // Order quantities are uniform in [1, maxOrderQty]
+    int samples;              // Queue-depth samples over the run
+
+    SimulationConfig()
+        : seed(1), skuCount(100000), zipfExponent(1.1), orderRate(5000), serviceRate(5500),
+          restockRate(200), urgentRatio(0.05), duration(60), maxOrderQty(5), samples(20) {}
+
+    // Apply "key=value" overrides, returns false on an unknown key
+    bool set(const string& key, const string& value);
+};
+
+// Deterministic, seedable workload generator that drives WarehouseSystem directly.
+// Arrivals, restocks and processing run as a discrete-event simulation; every
+// call into the warehouse is also timed on the wall clock.
+class LoadSimulator {
+private:
+    SimulationConfig config;
+    unsigned long long state;        // splitmix64 state, same sequence on every platform
+    vector<double> popularityCdf;    // Zipf CDF over popularity ranks
+    vector<int> idOfRank;            // Popularity rank -> product ID
+    vector<Product> masterData;      // Generated catalog by ID, used to re-list sold-out SKUs
+
+    unsigned long long nextRandom();
+    double uniform();                        // [0, 1)
+    double exponential(double rate);         // Inter-arrival time for a Poisson process
+    int pickProduct();                       // Zipf-distributed product ID
+
+    void generateCatalog(WarehouseSystem& warehouse);
+
+public:
+    LoadSimulator(const SimulationConfig& cfg);
+
+    // Run the simulation and print the report, returns the process exit code
+    int run();
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+#define NAME_MAX_PREFIX_TERMS 64        // Terms expanded per prefix
+#define NAME_MAX_FUZZY_TERMS 32         // Terms kept per misspelled word
+#define NAME_SCAN_POSTINGS 20000        // Query words with at most this many postings are always scanned
+#define NAME_PROBE_COST 16              // Posting reads one binary-search probe is taken to cost
+
+struct NameMatch {
+    int productId;
+    int wordsMatched;      // Query words this product matched
+    double score;          // Sum of per-word scores: exact 1, prefix < 1, typo < 0.6
+
+    NameMatch(int id, int words, double s) : productId(id), wordsMatched(words), score(s) {}
+};
+
+// Trie node in the arena: first child and next sibling, children sorted by letter
+struct TrieNode {
+    int firstChild;
+    int nextSibling;
+    int term;              // Term ending here, -1 if none
+    char letter;
+
+    TrieNode(char c) : firstChild(-1), nextSibling(-1), term(-1), letter(c) {}
+};
+
+// Word-level name index. Names are split into lower-case alphanumeric words;
+// each distinct word (term) is stored once in a trie for prefix lookups and
+// once in a trigram index for typo-tolerant lookups, with a posting list of
+// the products whose name contains it. Postings hold dense document numbers
+// so queries score into flat arrays instead of hash maps.
+class NameIndex {
+private:
+    vector<TrieNode> nodes;                          // nodes[0] is the root
+    vector<string> terms;
+    vector<vector<int>> postings;                    // Term -> ascending documents, dead ones included
+    vector<int> liveCount;                           // Term -> live documents in its posting; 0 = term matches nothing
+    unordered_map<unsigned, vector<int>> trigrams;   // Trigram -> terms containing it
+
+    // Removal only marks the document dead and lowers its terms' live counts;
+    // postings are swept and documents renumbered once dead ones outnumber live ones
+    unordered_map<int, int> docOf;                   // Live product ID -> document
+    vector<int> productOf;                           // Document -> product ID, -1 if dead
+    vector<int> renumbered;                          // Per document: compact()'s new number, grown in add() so compact never allocates
+    int deadDocs;
+
+    // Per-query scratch, stamped instead of cleared
+    mutable vector<int> hitCount, hitStamp;          // Per term: shared trigrams
+    mutable vector<float> wordScore;                 // Per document: best score for the current word
+    mutable vector<int> wordStamp;
+    mutable vector<float> totalScore;                // Per document: summed over query words
+    mutable vector<int> totalWords, totalStamp;
+    mutable int stamp;
+
+    int childOf(int node, char c) const;             // Trie child with that letter, -1 if none
+    int findTerm(const string& word) const;
+    int addTerm(const string& word);
+    void prefixTerms(const string& prefix, vector<int>& out) const;
+    void fuzzyTerms(const string& word, vector<pair<int, int>>& out) const;   // (term, edit distance)
+    void wordTerms(const string& word, bool last, vector<pair<int, float>>& out) const;   // (term, score)
+    void creditWord(const vector<pair<int, float>>& terms, bool scan, int queryStamp, vector<int>& matchedDocs) const;
+    void compact();
+
+public:
+    NameIndex();
+
+    static void tokenize(const string& name, vector<string>& words);
+
+    void add(int productId, const string& name);
+    void remove(int productId, const string& name);
+
+    // Best matches first: more query words matched, then higher score, then
+    // lower ID. Every word matches exactly; the last word (still being typed)
+    // and words with no exact term also match as prefixes, and words with no
+    // exact term match misspelled terms.
+    // Query words are scanned rarest first. A word with more than
+    // NAME_SCAN_POSTINGS postings whose scan would cost more than looking up
+    // every document matched so far is only probed (binary search) in those.
+    // If the probes cannot settle the top `limit`, every word is scanned, so
+    // results never depend on insertion order.
+    vector<NameMatch> search(const string& query, int limit) const;
+
+    int termCount() const { return (int)terms.size(); }
+    int productCount() const { return (int)docOf.size(); }
+};
+
+#endif
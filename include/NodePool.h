@@ -0,0 +1,101 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+using namespace std;
+
+#define NODEPOOL_FIRST_CHUNK 64
+#define NODEPOOL_MAX_CHUNK 4096
+
+// Slab allocator for fixed-size container nodes.
+// Nodes are carved out of contiguous chunks; freed nodes go on an intrusive
+// free list and are reused first. Everything is released in bulk when the
+// pool is destroyed, so containers need not walk their nodes to free them.
+template <typename T>
+class NodePool {
+private:
+    struct Slot {
+        union {
+            Slot* next;                                    // Valid while the slot is free
+            alignas(T) unsigned char storage[sizeof(T)];   // Valid while the slot is live
+        };
+        bool live;   // Holds a constructed T (checked by clear)
+    };
+
+    struct Chunk {
+        Slot* slots;
+        int count;
+    };
+
+    vector<Chunk> chunks;
+    Slot* freeList;
+    int nextChunkSize;
+    int liveCount;
+
+    // Allocate a new chunk and thread all of its slots onto the free list
+    void grow() {
+        Chunk c;
+        c.count = nextChunkSize;
+        c.slots = new Slot[c.count];
+        for (int i = c.count - 1; i >= 0; i--) {
+            c.slots[i].live = false;
+            c.slots[i].next = freeList;
+            freeList = &c.slots[i];
+        }
+        chunks.push_back(c);
+        if (nextChunkSize < NODEPOOL_MAX_CHUNK) nextChunkSize *= 2;
+    }
+
+public:
+    NodePool() : freeList(nullptr), nextChunkSize(NODEPOOL_FIRST_CHUNK), liveCount(0) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        clear();
+    }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        if (freeList == nullptr) grow();
+        Slot* s = freeList;
+        freeList = s->next;
+        T* node = new (s->storage) T(std::forward<Args>(args)...);
+        s->live = true;
+        liveCount++;
+        return node;
+    }
+
+    void destroy(T* node) {
+        Slot* s = reinterpret_cast<Slot*>(node);
+        node->~T();
+        s->live = false;
+        s->next = freeList;
+        freeList = s;
+        liveCount--;
+    }
+
+    // Destroy all live nodes and return every chunk to the system
+    void clear() {
+        for (Chunk& c : chunks) {
+            if (!is_trivially_destructible<T>::value) {
+                for (int i = 0; i < c.count; i++) {
+                    if (c.slots[i].live) reinterpret_cast<T*>(c.slots[i].storage)->~T();
+                }
+            }
+            delete[] c.slots;
+        }
+        chunks.clear();
+        freeList = nullptr;
+        nextChunkSize = NODEPOOL_FIRST_CHUNK;
+        liveCount = 0;
+    }
+
+    int size() const { return liveCount; }
+};
+
+#endif
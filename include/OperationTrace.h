@@ -0,0 +1,125 @@
+#ifndef OPERATIONTRACE_H
+#define OPERATIONTRACE_H
+
+#include "Product.h"
+#include "Order.h"
+#include "CatalogListing.h"
+#include "ColumnarExport.h"
+#include "ProductColumns.h"
+#include <string>
+#include <vector>
+using namespace std;
+
+// Calls recorded in an operation trace, one byte each in the file
+enum TraceOp {
+    TRACE_ADD = 1,          // addProduct: product
+    TRACE_REMOVE,           // removeProduct: id
+    TRACE_STOCK,            // updateStock: id, qty
+    TRACE_PRICE,            // updatePrice: id, price
+    TRACE_SEARCH,           // searchProduct: id
+    TRACE_FREEZE,           // freezeCatalog
+    TRACE_LIST,             // listProducts: sort, descending, limit, offset, cursor product or none
+    TRACE_FILTER,           // filterProducts: filter
+    TRACE_FILTER_IDS,       // filterProductIds: filter
+    TRACE_PRICE_RANGE,      // productsInPriceRange: lo, hi, limit
+    TRACE_CHEAPEST,         // cheapestInStock: n
+    TRACE_NAME_SEARCH,      // searchByName: query, limit
+    TRACE_ORDER,            // placeOrder: id, qty, urgent
+    TRACE_PROCESS,          // processNextOrder
+    TRACE_PROCESS_BATCH,    // processOrdersParallel: limit
+    TRACE_SNAPSHOT,         // takeSnapshot
+    TRACE_LOWEST,           // lowestSelling
+    TRACE_BEST,             // bestSelling
+    TRACE_HEAP_POLICY,      // setHeapPolicy: policy
+    TRACE_COMPACT,          // compactHeaps
+    TRACE_RESTORE_ORDERS,   // restorePendingOrders: count, then id, product, qty, urgent each, then next order ID
+    TRACE_WAVE,             // WavePlanner plan + commit: orders
+    TRACE_OP_KINDS
+};
+
+const char* traceOpName(int op);
+
+// Appends WarehouseSystem calls to a compact binary trace as they happen.
+// Layout (see OperationTrace.cpp): an 8-byte magic, the wall-clock start in
+// microseconds, then per call one op byte, the nanoseconds since the previous
+// call as a varint and the arguments (integers zigzag varints, prices raw
+// 64-bit, strings length-prefixed). Writes go through a 1 MB buffer.
+class OperationRecorder {
+private:
+    ExportFile out;
+    long long last;                  // Monotonic ns of the previous call
+    long long records;
+    vector<unsigned char> scratch;   // Call being encoded
+
+    void begin(TraceOp op);
+    void putInt(long long v);
+    void putDouble(double v);
+    void putString(const string& s);
+    void putProduct(const Product& p);
+    void putFilter(const ProductFilter& f);
+    void finish();
+
+public:
+    OperationRecorder(const string& path);
+    ~OperationRecorder();
+
+    bool isOpen() const { return out.isOpen(); }
+    bool close();                    // Flush; false on I/O failure
+    long long recordCount() const { return records; }
+    long long bytesWritten() const { return out.bytesWritten(); }
+
+    // Calls with up to three integer arguments
+    void call(TraceOp op);
+    void call(TraceOp op, long long a);
+    void call(TraceOp op, long long a, long long b);
+    void call(TraceOp op, long long a, long long b, long long c);
+
+    void addProduct(const Product& p);
+    void updatePrice(int productId, double price);
+    void listProducts(const ListingQuery& query);
+    void filter(TraceOp op, const ProductFilter& f);
+    void priceRange(double lo, double hi, int limit);
+    void searchByName(const string& query, int limit);
+    void restorePendingOrders(const vector<Order>& orders, int nextId);
+};
+
+// One decoded call; only the fields of its op are set
+struct TraceRecord {
+    TraceOp op;
+    long long at;             // ns since the first call of the trace
+    long long args[3];
+    double lo, hi;            // Price, or a price range
+    string text;              // Name query
+    Product product;          // Added product, listing cursor
+    ListingQuery listing;
+    ProductFilter filter;
+    vector<Order> orders;
+};
+
+// Reads a whole trace into memory and decodes it call by call
+class TraceReader {
+private:
+    vector<unsigned char> data;
+    size_t pos;
+    long long at;
+    long long startMicros;
+    bool ok;
+
+    long long getInt();
+    unsigned long long getVarint();
+    double getDouble();
+    void getString(string& s);
+    void getProduct(Product& p);
+    void getFilter(ProductFilter& f);
+
+public:
+    TraceReader();
+
+    bool open(const string& path);   // False if unreadable or not a trace
+    bool next(TraceRecord& r);       // False at the end or at a damaged call
+    bool damaged() const { return !ok; }
+    long long recordedAt() const { return startMicros; }   // Wall clock, us since the epoch
+    size_t size() const { return data.size(); }
+};
+
+#endif
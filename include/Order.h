@@ -6,10 +6,11 @@ struct Order {
     int productId;
     int quantity;
     bool urgent;
+    long long placedAt;   // Monotonic ns when placed with an OrderTracer attached, 0 otherwise
 
-    Order() : orderId(0), productId(0), quantity(0), urgent(false) {}
+    Order() : orderId(0), productId(0), quantity(0), urgent(false), placedAt(0) {}
     Order(int oid, int pid, int qty, bool urg=false) 
-        : orderId(oid), productId(pid), quantity(qty), urgent(urg) {}
+        : orderId(oid), productId(pid), quantity(qty), urgent(urg), placedAt(0) {}
 };
 
 #endif
@@ -0,0 +1,72 @@
+#ifndef ORDERHISTORY_H
+#define ORDERHISTORY_H
+
+#include "Order.h"
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+#define HISTORY_BLOCK_ROWS 4096                 // Orders per compressed block
+#define HISTORY_GROUP_ROWS 128                  // Restart points for the varint columns
+#define HISTORY_SEGMENT_BYTES (16 << 20)        // Blocks are packed into segments of this size
+
+// One processed order as stored in the history
+struct HistoryRecord {
+    long long time;       // Microseconds, non-decreasing in append order
+    int orderId;
+    int productId;
+    int quantity;
+    bool urgent;
+
+    HistoryRecord() : time(0), orderId(0), productId(0), quantity(0), urgent(false) {}
+    HistoryRecord(long long t, const Order& o)
+        : time(t), orderId(o.orderId), productId(o.productId), quantity(o.quantity), urgent(o.urgent) {}
+};
+
+// Sealed block: where it lives and the time range it covers (the sparse time index)
+struct HistoryBlock {
+    long long firstTime;
+    long long lastTime;
+    int segment;
+    int offset;
+    int bytes;
+    int count;
+};
+
+// Append-only store of processed orders. Full blocks of HISTORY_BLOCK_ROWS are
+// sealed with a fixed-width product column and delta/varint-encoded times,
+// order IDs and quantities; the newest orders stay unencoded in the tail.
+// Each product keeps a posting list of the blocks it appears in, and the block
+// time ranges answer time queries with a binary search.
+class OrderHistory {
+private:
+    vector<vector<unsigned char>> segments;
+    vector<HistoryBlock> blocks;
+    vector<HistoryRecord> tail;                       // Not yet sealed
+    unordered_map<int, vector<int>> postings;         // Product ID -> block numbers, ascending
+    long long lastTime;
+    long long recordCount;
+    vector<unsigned char> scratch;
+
+    void seal();
+    // Decode the given rows (ascending) of a sealed block, or every row if rows is nullptr
+    void decodeRows(int block, const int* rows, int rowCount, vector<HistoryRecord>& out) const;
+
+public:
+    OrderHistory();
+
+    // Record a processed order; earlier timestamps are clamped to the last one
+    void append(const Order& o, long long timeMicros);
+
+    // Every order of one product, optionally limited to [from, to], oldest first
+    void forProduct(int productId, vector<HistoryRecord>& out) const;
+    void forProduct(int productId, long long from, long long to, vector<HistoryRecord>& out) const;
+
+    // Every order with from <= time <= to, oldest first
+    void between(long long from, long long to, vector<HistoryRecord>& out) const;
+
+    long long size() const { return recordCount; }
+    long long bytesUsed() const;       // Encoded blocks, tail and index
+};
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef ORDERPIPELINE_H
+#define ORDERPIPELINE_H
+
+#include "WarehouseSystem.h"
+
+// The staged pipeline needs C++20 coroutines; without them (-std=c++17)
+// processNextOrder and processOrdersParallel are the order paths
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define WAREHOUSE_HAS_COROUTINES
+#endif
+#endif
+
+#ifdef WAREHOUSE_HAS_COROUTINES
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+using namespace std;
+
+#define PIPELINE_CHANNEL_CAP 64       // Orders buffered between two stages by default
+#define PIPELINE_JOURNAL_BATCH 256    // Orders handed to the journal thread at once
+
+// Stage coroutine. It starts suspended (the scheduler resumes it) and stays
+// suspended at the end, so the owning StageTask can destroy the frame.
+struct StageTask {
+    struct promise_type {
+        StageTask get_return_object() { return StageTask(coroutine_handle<promise_type>::from_promise(*this)); }
+        suspend_always initial_suspend() noexcept { return {}; }
+        suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { terminate(); }
+    };
+
+    coroutine_handle<promise_type> handle;
+
+    explicit StageTask(coroutine_handle<promise_type> h) : handle(h) {}
+    StageTask(StageTask&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    StageTask(const StageTask&) = delete;
+    StageTask& operator=(const StageTask&) = delete;
+    ~StageTask() { if (handle) handle.destroy(); }
+};
+
+// Single-threaded run queue of suspended stages. Other threads may only hand
+// back a coroutine they were told to expect (expectRemote / resumeFromThread).
+class PipelineScheduler {
+private:
+    deque<coroutine_handle<>> ready;
+    mutex remoteLock;
+    condition_variable remoteWake;
+    vector<coroutine_handle<>> remoteReady;
+    int remotePending;          // Coroutines parked on another thread, guarded by remoteLock
+
+public:
+    long long resumes;
+
+    PipelineScheduler() : remotePending(0), resumes(0) {}
+
+    void schedule(coroutine_handle<> h) { ready.push_back(h); }
+    void expectRemote();
+    void resumeFromThread(coroutine_handle<> h);
+
+    // Resume stages until none is ready and none is parked on another thread
+    void run();
+};
+
+// Fixed-capacity FIFO between two stages, one producer and one consumer.
+// A push into a full channel suspends the producer until the consumer takes
+// an entry: that is the pipeline's backpressure.
+template <typename T>
+class BoundedChannel {
+private:
+    PipelineScheduler& scheduler;
+    vector<T> ring;
+    int head;
+    int count;
+    bool closed;
+    coroutine_handle<> blockedProducer;
+    coroutine_handle<> blockedConsumer;
+
+    void wakeConsumer() {
+        if (blockedConsumer) {
+            scheduler.schedule(blockedConsumer);
+            blockedConsumer = nullptr;
+        }
+    }
+
+public:
+    long long fullWaits;     // Producer suspended on a full channel
+    long long emptyWaits;    // Consumer suspended on an empty channel
+    int maxDepth;
+
+    BoundedChannel(PipelineScheduler& s, int capacity)
+        : scheduler(s), ring(capacity), head(0), count(0), closed(false),
+          blockedProducer(nullptr), blockedConsumer(nullptr), fullWaits(0), emptyWaits(0), maxDepth(0) {}
+
+    struct PushAwaiter {
+        BoundedChannel* ch;
+        const T& value;
+
+        bool await_ready() { return ch->count < (int)ch->ring.size(); }
+        void await_suspend(coroutine_handle<> h) {
+            ch->blockedProducer = h;
+            ch->fullWaits++;
+        }
+        // Single producer: once woken there is room, nobody else fills it
+        void await_resume() {
+            ch->ring[(ch->head + ch->count) % ch->ring.size()] = value;
+            ch->count++;
+            if (ch->count > ch->maxDepth) ch->maxDepth = ch->count;
+            ch->wakeConsumer();
+        }
+    };
+
+    struct PopAwaiter {
+        BoundedChannel* ch;
+        T& out;
+
+        bool await_ready() { return ch->count > 0 || ch->closed; }
+        void await_suspend(coroutine_handle<> h) {
+            ch->blockedConsumer = h;
+            ch->emptyWaits++;
+        }
+        // False once the channel is closed and drained
+        bool await_resume() {
+            if (ch->count == 0) return false;
+            out = ch->ring[ch->head];
+            ch->head = (ch->head + 1) % (int)ch->ring.size();
+            ch->count--;
+            if (ch->blockedProducer) {
+                ch->scheduler.schedule(ch->blockedProducer);
+                ch->blockedProducer = nullptr;
+            }
+            return true;
+        }
+    };
+
+    PushAwaiter push(const T& value) { return PushAwaiter{this, value}; }
+    PopAwaiter pop(T& out) { return PopAwaiter{this, out}; }
+
+    // No more pushes; the consumer sees false after the last entry
+    void close() {
+        closed = true;
+        wakeConsumer();
+    }
+};
+
+// One order moving through the stages
+struct OrderInFlight {
+    Order order;
+    Product* product;    // Valid until the journal stage removes a sold-out product
+    int remaining;       // Quantity right after this order's reservation
+    int salesCount;
+    long long dequeuedAt;   // For the order tracer, 0 without one
+};
+
+// Per-run counters
+struct PipelineStats {
+    int orders;               // Taken from the queue
+    int fulfilled;
+    long long resumes;        // Stage resumptions by the scheduler
+    long long backpressure;   // Pushes that found the next stage's channel full
+    long long journalWaits;   // Journal batches that had to wait for the previous write
+    int journalBatches;
+    int maxChannelDepth;      // Deepest any channel between two stages got
+
+    PipelineStats() : orders(0), fulfilled(0), resumes(0), backpressure(0), journalWaits(0), journalBatches(0), maxChannelDepth(0) {}
+};
+
+// Fulfils queued orders of one WarehouseSystem as five coroutine stages:
+//   validate -> reserve -> fulfil -> rank -> journal
+// connected by bounded channels and resumed by a single-threaded scheduler.
+// Only the journal's export and history writes leave the calling thread: the
+// journal stage hands batches to a writer thread and keeps going, so those
+// writes overlap with the stages still working on later orders. Each stage
+// handles orders in queue order, so the outcome is the same as calling
+// processNextOrder once per order.
+class OrderPipeline {
+private:
+    WarehouseSystem& system;
+    int channelCapacity;
+
+    // Journal writer thread; one batch in flight while the stage fills the next
+    thread writer;
+    mutex writerLock;
+    condition_variable writerWake;
+    vector<Order> writing;                 // Batch being written
+    vector<long long> writingTimes;
+    bool writerBusy;
+    bool writerStopping;
+    coroutine_handle<> journalWaiting;     // Journal stage parked on a busy writer
+    PipelineScheduler* activeScheduler;
+
+    // Products sold out during the current run: removed by the journal stage,
+    // so later orders for them must not touch their Product
+    unordered_set<int> soldOut;
+    PipelineStats current;
+
+    static void writerLoop(OrderPipeline* self);
+
+    struct JournalHandOff {
+        OrderPipeline* pipeline;
+        vector<Order>& batch;
+        vector<long long>& times;
+
+        bool await_ready() { return false; }
+        bool await_suspend(coroutine_handle<> h);   // False if the writer was idle
+        void await_resume();
+    };
+    JournalHandOff handOff(vector<Order>& batch, vector<long long>& times) { return JournalHandOff{this, batch, times}; }
+    void waitForWriter();
+
+    StageTask validate(int count, BoundedChannel<OrderInFlight>& out);
+    StageTask reserve(BoundedChannel<OrderInFlight>& in, BoundedChannel<OrderInFlight>& out);
+    StageTask fulfil(BoundedChannel<OrderInFlight>& in, BoundedChannel<OrderInFlight>& out);
+    StageTask rank(BoundedChannel<OrderInFlight>& in, BoundedChannel<OrderInFlight>& out);
+    StageTask journal(BoundedChannel<OrderInFlight>& in);
+
+public:
+    OrderPipeline(WarehouseSystem& warehouse, int capacity = PIPELINE_CHANNEL_CAP);
+    ~OrderPipeline();
+
+    OrderPipeline(const OrderPipeline&) = delete;
+    OrderPipeline& operator=(const OrderPipeline&) = delete;
+
+    // Fulfil up to limit queued orders (-1: all); returns when every write is done
+    int run(int limit = -1);
+    PipelineStats lastRun() { return current; }
+};
+
+#endif
+
+#endif
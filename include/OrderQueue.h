@@ -5,23 +5,33 @@
 #include <iostream>
 using namespace std;
 
-#define MAX_ORDERS 100
+#define ORDER_QUEUE_INITIAL_CAP 128
 
+// Growable circular buffer of orders.
+// Capacity only ever grows (doubling), so once warm enqueue/dequeue never allocate.
 class OrderQueue {
 private:
-    Order orders[MAX_ORDERS];
+    Order* orders;
+    int capacity;
     int front;
-    int rear;
     int size;
 
+    void grow();
+
 public:
-    OrderQueue();
+    OrderQueue(int initialCapacity = ORDER_QUEUE_INITIAL_CAP);
+    ~OrderQueue();
+
+    OrderQueue(const OrderQueue&) = delete;
+    OrderQueue& operator=(const OrderQueue&) = delete;
 
-    void enqueue(Order o);        // Add order
-    Order dequeue();              // Remove order
-    Order peek();                 // See next order
+    void enqueue(const Order& o);   // Add order (urgent orders go to the front)
+    Order dequeue();                // Remove order
+    const Order& peek();            // See next order
+    const Order& at(int i);         // i-th pending order, 0 = next to be processed
     bool isEmpty();
-    bool isFull();
+    int getSize();
+    void reserve(int n);            // Pre-size so the next n orders never allocate
     void printQueue();
 };
 
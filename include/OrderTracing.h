@@ -0,0 +1,83 @@
+#ifndef ORDERTRACING_H
+#define ORDERTRACING_H
+
+#include "Order.h"
+#include <string>
+#include <vector>
+using namespace std;
+
+#define LATENCY_SUB_BITS 4                                  // 16 buckets per power of two (~6% resolution)
+#define LATENCY_BUCKETS ((64 - LATENCY_SUB_BITS) << LATENCY_SUB_BITS)
+#define TRACE_MAX_SAMPLES 100000                            // Sampled orders kept for the trace dump
+
+// Log-linear histogram of nanosecond durations: values below 16 ns are exact,
+// above that each power of two is split into 16 buckets. Recording is a few
+// instructions and never allocates.
+class LatencyHistogram {
+private:
+    long long counts[LATENCY_BUCKETS];
+    long long total;
+    long long sum;
+    long long maxValue;
+
+    static int bucketOf(long long ns);
+    static long long bucketLow(int bucket);
+
+public:
+    LatencyHistogram();
+
+    void record(long long ns);
+    void clear();
+
+    long long count() const { return total; }
+    long long max() const { return maxValue; }
+    double mean() const { return total > 0 ? (double)sum / (double)total : 0.0; }
+    long long percentile(double q) const;   // Middle of the bucket holding the q-th value, ns
+};
+
+// Lifecycle of one sampled order, monotonic ns
+struct TraceSample {
+    int orderId;
+    int productId;
+    int quantity;
+    bool urgent;
+    bool fulfilled;
+    long long placedAt;      // 0 if it was placed before tracing started
+    long long dequeuedAt;
+    long long completedAt;
+};
+
+// Queue-wait (placement to dequeue) and service (dequeue to completion)
+// histograms split by urgency, plus an optional sample of whole order
+// lifecycles for a Chrome trace-event dump (chrome://tracing, Perfetto).
+// WarehouseSystem stamps orders and reports them here once attached.
+class OrderTracer {
+private:
+    LatencyHistogram waits[2];      // [urgent]
+    LatencyHistogram services[2];   // [urgent], fulfilled orders only
+    long long failed;
+    int sampleEvery;                // Keep every n-th order, 0 = no samples
+    long long seen;
+    vector<TraceSample> samples;    // Reserved up front, stops filling at TRACE_MAX_SAMPLES
+
+public:
+    OrderTracer(int sampleEveryN = 0);
+
+    static long long now();         // Monotonic clock, ns
+
+    void record(const Order& o, long long dequeuedAt, long long completedAt, bool fulfilled);
+    void clear();
+
+    const LatencyHistogram& queueWait(bool urgent) const { return waits[urgent ? 1 : 0]; }
+    const LatencyHistogram& serviceTime(bool urgent) const { return services[urgent ? 1 : 0]; }
+    long long failedCount() const { return failed; }
+    int sampleCount() const { return (int)samples.size(); }
+
+    // Percentile table of all four histograms
+    void printSummary() const;
+
+    // Sampled orders as async "queued" and "service" spans, false on I/O failure
+    bool writeChromeTrace(const string& path) const;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef PRICEINDEX_H
+#define PRICEINDEX_H
+
+#include <vector>
+using namespace std;
+
+#define PRICE_INDEX_BLOCK 256   // Target keys per block, blocks split at twice this
+
+struct PriceKey {
+    double price;
+    int id;
+
+    PriceKey() : price(0), id(0) {}
+    PriceKey(double p, int i) : price(p), id(i) {}
+
+    bool operator<(const PriceKey& other) const {
+        return price < other.price || (price == other.price && id < other.id);
+    }
+    bool operator==(const PriceKey& other) const { return price == other.price && id == other.id; }
+};
+
+// Secondary index ordered by (price, id): a sorted sequence of small sorted
+// blocks plus the last key of every block. Lookups binary-search the block
+// keys, then the block; range scans walk contiguous arrays.
+//
+// An insert or removal is O(log n + B), B = PRICE_INDEX_BLOCK, except when it
+// splits, empties or merges a block: that also shifts blocks and lastKeys,
+// O(n / B) moves (about 4000 vector headers and keys at 10^6 keys). A block
+// only splits after B inserts into it, so splits cost O(n / B^2) amortized.
+class PriceIndex {
+private:
+    vector<vector<PriceKey>> blocks;
+    vector<PriceKey> lastKeys;     // lastKeys[i] == blocks[i].back()
+    int size;
+
+    int blockFor(const PriceKey& key) const;   // First block whose last key is >= key
+
+public:
+    PriceIndex();
+
+    void insert(double price, int id);
+    bool remove(double price, int id);
+    void update(int id, double oldPrice, double newPrice);
+
+    // Keys with lo <= price <= hi in ascending order, at most limit of them (0 = all)
+    void range(double lo, double hi, int limit, vector<PriceKey>& out) const;
+
+    // Visit keys in ascending order from the cheapest until fn returns false
+    template <typename Fn>
+    void ascending(Fn fn) const {
+        for (const vector<PriceKey>& block : blocks) {
+            for (const PriceKey& k : block) {
+                if (!fn(k)) return;
+            }
+        }
+    }
+
+    int getSize() const { return size; }
+};
+
+#endif
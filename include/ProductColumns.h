@@ -0,0 +1,99 @@
+#ifndef PRODUCTCOLUMNS_H
+#define PRODUCTCOLUMNS_H
+
+#include "Product.h"
+#include <climits>
+#include <cfloat>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+// One bit per column row, 64 rows per word; bits past the last row stay clear
+class SelectionBitmap {
+private:
+    vector<unsigned long long> words;
+    int rows;
+
+public:
+    SelectionBitmap() : rows(0) {}
+    explicit SelectionBitmap(int rowCount, bool set = false);
+
+    int rowCount() const { return rows; }
+    int wordCount() const { return (int)words.size(); }
+    unsigned long long* data() { return words.data(); }
+    const unsigned long long* data() const { return words.data(); }
+
+    void clearTail();      // Zero the bits past rowCount
+    int count() const;
+
+    SelectionBitmap& operator&=(const SelectionBitmap& other);
+    SelectionBitmap& operator|=(const SelectionBitmap& other);
+    SelectionBitmap& andNot(const SelectionBitmap& other);
+
+    // Visit the row of every set bit, ascending
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (int w = 0; w < (int)words.size(); w++) {
+            unsigned long long bits = words[w];
+            while (bits != 0) {
+                fn(w * 64 + __builtin_ctzll(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+};
+
+// "category = X AND quantity in [..] AND price in [..] AND sales in [..]";
+// unset bounds are open, an empty category matches every category
+struct ProductFilter {
+    string category;
+    int minQuantity, maxQuantity;
+    double minPrice, maxPrice;
+    int minSales, maxSales;
+
+    ProductFilter()
+        : minQuantity(INT_MIN), maxQuantity(INT_MAX), minPrice(-DBL_MAX), maxPrice(DBL_MAX),
+          minSales(INT_MIN), maxSales(INT_MAX) {}
+};
+
+// Dense columnar copies of the fields the filter engine scans, kept in step
+// with the catalog. Rows are unordered; erase moves the last row into the hole.
+class ProductColumns {
+private:
+    vector<int> ids;
+    vector<int> quantities;
+    vector<double> prices;
+    vector<int> sales;
+    vector<int> categories;                       // Dictionary IDs
+    unordered_map<int, int> rowOf;                // Product ID -> row
+    vector<string> categoryNames;
+    unordered_map<string, int> categoryIds;
+
+    int categoryId(const string& name);
+
+public:
+    void put(const Product& p);
+    void erase(int productId);
+    void setCounts(int productId, int quantity, int salesCount);
+    void setPrice(int productId, double price);
+    int size() const { return (int)ids.size(); }
+    void reserve(int rowCount);
+
+    // Single-predicate scans, each producing a bitmap over the current rows
+    SelectionBitmap categoryEquals(const string& category) const;
+    SelectionBitmap quantityBetween(int lo, int hi) const;     // Inclusive
+    SelectionBitmap salesBetween(int lo, int hi) const;
+    SelectionBitmap priceBetween(double lo, double hi) const;
+
+    // AND of every bounded predicate of the filter
+    SelectionBitmap select(const ProductFilter& filter) const;
+
+    // Product IDs of the selected rows (valid until the next write)
+    vector<int> idsOf(const SelectionBitmap& selection) const;
+
+    // True if p.id has a row holding p's quantity, price, sales and category
+    bool holds(const Product& p) const;
+};
+
+#endif
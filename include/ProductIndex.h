@@ -0,0 +1,15 @@
+#ifndef PRODUCTINDEX_H
+#define PRODUCTINDEX_H
+
+// Ordered index by product ID used by WarehouseSystem and CatalogListing.
+// Build with -DWAREHOUSE_USE_BPTREE to swap the AVLTree for the B+-tree;
+// both expose insert/remove/search/inorderTraverse/collectAfter.
+#ifdef WAREHOUSE_USE_BPTREE
+#include "BPlusTree.h"
+typedef BPlusTree ProductIndex;
+#else
+#include "AVLTree.h"
+typedef AVLTree ProductIndex;
+#endif
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef SALESHEAP_H
+#define SALESHEAP_H
+
+#include "Heap.h"
+
+// Heap entry for sales rankings: 8 bytes, so a 4-ary node's children fit in half a cache line
+struct SalesEntry {
+    int productId;
+    int salesCount;
+
+    SalesEntry() : productId(0), salesCount(0) {}
+    SalesEntry(int id, int sales) : productId(id), salesCount(sales) {}
+};
+
+struct SalesEntryId {
+    int operator()(const SalesEntry& e) const { return e.productId; }
+};
+
+struct FewerSales {
+    bool operator()(const SalesEntry& a, const SalesEntry& b) const { return a.salesCount < b.salesCount; }
+};
+
+struct MoreSales {
+    bool operator()(const SalesEntry& a, const SalesEntry& b) const { return a.salesCount > b.salesCount; }
+};
+
+// Root is the lowest / best selling product; update by product ID is O(log n)
+typedef Heap<SalesEntry, FewerSales, SalesEntryId, 4> LowSellingHeap;
+typedef Heap<SalesEntry, MoreSales, SalesEntryId, 4> BestSellingHeap;
+
+// What removing a product does to the sales rankings
+enum HeapPolicy {
+    HEAP_HARD_DELETE,   // Leaves both heaps immediately, O(log n) per removal
+    HEAP_TOMBSTONES     // Marked dead, swept out of both heaps in batches
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef TRACEREPLAYER_H
+#define TRACEREPLAYER_H
+
+#include "WarehouseSystem.h"
+#include "OperationTrace.h"
+#include "OrderTracing.h"
+#include "WavePlanner.h"
+#include <string>
+using namespace std;
+
+#define REPLAY_SPIN_NS 200000    // Paced replay: sleep until this close to a call's time, then spin
+
+struct ReplayConfig {
+    string tracePath;
+    string checkpointPath;    // State to start from, empty = an empty warehouse
+    double speed;             // 1 = original pacing, 2 = twice as fast, 0 = as fast as possible
+    int workers;              // Pool for recorded batches, 0 = process them one by one
+    HeapPolicy heapPolicy;
+
+    ReplayConfig() : speed(0), workers(0), heapPolicy(HEAP_HARD_DELETE) {}
+
+    // Apply "key=value" overrides, returns false on an unknown key
+    bool set(const string& key, const string& value);
+};
+
+// Runs a recorded operation trace against a fresh WarehouseSystem, either as
+// fast as possible or paced like the recording (optionally scaled), and
+// reports the latency of every kind of call. Paced replays also report how far
+// behind schedule calls started. The warehouse must start from the state the
+// recording started from (the same checkpoint) for the calls to mean the same.
+class TraceReplayer {
+private:
+    ReplayConfig config;
+    LatencyHistogram latency[TRACE_OP_KINDS];
+    LatencyHistogram lateness;       // Paced start minus scheduled start
+    long long placed, rejected, fulfilled, failed;
+
+    void apply(WarehouseSystem& warehouse, WorkStealingPool* pool, WavePlanner& waves, const TraceRecord& r);
+    void printReport(long long records, long long recordedNs, double replaySeconds);
+
+public:
+    TraceReplayer(const ReplayConfig& cfg);
+
+    // Replay and print the report, returns the process exit code
+    int run();
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+// LEB128 varints and zigzag mapping shared by the export and history encoders
+
+inline unsigned char* writeVarint(unsigned char* dst, unsigned long long v) {
+    while (v >= 0x80) {
+        *dst++ = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    *dst++ = (unsigned char)v;
+    return dst;
+}
+
+// Returns nullptr if the varint runs past end
+inline const unsigned char* readVarint(const unsigned char* src, const unsigned char* end, unsigned long long& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && src < end; shift += 7) {
+        unsigned char b = *src++;
+        v |= (unsigned long long)(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) return src;
+    }
+    return nullptr;
+}
+
+inline unsigned long long zigzag(long long v) {
+    return ((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63);
+}
+
+inline long long unzigzag(unsigned long long v) {
+    return (long long)(v >> 1) ^ -(long long)(v & 1);
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef VERSIONEDCATALOG_H
+#define VERSIONEDCATALOG_H
+
+#include "Product.h"
+#include "Order.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+#define CATALOG_PAGE_SIZE 256
+
+// Fixed-size page of product slots, shared between versions until written
+struct CatalogPage {
+    Product slots[CATALOG_PAGE_SIZE];
+    bool used[CATALOG_PAGE_SIZE];
+
+    CatalogPage() {
+        for (int i = 0; i < CATALOG_PAGE_SIZE; i++) {
+            used[i] = false;
+        }
+    }
+};
+
+// Page table of one catalog version
+struct CatalogPageTable {
+    vector<shared_ptr<CatalogPage>> pages;
+    int productCount;
+
+    CatalogPageTable() : productCount(0) {}
+};
+
+// Immutable point-in-time view of the catalog and pending orders.
+// Holding a snapshot never blocks writers; they copy any page it still shares.
+class CatalogSnapshot {
+private:
+    shared_ptr<const CatalogPageTable> table;
+    long long snapshotVersion;
+
+public:
+    vector<Order> pendingOrders;
+    int nextOrderId;       // ID the next placed order gets, so a restart never reuses one
+
+    CatalogSnapshot() : snapshotVersion(0), nextOrderId(0) {}
+    CatalogSnapshot(shared_ptr<const CatalogPageTable> t, long long v) : table(t), snapshotVersion(v), nextOrderId(0) {}
+
+    long long version() const { return snapshotVersion; }
+    int productCount() const { return table ? table->productCount : 0; }
+
+    // Visit every product of this version (in slot order)
+    template <typename Fn>
+    void forEachProduct(Fn fn) const {
+        if (!table) return;
+        for (const shared_ptr<CatalogPage>& page : table->pages) {
+            for (int i = 0; i < CATALOG_PAGE_SIZE; i++) {
+                if (page->used[i]) fn(page->slots[i]);
+            }
+        }
+    }
+};
+
+// Copy-on-write paged copy of the catalog used for consistent reports.
+// Writes happen in place unless a live snapshot still references the page.
+class VersionedCatalog {
+private:
+    shared_ptr<CatalogPageTable> current;
+    unordered_map<int, int> slotOf;   // Product ID -> global slot index
+    vector<int> freeSlots;            // Slots released by erase, reused first
+    int slotCount;                    // Slots handed out so far
+    long long version;                // Bumped on every write
+    mutex publishLock;                // Guards the page table against concurrent snapshot()
+
+    // Return a writable slot, cloning the page table and the page if shared
+    Product* writableSlot(int slot, bool** usedFlag);
+
+public:
+    VersionedCatalog();
+
+    void put(const Product& p);
+    void erase(int productId);
+    void setCounts(int productId, int quantity, int salesCount);
+
+    CatalogSnapshot snapshot();
+    long long getVersion();
+};
+
+#endif
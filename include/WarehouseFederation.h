@@ -0,0 +1,89 @@
+#ifndef WAREHOUSEFEDERATION_H
+#define WAREHOUSEFEDERATION_H
+
+#include "WarehouseSystem.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+// One physical site: a WarehouseSystem owned by its own worker thread.
+// Everything that touches `system` runs as a task on that thread.
+struct WarehouseSite {
+    string name;
+    WarehouseSystem system;
+    thread worker;
+    mutex lock;
+    condition_variable wake;
+    deque<function<void()>> tasks;
+    bool stopping;
+    int busy;                  // Tasks queued or running, guarded by lock
+    atomic<int> pendingOrders; // Routed to this site but not yet processed
+
+    WarehouseSite(const string& siteName, int capacity);
+};
+
+// Portion of a federated order sent to one site
+struct SiteAllocation {
+    int site;
+    int quantity;
+
+    SiteAllocation(int s, int q) : site(s), quantity(q) {}
+};
+
+// Federation-wide stock of one SKU, kept in step with every routed change
+struct SkuSummary {
+    int totalAvailable;        // Sum of available
+    vector<int> available;     // Per site: on hand minus routed, unprocessed orders
+};
+
+// Holds several WarehouseSystem sites, each on its own thread, and routes orders.
+// Availability is answered from the merged per-SKU summary without asking any site.
+class WarehouseFederation {
+private:
+    vector<WarehouseSite*> sites;
+    unordered_map<int, SkuSummary> summary;
+    mutex summaryLock;
+
+    void post(int site, function<void()> task);
+    void releaseReservation(int productId, int site, int qty);
+    static void workerLoop(WarehouseSite* site);
+
+    // Pick sites for qty units: one site with enough stock and the lowest load,
+    // otherwise split across the sites holding the most stock
+    bool route(SkuSummary& sku, int qty, vector<SiteAllocation>& out);
+
+public:
+    WarehouseFederation(int siteCount, int capacityPerSite);
+    ~WarehouseFederation();
+
+    int siteCount();
+
+    // Stock a product at one site (adds it there or tops up its quantity)
+    void addStock(int site, const Product& p);
+
+    // Route an order; returns the per-site split, empty if the federation lacks stock
+    vector<SiteAllocation> placeOrder(int productId, int qty, bool urgent = false);
+
+    // Ask every site to process its queued orders
+    void processPending();
+
+    // Block until every site has run all tasks posted so far
+    void waitIdle();
+
+    // Merged view, answered from the summary
+    int availableStock(int productId);
+    vector<int> availableBySite(int productId);
+    int siteLoad(int site);
+
+    // Direct access to a site's system, only safe after waitIdle()
+    WarehouseSystem& siteSystem(int site);
+};
+
+#endif
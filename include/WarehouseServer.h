@@ -0,0 +1,89 @@
+#ifndef WAREHOUSESERVER_H
+#define WAREHOUSESERVER_H
+
+#include "WarehouseSystem.h"
+#include "Checkpointer.h"
+#include "WavePlanner.h"
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+// Line protocol, one request per line, one response line per request:
+//   PING                                   -> OK
+//   SEARCH <id>                            -> OK <id> <qty> <price> <sales> <category> <name>
+//   ADD <id> <qty> <price> <category> <name...>
+//   ORDER <id> <qty> [U]                   -> OK <orderId>     (U = urgent)
+//   PROCESS [n]                            -> OK <fulfilled>   (default 1, on the worker pool if one is set)
+//   WAVE [n]                               -> OK <fulfilled> <orders> <products> <picklists>
+//                                             (next n orders, default all, planned and committed as one wave)
+//   STOCK <id> <qty>                       -> OK
+//   PRICE <id> <price>                     -> OK
+//   PRICES <lo> <hi> [limit]               -> OK <n> <id>:<price>...   (ascending, limit default 50)
+//   CHEAPEST <n>                           -> OK <n> <id>:<price>...   (in stock only)
+//   SHIPMENTS <id> [from to]               -> OK <orders> <units>   (needs order history, times in us)
+//   FILTER <category|*> <minQty> <maxQty> <minPrice> <maxPrice>
+//                                          -> OK <matches> <id>...      (first 50 IDs, ascending)
+//   FIND <text>                            -> OK <n> <id>...   (best name matches first, at most 10)
+//   FREEZE                                 -> OK <frozen>      (rebuild the perfect-hash table)
+//   STATS                                  -> OK products=<n> frozen=<n> pending=<n> requests=<n> connections=<n>
+//                                             lookups=<n> rejected=<n> falsepos=<n>   (ID filter counters)
+//   LATENCY                                -> OK wait=<n>/<p50>/<p99>/<max> urgentwait=... service=... urgentservice=...
+//                                             (us; needs the order tracer, queue wait and service split by urgency)
+//   QUIT                                   -> OK, then the server closes the connection
+// Errors answer "ERR <reason>". Clients may pipeline: every complete line in a
+// read is executed and all responses go out in one write.
+struct ServerConnection {
+    int fd;
+    string in;        // Bytes received but not yet run: a partial line, or lines held back while `out` is full
+    string out;       // Responses not yet written
+    bool closing;     // Close once `out` has drained
+
+    ServerConnection() : fd(-1), closing(false) {}
+};
+
+// Single-threaded epoll front-end for one WarehouseSystem (Linux only)
+class WarehouseServer {
+private:
+    WarehouseSystem& warehouse;
+    int epollFd;
+    vector<int> listenFds;
+    string unixPath;
+    unordered_map<int, ServerConnection> connections;
+    atomic<bool> stopping;
+    long long requestCount;
+    Checkpointer* checkpointer;   // Optional, ticked from the event loop
+    WorkStealingPool* fulfilmentPool;   // Optional, PROCESS fulfils orders on it
+    WavePlanner waves;
+
+    bool addListener(int fd);
+    void acceptAll(int listenFd);
+    void readFrom(ServerConnection& conn);
+    void runLines(ServerConnection& conn);
+    void flush(ServerConnection& conn);
+    void closeConnection(int fd);
+    void watchWrites(ServerConnection& conn, bool on);   // Reads stay watched only while `out` is below the high-water mark
+
+public:
+    WarehouseServer(WarehouseSystem& system);
+    ~WarehouseServer();
+
+    bool listenTcp(int port);                 // Binds 127.0.0.1 only
+    bool listenUnix(const string& path);
+
+    // Take periodic checkpoints between batches (the write happens off-thread)
+    void setCheckpointer(Checkpointer* c);
+
+    // Fulfil PROCESS batches on this pool, one ordering key per product (not owned)
+    void setFulfilmentPool(WorkStealingPool* pool);
+
+    // Execute one request line, appending the response line to out
+    void handleLine(const char* line, size_t len, string& out);
+
+    // Serve until stop() is called, returns the process exit code
+    int run();
+    void stop();
+};
+
+#endif
@@ -2,48 +2,169 @@
 #define WAREHOUSESYSTEM_H
 
 #include "Product.h"
-#include "MinHeap.h"
-#include "MaxHeap.h"
+#include "SalesHeap.h"
 #include "HashMap.h"
-#include "AVLTree.h"
+#include "FrozenCatalog.h"
+#include "CuckooFilter.h"
+#include "ProductIndex.h"
 #include "Order.h"
-#include <queue>
+#include "OrderQueue.h"
+#include "VersionedCatalog.h"
+#include "CatalogListing.h"
+#include "ColumnarExport.h"
+#include "OrderHistory.h"
+#include "OrderTracing.h"
+#include "OperationTrace.h"
+#include "ProductColumns.h"
+#include "PriceIndex.h"
+#include "NameIndex.h"
+#include "WorkStealingPool.h"
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <iostream>
 using namespace std;
 
 class WarehouseSystem {
 private:
-    AVLTree productsTree;      // For O(log n) search by ID
-    HashMap productsMap;       // For O(1) average retrieval by ID
-    MinHeap lowSellingHeap;    // For O(1) retrieval of lowest selling product (by salesCount)
-    MaxHeap bestSellingHeap;   // For O(1) retrieval of best selling product (by salesCount)
+    ProductIndex productsTree; // For O(log n) search by ID (AVLTree or BPlusTree)
+    CuckooFilter idFilter;     // Every stored product ID; rejects unknown IDs before any lookup
+    LookupFilterStats filterStats;
+    FrozenCatalog frozenProducts;   // Products as of the last freeze, one-probe lookups
+    HashMap productsMap;       // Overlay: products added since the last freeze, O(1) average retrieval by ID
+    LowSellingHeap lowSellingHeap;    // For O(1) retrieval of lowest selling product (by salesCount)
+    BestSellingHeap bestSellingHeap;  // For O(1) retrieval of best selling product (by salesCount)
+    VersionedCatalog catalog;  // Copy-on-write copy of the products for consistent reports
+    ProductColumns columns;    // Columnar copies of quantity, price, sales and category for filters
+    PriceIndex priceIndex;     // (price, id) order for range and cheapest-N queries
+    NameIndex nameIndex;       // Name words for prefix and typo-tolerant search
 
-    queue<Order> orderQueue;
+    OrderQueue orderQueue;     // Growable ring buffer, no allocations once warm
     int nextOrderId;
+    bool verbose;              // Print status messages for each operation
+    OrderExporter* orderExporter;   // Optional stream of processed orders, not owned
+    OrderHistory* orderHistory;     // Optional store of processed orders, not owned
+    OrderTracer* orderTracer;       // Optional queue-wait and service-time recorder, not owned
+    OperationRecorder* recorder;    // Optional trace of the public calls, not owned
+
+    // Removed products still in the heaps under HEAP_TOMBSTONES
+    HeapPolicy heapPolicy;
+    unordered_set<int> heapTombstones;
+
+    // Filter first, then the frozen table, then the overlay
+    Product* findProduct(int productId);
+
+    // Bodies of removeProduct, compactHeaps and takeSnapshot for internal
+    // callers, so only the outer public call lands in a trace
+    void eraseProduct(int productId);
+    void sweepHeapTombstones();
+    CatalogSnapshot pinSnapshot();
+    void rebuildIdFilter(int expectedKeys);
+
+    // After an order's stock change: tree copy, catalog, columns, rankings, export
+    // and history, then removal once sold out (p is gone afterwards)
+    void recordFulfilment(const Order& o, Product* p, int remaining, int salesCount);
+
+    // The steps of recordFulfilment, also run one by one as OrderPipeline stages
+    void recordSale(const Order& o, int remaining, int salesCount);   // Tree copy, catalog, columns
+    void updateRankings(int productId, int salesCount);
+    void journalOrder(const Order& o);                                // Export and history
+    void finishOrder(const Order& o, Product* p, int remaining, int salesCount);
+    void reportMissing(const Order& o);
+    void reportShortfall(const Order& o, int available);
+    void traceOrder(const Order& o, long long dequeuedAt, bool fulfilled);   // No-op without a tracer
+
+    friend class OrderPipeline;
+    friend class WavePlanner;
 
     // Helper function to calculate total pending quantity for a product in the queue
     int getPendingQuantity(int productId);
 
+    // Name for heap printouts
+    string productName(int productId);
+    template <typename SalesHeapType>
+    void printSalesHeap(const SalesHeapType& heap, const char* rootLabel);
+
 public:
     WarehouseSystem(int minHeapCap, int maxHeapCap, int hashMapCap);
 
     // Product management
-    void addProduct(Product p);
+    void addProduct(const Product& p);          // Ignored if the price is NaN or infinite
+    void addProduct(Product&& p);
     void removeProduct(int productId);
     void updateStock(int productId, int qty);
+    bool updatePrice(int productId, double price);  // False if not found or the price is not finite
     Product* searchProduct(int productId);
+    int productCount();
     void displayAllProducts();
+    ListingPage listProducts(const ListingQuery& query);
+
+    // Rebuild the frozen table over every current product and empty the overlay.
+    // Invalidates Product pointers returned earlier.
+    void freezeCatalog();
+    int frozenProductCount();
+    int overlayProductCount();
+
+    // Hit / negative / false-positive counts of the ID filter in front of lookups
+    LookupFilterStats lookupFilterStats();
+
+    // Predicate filters, scanned over the columnar copies
+    vector<Product> filterProducts(const ProductFilter& filter);   // Matching products by ascending ID
+    vector<int> filterProductIds(const ProductFilter& filter);     // Their IDs only, ascending
+    const ProductColumns& productColumns();                          // For combining bitmaps directly
+
+    // Price queries over the ordered price index, cheapest first
+    vector<Product> productsInPriceRange(double lo, double hi, int limit = 0);
+    vector<Product> cheapestInStock(int n);
+
+    // Name search: prefixes and misspelled words, best matches first
+    vector<NameMatch> searchByName(const string& query, int limit = 10);
 
     // Orders
-    void placeOrder(int productId, int qty);
-    void processNextOrder();
+    int placeOrder(int productId, int qty, bool urgent = false);   // Returns the order ID, 0 if rejected
+    bool processNextOrder();                                        // Returns true if an order was fulfilled
+    bool peekNextOrder(Order& next);
+    // Fulfil up to limit queued orders (-1: all) on the pool, one ordering key per
+    // product; same results as calling processNextOrder that many times.
+    // pick runs on a worker for each order with enough stock, before it is taken.
+    int processOrdersParallel(WorkStealingPool& pool, int limit = -1,
+                              const function<void(const Order&)>& pick = nullptr);   // Returns fulfilled orders
+    int pendingOrderCount();
     void printOrders();
+    // Re-queue orders from a checkpoint, as they were; new orders get IDs from
+    // nextId on, or after the highest restored one if that is larger
+    void restorePendingOrders(const vector<Order>& orders, int nextId = 0);
+    void setOrderExporter(OrderExporter* exporter);                 // Stream every fulfilled order, nullptr to stop
+    void setOrderHistory(OrderHistory* history);                    // Record every fulfilled order, nullptr to stop
+    OrderHistory* getOrderHistory();
+    void setOrderTracer(OrderTracer* tracer);                       // Time every order from now on, nullptr to stop
+    OrderTracer* getOrderTracer();
+    void setOperationRecorder(OperationRecorder* rec);              // Trace every public call from now on, nullptr to stop
+
+    // Consistent point-in-time view for reports (does not block order processing)
+    CatalogSnapshot takeSnapshot();
+    CatalogSnapshot snapshotForCheckpoint();    // The same view for background checkpoints: not traced
+
+    // Sales rankings over live products only; false if there are none
+    bool lowestSelling(SalesEntry& out);
+    bool bestSelling(SalesEntry& out);
+    int rankedProductCount();                   // Entries in each heap, tombstones included
+    void setHeapPolicy(HeapPolicy policy);      // Switching to hard delete sweeps at once
+    void compactHeaps();                        // Sweep tombstoned products out of both heaps
+    void sweepHeapsWhenIdle();                  // The same sweep as housekeeping: not traced, a no-op without tombstones
+
+    // Cross-check every copy kept in step with the product store: ID index,
+    // ID filter, catalog, columns, price and name indexes, both heaps. A full
+    // pass over each; false with the first disagreement in problem.
+    bool checkConsistency(string& problem);
 
     // Heap display
     void printLowSellingHeap();
     void printBestSellingHeap();
 
+    void setVerbose(bool on);
+
     ~WarehouseSystem();
 };
 
@@ -0,0 +1,82 @@
+#ifndef WAVEPLANNER_H
+#define WAVEPLANNER_H
+
+#include "WarehouseSystem.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+// What a wave asks of one product
+struct WaveLine {
+    int productId;
+    string name;
+    string category;
+    int available;      // Stock when planned, -1 if the product is unknown
+    int picked;         // Units to pick for the orders that fit
+    int orders;         // Orders that fit
+    int refused;        // Orders that do not: short stock, unknown, or sold out earlier in the wave
+};
+
+// Pick list for one category: its lines, by ascending product ID
+struct WaveZone {
+    string category;
+    long long picked;
+    int orders;
+    vector<int> lines;  // Indexes into WavePlanner::lines()
+};
+
+// Wave picking: instead of taking orders one at a time, plan() looks at the
+// next pending orders without dequeuing them, adds up quantities per product
+// and per category in one pass, decides in queue order which orders the stock
+// covers (the same decisions processNextOrder would make) and groups the picks
+// into per-category pick lists. commit() then fulfils the wave as one batch:
+// each product's stock, tree copy, catalog, columns and rankings are updated
+// once for all of its orders, then the orders are journalled and traced in
+// queue order and sold-out products removed.
+//
+// The plan stays valid until the front of the queue or the stock of a planned
+// product changes; commit() checks both and refuses a stale plan.
+class WavePlanner {
+private:
+    WarehouseSystem& warehouse;
+    vector<WaveLine> waveLines;
+    vector<WaveZone> waveZones;
+    vector<int> orderLine;              // Per order in queue order: its line
+    vector<int> orderLeft;              // Per order: the product's stock after it, -1 if it does not fit
+    vector<Product*> lineProducts;      // Resolved again by commit
+    vector<int> lineOrder;              // Lines by ascending product ID, the order commit touches them in
+    vector<int> slotKeys;               // Product ID -> line: open addressing, linear probing,
+    vector<int> slotLines;              // -1 = empty slot; sized to at least twice the wave
+    unsigned slotMask;
+    int slotShift;                      // 32 - log2(slots): the hash's top bits pick the slot
+    unordered_map<string, int> zoneOf;  // Category -> zone
+    int firstOrderId, lastOrderId;
+    int fulfilled;
+    long long picked;
+    bool planned;
+
+    int lineFor(const Order& o);        // Existing line of the order's product, or a new one
+    bool stillValid();
+
+public:
+    WavePlanner(WarehouseSystem& w);
+
+    // Plan the next limit pending orders (-1: all), returns the orders in the wave
+    int plan(int limit = -1);
+
+    // Fulfil the planned wave and dequeue its orders; returns the fulfilled
+    // orders, or -1 (changing nothing) if the plan is stale or there is none
+    int commit();
+
+    const vector<WaveLine>& lines() const { return waveLines; }
+    const vector<WaveZone>& zones() const { return waveZones; }
+    int orderCount() const { return (int)orderLine.size(); }
+    int fulfilledCount() const { return fulfilled; }
+    long long pickedUnits() const { return picked; }
+
+    // Pick lists by category, at most maxLines lines each (0 = all)
+    void printPickLists(int maxLines = 0);
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+#define POOL_KEY_SHARDS 64   // Locks over the per-key wait lists
+
+struct PoolTask {
+    function<void()> run;
+    int key;       // Ordering key, only meaningful if keyed
+    bool keyed;
+
+    PoolTask() : key(0), keyed(false) {}
+    PoolTask(function<void()>&& fn, int k, bool isKeyed) : run(std::move(fn)), key(k), keyed(isKeyed) {}
+};
+
+// One worker thread and its deque: the owner pushes and pops at the back,
+// idle workers steal from the front
+struct PoolWorker {
+    thread worker;
+    mutex lock;
+    deque<PoolTask> tasks;
+    long long executed;   // Written by the worker only, read after wait()
+    long long stolen;
+    bool pinned;          // Affinity set to one CPU
+
+    PoolWorker() : executed(0), stolen(0), pinned(false) {}
+};
+
+// Tasks waiting behind a running task with the same key. A key is present
+// while one of its tasks is queued or running.
+struct PoolKeyShard {
+    mutex lock;
+    unordered_map<int, deque<function<void()>>> waiting;
+};
+
+// Work-stealing thread pool. Tasks submitted with the same key run one at a
+// time in submission order; tasks with different keys (and unkeyed tasks) run
+// in parallel. When a keyed task finishes, its worker runs the next task for
+// that key at once, so a hot key occupies one worker while the others steal
+// the rest of its deque.
+class WorkStealingPool {
+private:
+    vector<PoolWorker*> workers;
+    PoolKeyShard keyShards[POOL_KEY_SHARDS];
+    mutex sleepLock;
+    condition_variable wake;   // Idle workers: something was queued, or stopping
+    condition_variable idle;   // wait(): every submitted task has run
+    atomic<int> queued;        // Tasks sitting in some deque
+    atomic<int> unfinished;    // Submitted and not yet run, parked keyed tasks included
+    atomic<unsigned> nextWorker;
+    bool stopping;             // Guarded by sleepLock
+
+    static void workerLoop(WorkStealingPool* pool, int index);
+    void push(PoolTask&& task);
+    bool take(int index, PoolTask& out);
+    void execute(int index, PoolTask& task);
+    void finished();
+
+public:
+    // 0 workers = one per hardware thread. With pinToCpus each worker is bound
+    // to one of the CPUs the process may run on (Linux only, ignored elsewhere).
+    WorkStealingPool(int workerCount = 0, bool pinToCpus = false);
+    ~WorkStealingPool();   // Runs every queued task, then joins
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(function<void()> task);
+    void submit(int key, function<void()> task);   // Serialized with other tasks of this key
+
+    // Block until every task submitted so far has run (not from a worker)
+    void wait();
+
+    int workerCount() { return (int)workers.size(); }
+    int pinnedCount();
+    long long executedBy(int worker) { return workers[worker]->executed; }
+    long long stolenBy(int worker) { return workers[worker]->stolen; }   // Tasks it took from other deques
+};
+
+#endif
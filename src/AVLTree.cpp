@@ -43,17 +43,19 @@ AVLNode* AVLTree::rotateLeft(AVLNode* x){
 
 }
 
-AVLNode* AVLTree::insertN(AVLNode* node, Product p) {
+AVLNode* AVLTree::insertN(AVLNode* node, const Product& p) {
     if (node == nullptr)
-        return new AVLNode(p);
+        return nodePool.create(p);
 
     // BST insert
     if (p.id < node->data.id)
         node->left = insertN(node->left, p);
     else if (p.id > node->data.id)
         node->right = insertN(node->right, p);
-    else
-        return node; // No duplicates
+    else {
+        node->data = p; // Existing ID: replace the product
+        return node;
+    }
 
     // Update height
     node->height = 1 + max(getHeight(node->left), getHeight(node->right));
@@ -86,7 +88,7 @@ AVLNode* AVLTree::insertN(AVLNode* node, Product p) {
 }
 
 
-void AVLTree::insert(Product p) {
+void AVLTree::insert(const Product& p) {
     root = insertN(root, p);
 }
 
@@ -116,7 +118,7 @@ AVLNode* AVLTree::deleteN(AVLNode* node, int id) {
             } else {
                 *node = *temp;
             }
-            delete temp;
+            nodePool.destroy(temp);
         } else {
             AVLNode* temp = minNode(node->right);
             node->data = temp->data;
@@ -180,3 +182,74 @@ void AVLTree::inorder(AVLNode* node) {
 void AVLTree::inorderTraverse() {
     inorder(root);
 }
+
+//iterative in-order walk from the first ID after afterId
+bool AVLTree::collectAfter(bool hasAfter, int afterId, int skip, int limit, vector<Product>& out) {
+    vector<AVLNode*> stack;
+    int collected = 0;
+
+    // Push the path to the lower bound, keeping only nodes still to be visited
+    AVLNode* current = root;
+    while (current != nullptr) {
+        if (!hasAfter || current->data.id > afterId) {
+            stack.push_back(current);
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+
+    while (!stack.empty()) {
+        AVLNode* node = stack.back();
+        stack.pop_back();
+
+        if (skip > 0) {
+            skip--;
+        } else {
+            if (limit > 0 && collected == limit)
+                return true;
+            out.push_back(node->data);
+            collected++;
+        }
+
+        current = node->right;
+        while (current != nullptr) {
+            stack.push_back(current);
+            current = current->left;
+        }
+    }
+    return false;
+}
+
+//height of a checked subtree, -1 once a violation is found
+int AVLTree::checkNode(AVLNode* node, bool hasLow, int low, bool hasHigh, int high, string& problem) {
+    if (node == nullptr)
+        return 0;
+
+    int id = node->data.id;
+    if ((hasLow && id <= low) || (hasHigh && id >= high)) {
+        problem = "ID " + to_string(id) + " is on the wrong side of an ancestor";
+        return -1;
+    }
+
+    int leftHeight = checkNode(node->left, hasLow, low, true, id, problem);
+    if (leftHeight < 0) return -1;
+    int rightHeight = checkNode(node->right, true, id, hasHigh, high, problem);
+    if (rightHeight < 0) return -1;
+
+    if (node->height != 1 + max(leftHeight, rightHeight)) {
+        problem = "node " + to_string(id) + " stores height " + to_string(node->height)
+                + ", actual " + to_string(1 + max(leftHeight, rightHeight));
+        return -1;
+    }
+    if (leftHeight - rightHeight > 1 || rightHeight - leftHeight > 1) {
+        problem = "node " + to_string(id) + " is unbalanced (" + to_string(leftHeight)
+                + " left, " + to_string(rightHeight) + " right)";
+        return -1;
+    }
+    return node->height;
+}
+
+bool AVLTree::checkInvariants(string& problem) {
+    return checkNode(root, false, 0, false, 0, problem) >= 0;
+}
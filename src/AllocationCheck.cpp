@@ -0,0 +1,140 @@
+#include "../include/AllocationCheck.h"
+#include "../include/WarehouseSystem.h"
+#include "../include/Colors.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+using namespace Colors;
+
+#ifdef WAREHOUSE_COUNT_ALLOCS
+static atomic<long long> allocations(0);
+
+// GCC cannot tell these free() calls pair with the malloc() in our own operator new
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t n) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    void* p = malloc(n ? n : 1);
+    if (p == nullptr) throw bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t n) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    void* p = malloc(n ? n : 1);
+    if (p == nullptr) throw bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+#endif
+
+#define ALLOC_CHECK_PRODUCTS 1000
+#define ALLOC_CHECK_BATCH 256
+
+namespace AllocationCheck {
+
+long long allocationCount() {
+#ifdef WAREHOUSE_COUNT_ALLOCS
+    return allocations.load();
+#else
+    return 0;
+#endif
+}
+
+void resetCount() {
+#ifdef WAREHOUSE_COUNT_ALLOCS
+    allocations.store(0);
+#endif
+}
+
+#ifdef WAREHOUSE_COUNT_ALLOCS
+// Every ALLOC_CHECK_SHORT_EVERY-th product holds a single unit, so the orders
+// for it sell it out and take the removal path (tree delete, heap removal,
+// node pool free) inside the measured window
+#define ALLOC_CHECK_SHORT_EVERY 8
+
+static Product stockedProduct(int id) {
+    int stock = id % ALLOC_CHECK_SHORT_EVERY == 0 ? 1 : 1000000000;
+    return Product(id, "Steady state product #" + to_string(id), "Allocation check", stock, 9.99);
+}
+
+// Place a batch of orders across the catalog, then drain the queue
+static void runBatch(WarehouseSystem& warehouse, unsigned& seed) {
+    for (int i = 0; i < ALLOC_CHECK_BATCH; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        int productId = 1 + (int)((seed >> 8) % ALLOC_CHECK_PRODUCTS);
+        warehouse.placeOrder(productId, 1 + (int)(seed % 3));
+    }
+    for (int i = 0; i < ALLOC_CHECK_BATCH; i++) {
+        warehouse.processNextOrder();
+    }
+}
+
+// Put the sold-out products back; building their names allocates, so this
+// runs outside the measured window. Returns how many were re-added.
+static int restock(WarehouseSystem& warehouse) {
+    int readded = 0;
+    for (int id = ALLOC_CHECK_SHORT_EVERY; id <= ALLOC_CHECK_PRODUCTS; id += ALLOC_CHECK_SHORT_EVERY) {
+        if (warehouse.searchProduct(id) != nullptr) continue;
+        warehouse.addProduct(stockedProduct(id));
+        readded++;
+    }
+    return readded;
+}
+#endif
+
+int run(int orders) {
+#ifndef WAREHOUSE_COUNT_ALLOCS
+    (void)orders;
+    cout << Theme::WARNING << "Allocation counting is disabled: rebuild with -DWAREHOUSE_COUNT_ALLOCS." << RESET << endl;
+    return 2;
+#else
+    WarehouseSystem warehouse(ALLOC_CHECK_PRODUCTS, ALLOC_CHECK_PRODUCTS, 2 * ALLOC_CHECK_PRODUCTS);
+    warehouse.setVerbose(false);
+
+    // Names longer than the small-string buffer, so any Product copy would allocate
+    for (int id = 1; id <= ALLOC_CHECK_PRODUCTS; id++) {
+        warehouse.addProduct(stockedProduct(id));
+    }
+
+    // Warm-up: size the order queue and the free lists the sell-outs fill,
+    // and touch every code path once
+    unsigned seed = 12345;
+    for (int i = 0; i < 64; i++) {
+        runBatch(warehouse, seed);
+        restock(warehouse);
+    }
+
+    // Only the batches are counted, the restocking between them is not
+    int batches = (orders + ALLOC_CHECK_BATCH - 1) / ALLOC_CHECK_BATCH;
+    long long count = 0;
+    long long soldOut = 0;
+    for (int i = 0; i < batches; i++) {
+        resetCount();
+        runBatch(warehouse, seed);
+        count += allocationCount();
+        soldOut += restock(warehouse);
+    }
+
+    long long processed = (long long)batches * ALLOC_CHECK_BATCH;
+    if (count == 0) {
+        cout << Theme::SUCCESS << "Allocation check passed: " << processed 
+             << " orders placed and processed, " << soldOut << " products sold out and removed, with 0 heap allocations"
+             << " (re-adding them is not counted)." << RESET << endl;
+        return 0;
+    }
+    cout << Theme::ERR << "Allocation check FAILED: " << count << " heap allocations during " 
+         << processed << " orders (" << soldOut << " sell-outs)." << RESET << endl;
+    return 1;
+#endif
+}
+
+}
@@ -0,0 +1,507 @@
+#include "../include/BPlusTree.h"
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+BPlusNode::BPlusNode(bool isLeaf) : count(0), leaf(isLeaf) {
+    for (int i = 0; i < BPTREE_FANOUT; i++) {
+        keys[i] = 0;
+    }
+}
+
+//constructor
+BPlusTree::BPlusTree() : root(nullptr), size(0) {}
+
+BPlusTree::~BPlusTree() {
+    freeAll();
+}
+
+// Free every node with an explicit stack (no recursion)
+void BPlusTree::freeAll() {
+    if (root == nullptr) return;
+
+    vector<BPlusNode*> stack;
+    stack.push_back(root);
+    while (!stack.empty()) {
+        BPlusNode* node = stack.back();
+        stack.pop_back();
+        if (node->leaf) {
+            delete static_cast<BPlusLeaf*>(node);
+        } else {
+            BPlusInternal* in = static_cast<BPlusInternal*>(node);
+            for (int i = 0; i <= in->count; i++) {
+                stack.push_back(in->children[i]);
+            }
+            delete in;
+        }
+    }
+    root = nullptr;
+    size = 0;
+}
+
+// Compare the key against the whole cache line at once, mask off unused slots
+int BPlusTree::countLess(const int* keys, int n, int key) {
+#ifdef __SSE2__
+    __m128i k = _mm_set1_epi32(key);
+    unsigned mask = 0;
+    for (int i = 0; i < BPTREE_FANOUT; i += 4) {
+        __m128i v = _mm_load_si128((const __m128i*)(keys + i));
+        __m128i less = _mm_cmpgt_epi32(k, v);
+        mask |= (unsigned)_mm_movemask_ps(_mm_castsi128_ps(less)) << i;
+    }
+    mask &= (1u << n) - 1;
+    return __builtin_popcount(mask);
+#else
+    int i = 0;
+    while (i < n && keys[i] < key) i++;
+    return i;
+#endif
+}
+
+int BPlusTree::countLessEq(const int* keys, int n, int key) {
+#ifdef __SSE2__
+    __m128i k = _mm_set1_epi32(key);
+    unsigned greater = 0;
+    for (int i = 0; i < BPTREE_FANOUT; i += 4) {
+        __m128i v = _mm_load_si128((const __m128i*)(keys + i));
+        __m128i gt = _mm_cmpgt_epi32(v, k);
+        greater |= (unsigned)_mm_movemask_ps(_mm_castsi128_ps(gt)) << i;
+    }
+    unsigned mask = ~greater & ((1u << n) - 1);
+    return __builtin_popcount(mask);
+#else
+    int i = 0;
+    while (i < n && keys[i] <= key) i++;
+    return i;
+#endif
+}
+
+// Separators are the smallest key of their right subtree, so go right on equality
+BPlusLeaf* BPlusTree::findLeaf(int id) {
+    BPlusNode* node = root;
+    if (node == nullptr) return nullptr;
+    while (!node->leaf) {
+        BPlusInternal* in = static_cast<BPlusInternal*>(node);
+        node = in->children[countLessEq(in->keys, in->count, id)];
+    }
+    return static_cast<BPlusLeaf*>(node);
+}
+
+Product* BPlusTree::search(int id) {
+    BPlusLeaf* leaf = findLeaf(id);
+    if (leaf == nullptr) return nullptr;
+    int pos = countLess(leaf->keys, leaf->count, id);
+    if (pos < leaf->count && leaf->keys[pos] == id)
+        return &leaf->values[pos];
+    return nullptr;
+}
+
+void BPlusTree::insert(const Product& p) {
+    if (root == nullptr) {
+        BPlusLeaf* leaf = new BPlusLeaf();
+        leaf->keys[0] = p.id;
+        leaf->values[0] = p;
+        leaf->count = 1;
+        root = leaf;
+        size = 1;
+        return;
+    }
+
+    // Descend, remembering the path and the child slot taken at each level
+    BPlusNode* path[BPTREE_MAX_DEPTH];
+    int slots[BPTREE_MAX_DEPTH];
+    int depth = 0;
+    BPlusNode* node = root;
+    while (!node->leaf) {
+        BPlusInternal* in = static_cast<BPlusInternal*>(node);
+        int slot = countLessEq(in->keys, in->count, p.id);
+        path[depth] = node;
+        slots[depth] = slot;
+        depth++;
+        node = in->children[slot];
+    }
+
+    BPlusLeaf* leaf = static_cast<BPlusLeaf*>(node);
+    int pos = countLess(leaf->keys, leaf->count, p.id);
+    if (pos < leaf->count && leaf->keys[pos] == p.id) {
+        leaf->values[pos] = p; // Existing ID: replace the product
+        return;
+    }
+
+    size++;
+    if (leaf->count < BPTREE_FANOUT) {
+        for (int i = leaf->count; i > pos; i--) {
+            leaf->keys[i] = leaf->keys[i - 1];
+            leaf->values[i] = move(leaf->values[i - 1]);
+        }
+        leaf->keys[pos] = p.id;
+        leaf->values[pos] = p;
+        leaf->count++;
+        return;
+    }
+
+    // Split a full leaf: the upper half moves to a new right sibling
+    BPlusLeaf* right = new BPlusLeaf();
+    int total = BPTREE_FANOUT + 1;
+    int leftCount = total / 2;
+    Product incoming = p;
+
+    // Walk the merged sequence (existing keys plus the new one) from the top down
+    int src = BPTREE_FANOUT - 1;
+    for (int dst = total - 1; dst >= 0; dst--) {
+        int key;
+        Product* value;
+        if (dst == pos) {
+            key = p.id;
+            value = &incoming;
+        } else {
+            key = leaf->keys[src];
+            value = &leaf->values[src];
+            src--;
+        }
+        if (dst >= leftCount) {
+            right->keys[dst - leftCount] = key;
+            right->values[dst - leftCount] = move(*value);
+        } else {
+            leaf->keys[dst] = key;
+            if (value != &leaf->values[dst]) leaf->values[dst] = move(*value);
+        }
+    }
+    leaf->count = leftCount;
+    right->count = total - leftCount;
+
+    right->next = leaf->next;
+    right->prev = leaf;
+    if (leaf->next != nullptr) leaf->next->prev = right;
+    leaf->next = right;
+
+    insertIntoParent(path, slots, depth, right->keys[0], right);
+}
+
+// Push a separator and new right child up the recorded path, splitting as needed
+void BPlusTree::insertIntoParent(BPlusNode** path, int* slots, int depth, int separator, BPlusNode* right) {
+    while (depth > 0) {
+        depth--;
+        BPlusInternal* parent = static_cast<BPlusInternal*>(path[depth]);
+        int pos = slots[depth];
+
+        if (parent->count < BPTREE_FANOUT) {
+            for (int i = parent->count; i > pos; i--) {
+                parent->keys[i] = parent->keys[i - 1];
+                parent->children[i + 1] = parent->children[i];
+            }
+            parent->keys[pos] = separator;
+            parent->children[pos + 1] = right;
+            parent->count++;
+            return;
+        }
+
+        // Split a full internal node around its middle key
+        int keys[BPTREE_FANOUT + 1];
+        BPlusNode* children[BPTREE_FANOUT + 2];
+        for (int i = 0, j = 0; i <= BPTREE_FANOUT; i++) {
+            keys[i] = (i == pos) ? separator : parent->keys[j++];
+        }
+        for (int i = 0, j = 0; i <= BPTREE_FANOUT + 1; i++) {
+            children[i] = (i == pos + 1) ? right : parent->children[j++];
+        }
+
+        int mid = (BPTREE_FANOUT + 1) / 2;
+        BPlusInternal* sibling = new BPlusInternal();
+        parent->count = mid;
+        for (int i = 0; i < mid; i++) parent->keys[i] = keys[i];
+        for (int i = 0; i <= mid; i++) parent->children[i] = children[i];
+
+        sibling->count = BPTREE_FANOUT - mid;
+        for (int i = 0; i < sibling->count; i++) sibling->keys[i] = keys[mid + 1 + i];
+        for (int i = 0; i <= sibling->count; i++) sibling->children[i] = children[mid + 1 + i];
+
+        separator = keys[mid];
+        right = sibling;
+    }
+
+    // The root itself split: grow the tree by one level
+    BPlusInternal* newRoot = new BPlusInternal();
+    newRoot->keys[0] = separator;
+    newRoot->children[0] = root;
+    newRoot->children[1] = right;
+    newRoot->count = 1;
+    root = newRoot;
+}
+
+void BPlusTree::remove(int id) {
+    if (root == nullptr) return;
+
+    BPlusNode* path[BPTREE_MAX_DEPTH];
+    int slots[BPTREE_MAX_DEPTH];
+    int depth = 0;
+    BPlusNode* node = root;
+    while (!node->leaf) {
+        BPlusInternal* in = static_cast<BPlusInternal*>(node);
+        int slot = countLessEq(in->keys, in->count, id);
+        path[depth] = node;
+        slots[depth] = slot;
+        depth++;
+        node = in->children[slot];
+    }
+
+    BPlusLeaf* leaf = static_cast<BPlusLeaf*>(node);
+    int pos = countLess(leaf->keys, leaf->count, id);
+    if (pos >= leaf->count || leaf->keys[pos] != id)
+        return;
+
+    for (int i = pos; i < leaf->count - 1; i++) {
+        leaf->keys[i] = leaf->keys[i + 1];
+        leaf->values[i] = move(leaf->values[i + 1]);
+    }
+    leaf->count--;
+    leaf->values[leaf->count] = Product();
+    size--;
+
+    if (depth == 0) {
+        if (leaf->count == 0) {
+            delete leaf;
+            root = nullptr;
+        }
+        return;
+    }
+    if (leaf->count < BPTREE_MIN_KEYS) {
+        path[depth] = leaf;
+        rebalance(path, slots, depth);
+    }
+}
+
+// Fix an underfull node at path[depth] by borrowing from or merging with a sibling,
+// walking up while parents underflow in turn
+void BPlusTree::rebalance(BPlusNode** path, int* slots, int depth) {
+    while (depth > 0) {
+        BPlusNode* node = path[depth];
+        BPlusInternal* parent = static_cast<BPlusInternal*>(path[depth - 1]);
+        int ci = slots[depth - 1];
+
+        if (node->count >= BPTREE_MIN_KEYS) return;
+
+        BPlusNode* left = (ci > 0) ? parent->children[ci - 1] : nullptr;
+        BPlusNode* right = (ci < parent->count) ? parent->children[ci + 1] : nullptr;
+
+        // Borrow the last entry of the left sibling
+        if (left != nullptr && left->count > BPTREE_MIN_KEYS) {
+            if (node->leaf) {
+                BPlusLeaf* n = static_cast<BPlusLeaf*>(node);
+                BPlusLeaf* l = static_cast<BPlusLeaf*>(left);
+                for (int i = n->count; i > 0; i--) {
+                    n->keys[i] = n->keys[i - 1];
+                    n->values[i] = move(n->values[i - 1]);
+                }
+                n->keys[0] = l->keys[l->count - 1];
+                n->values[0] = move(l->values[l->count - 1]);
+                l->values[l->count - 1] = Product();
+                parent->keys[ci - 1] = n->keys[0];
+            } else {
+                BPlusInternal* n = static_cast<BPlusInternal*>(node);
+                BPlusInternal* l = static_cast<BPlusInternal*>(left);
+                for (int i = n->count; i > 0; i--) n->keys[i] = n->keys[i - 1];
+                for (int i = n->count + 1; i > 0; i--) n->children[i] = n->children[i - 1];
+                n->keys[0] = parent->keys[ci - 1];
+                n->children[0] = l->children[l->count];
+                parent->keys[ci - 1] = l->keys[l->count - 1];
+            }
+            left->count--;
+            node->count++;
+            return;
+        }
+
+        // Borrow the first entry of the right sibling
+        if (right != nullptr && right->count > BPTREE_MIN_KEYS) {
+            if (node->leaf) {
+                BPlusLeaf* n = static_cast<BPlusLeaf*>(node);
+                BPlusLeaf* r = static_cast<BPlusLeaf*>(right);
+                n->keys[n->count] = r->keys[0];
+                n->values[n->count] = move(r->values[0]);
+                for (int i = 0; i < r->count - 1; i++) {
+                    r->keys[i] = r->keys[i + 1];
+                    r->values[i] = move(r->values[i + 1]);
+                }
+                r->values[r->count - 1] = Product();
+                parent->keys[ci] = r->keys[0];
+            } else {
+                BPlusInternal* n = static_cast<BPlusInternal*>(node);
+                BPlusInternal* r = static_cast<BPlusInternal*>(right);
+                n->keys[n->count] = parent->keys[ci];
+                n->children[n->count + 1] = r->children[0];
+                parent->keys[ci] = r->keys[0];
+                for (int i = 0; i < r->count - 1; i++) r->keys[i] = r->keys[i + 1];
+                for (int i = 0; i < r->count; i++) r->children[i] = r->children[i + 1];
+            }
+            right->count--;
+            node->count++;
+            return;
+        }
+
+        // Merge with a sibling: always fold the right node of the pair into the left one
+        BPlusNode* into = (left != nullptr) ? left : node;
+        BPlusNode* from = (left != nullptr) ? node : right;
+        int sep = (left != nullptr) ? ci - 1 : ci;
+
+        if (into->leaf) {
+            BPlusLeaf* a = static_cast<BPlusLeaf*>(into);
+            BPlusLeaf* b = static_cast<BPlusLeaf*>(from);
+            for (int i = 0; i < b->count; i++) {
+                a->keys[a->count + i] = b->keys[i];
+                a->values[a->count + i] = move(b->values[i]);
+            }
+            a->count += b->count;
+            a->next = b->next;
+            if (b->next != nullptr) b->next->prev = a;
+            delete b;
+        } else {
+            BPlusInternal* a = static_cast<BPlusInternal*>(into);
+            BPlusInternal* b = static_cast<BPlusInternal*>(from);
+            a->keys[a->count] = parent->keys[sep];
+            for (int i = 0; i < b->count; i++) a->keys[a->count + 1 + i] = b->keys[i];
+            for (int i = 0; i <= b->count; i++) a->children[a->count + 1 + i] = b->children[i];
+            a->count += b->count + 1;
+            delete b;
+        }
+
+        // Drop the separator and the merged-away child from the parent
+        for (int i = sep; i < parent->count - 1; i++) parent->keys[i] = parent->keys[i + 1];
+        for (int i = sep + 1; i < parent->count; i++) parent->children[i] = parent->children[i + 1];
+        parent->count--;
+
+        depth--;
+        if (depth == 0) {
+            // Root with a single child left: shrink the tree by one level
+            if (parent->count == 0) {
+                root = parent->children[0];
+                delete parent;
+            }
+            return;
+        }
+    }
+}
+
+//inorder using id, straight along the leaf chain
+void BPlusTree::inorderTraverse() {
+    BPlusNode* node = root;
+    if (node == nullptr) return;
+    while (!node->leaf) node = static_cast<BPlusInternal*>(node)->children[0];
+
+    for (BPlusLeaf* leaf = static_cast<BPlusLeaf*>(node); leaf != nullptr; leaf = leaf->next) {
+        for (int i = 0; i < leaf->count; i++) {
+            cout << leaf->values[i].name << " (ID: " << leaf->values[i].id << ")" << endl;
+        }
+    }
+}
+
+bool BPlusTree::collectAfter(bool hasAfter, int afterId, int skip, int limit, vector<Product>& out) {
+    BPlusNode* node = root;
+    if (node == nullptr) return false;
+
+    int pos = 0;
+    if (hasAfter) {
+        BPlusLeaf* leaf = findLeaf(afterId);
+        pos = countLessEq(leaf->keys, leaf->count, afterId);
+        node = leaf;
+    } else {
+        while (!node->leaf) node = static_cast<BPlusInternal*>(node)->children[0];
+    }
+
+    int collected = 0;
+    for (BPlusLeaf* leaf = static_cast<BPlusLeaf*>(node); leaf != nullptr; leaf = leaf->next, pos = 0) {
+        for (int i = pos; i < leaf->count; i++) {
+            if (skip > 0) {
+                skip--;
+                continue;
+            }
+            if (limit > 0 && collected == limit)
+                return true;
+            out.push_back(leaf->values[i]);
+            collected++;
+        }
+    }
+    return false;
+}
+
+int BPlusTree::getSize() {
+    return size;
+}
+
+// Keys of node must lie in [low, high); leaves are appended left to right
+bool BPlusTree::checkNode(BPlusNode* node, int depth, bool hasLow, int low, bool hasHigh, int high,
+                          int& leafDepth, vector<BPlusLeaf*>& leaves, string& problem) {
+    if (depth >= BPTREE_MAX_DEPTH) {
+        problem = "tree deeper than BPTREE_MAX_DEPTH";
+        return false;
+    }
+    int minKeys = node == root ? 1 : BPTREE_MIN_KEYS;
+    if (node->count < minKeys || node->count > BPTREE_FANOUT) {
+        problem = "node with " + to_string(node->count) + " keys at depth " + to_string(depth);
+        return false;
+    }
+    for (int i = 0; i < node->count; i++) {
+        int key = node->keys[i];
+        if ((i > 0 && key <= node->keys[i - 1]) || (hasLow && key < low) || (hasHigh && key >= high)) {
+            problem = "key " + to_string(key) + " out of order at depth " + to_string(depth);
+            return false;
+        }
+    }
+
+    if (node->leaf) {
+        BPlusLeaf* leaf = static_cast<BPlusLeaf*>(node);
+        if (leafDepth < 0) leafDepth = depth;
+        if (depth != leafDepth) {
+            problem = "leaves at depths " + to_string(leafDepth) + " and " + to_string(depth);
+            return false;
+        }
+        for (int i = 0; i < leaf->count; i++) {
+            if (leaf->values[i].id != leaf->keys[i]) {
+                problem = "key " + to_string(leaf->keys[i]) + " holds product " + to_string(leaf->values[i].id);
+                return false;
+            }
+        }
+        leaves.push_back(leaf);
+        return true;
+    }
+
+    BPlusInternal* in = static_cast<BPlusInternal*>(node);
+    for (int i = 0; i <= in->count; i++) {
+        bool childHasLow = i > 0 ? true : hasLow;
+        int childLow = i > 0 ? in->keys[i - 1] : low;
+        bool childHasHigh = i < in->count ? true : hasHigh;
+        int childHigh = i < in->count ? in->keys[i] : high;
+        if (!checkNode(in->children[i], depth + 1, childHasLow, childLow, childHasHigh, childHigh, leafDepth, leaves, problem))
+            return false;
+    }
+    return true;
+}
+
+bool BPlusTree::checkInvariants(string& problem) {
+    if (root == nullptr) {
+        if (size != 0) problem = "empty tree with size " + to_string(size);
+        return size == 0;
+    }
+
+    int leafDepth = -1;
+    vector<BPlusLeaf*> leaves;
+    if (!checkNode(root, 0, false, 0, false, 0, leafDepth, leaves, problem))
+        return false;
+
+    int keys = 0;
+    for (size_t i = 0; i < leaves.size(); i++) {
+        BPlusLeaf* expectedPrev = i > 0 ? leaves[i - 1] : nullptr;
+        BPlusLeaf* expectedNext = i + 1 < leaves.size() ? leaves[i + 1] : nullptr;
+        if (leaves[i]->prev != expectedPrev || leaves[i]->next != expectedNext) {
+            problem = "leaf chain broken at leaf " + to_string(i);
+            return false;
+        }
+        keys += leaves[i]->count;
+    }
+    if (keys != size) {
+        problem = to_string(keys) + " keys in the leaves, size says " + to_string(size);
+        return false;
+    }
+    return true;
+}
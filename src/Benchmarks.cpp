@@ -0,0 +1,1493 @@
+#include "../include/Benchmarks.h"
+#include "../include/AVLTree.h"
+#include "../include/BPlusTree.h"
+#include "../include/SalesHeap.h"
+#include "../include/WarehouseFederation.h"
+#include "../include/WorkStealingPool.h"
+#include "../include/OrderPipeline.h"
+#include "../include/WarehouseServer.h"
+#include "../include/Checkpointer.h"
+#include "../include/ColumnarExport.h"
+#include "../include/OrderHistory.h"
+#include "../include/OrderTracing.h"
+#include "../include/OperationTrace.h"
+#include "../include/TraceReplayer.h"
+#include "../include/WavePlanner.h"
+#include "../include/ProductColumns.h"
+#include "../include/PriceIndex.h"
+#include "../include/NameIndex.h"
+#include "../include/FrozenCatalog.h"
+#include "../include/CuckooFilter.h"
+#include "../include/HashMap.h"
+#include "../include/Colors.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace Colors;
+
+namespace Benchmarks {
+
+static double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char* index, const char* op, long long ops, double seconds) {
+    printf("  %-11s %-12s %12.1f ns/op %14.0f ops/s\n", index, op, seconds * 1e9 / (double)ops, (double)ops / seconds);
+}
+
+// Same workload against any index with the ProductIndex interface
+template <typename Index>
+static void runOrderedIndex(const char* label, const vector<int>& keys, const vector<int>& probes) {
+    Index* index = new Index();
+    Product p;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int key : keys) {
+        p.id = key;
+        index->insert(p);
+    }
+    report(label, "insert", (long long)keys.size(), secondsSince(start));
+
+    long long found = 0;
+    start = chrono::steady_clock::now();
+    for (int key : probes) {
+        if (index->search(key) != nullptr) found++;
+    }
+    report(label, "search", (long long)probes.size(), secondsSince(start));
+
+    // 1000 range scans of 1000 consecutive IDs each
+    vector<Product> page;
+    page.reserve(1000);
+    long long scanned = 0;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < 1000; i++) {
+        page.clear();
+        index->collectAfter(true, probes[i], 0, 1000, page);
+        scanned += (long long)page.size();
+    }
+    report(label, "range scan", max(scanned, 1LL), secondsSince(start));
+
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); i += 2) {
+        index->remove(keys[i]);
+    }
+    report(label, "remove", (long long)(keys.size() + 1) / 2, secondsSince(start));
+
+    if (found != (long long)probes.size()) {
+        cout << Theme::ERR << "  " << label << ": " << (probes.size() - found) << " lookups missed!" << RESET << endl;
+    }
+    delete index;
+}
+
+void orderedIndex(int keyCount) {
+    cout << Theme::HEADER << "Ordered index benchmark (" << keyCount << " keys)" << RESET << endl;
+
+    mt19937 rng(42);
+    vector<int> keys(keyCount);
+    for (int i = 0; i < keyCount; i++) keys[i] = i * 2;
+    shuffle(keys.begin(), keys.end(), rng);
+
+    vector<int> probes(keys);
+    shuffle(probes.begin(), probes.end(), rng);
+
+    runOrderedIndex<AVLTree>("AVLTree", keys, probes);
+    runOrderedIndex<BPlusTree>("BPlusTree", keys, probes);
+}
+
+// Skewed product pick: low IDs are hit far more often, like best sellers
+static int skewedPick(mt19937& rng, int n) {
+    unsigned r = rng();
+    return (int)(r % (1u + rng() % (unsigned)n));
+}
+
+// Order processing workload: every sale updates both the low- and best-selling heap
+template <int Arity, bool Indexed>
+static void runSalesHeap(const char* label, int productCount, int updates) {
+    Heap<SalesEntry, FewerSales, SalesEntryId, Arity, Indexed> low(productCount);
+    Heap<SalesEntry, MoreSales, SalesEntryId, Arity, Indexed> best(productCount);
+    vector<int> sales(productCount, 0);
+    mt19937 rng(7);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int id = 0; id < productCount; id++) {
+        low.push(SalesEntry(id, 0));
+        best.push(SalesEntry(id, 0));
+    }
+    report(label, "push", 2LL * productCount, secondsSince(start));
+
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < updates; i++) {
+        int id = skewedPick(rng, productCount);
+        sales[id] += 1 + (int)(rng() % 3);
+        low.update(id, SalesEntry(id, sales[id]));
+        best.update(id, SalesEntry(id, sales[id]));
+    }
+    report(label, "sale update", updates, secondsSince(start));
+
+    if (best.top().salesCount < low.top().salesCount) {
+        cout << Theme::ERR << "  " << label << ": heap order broken!" << RESET << endl;
+    }
+
+    // Delete by ID: half the products, in random order
+    vector<int> doomed(productCount);
+    for (int id = 0; id < productCount; id++) doomed[id] = id;
+    shuffle(doomed.begin(), doomed.end(), rng);
+    doomed.resize(Indexed ? productCount / 2 : min(productCount / 2, 20000));
+    start = chrono::steady_clock::now();
+    for (int id : doomed) {
+        low.remove(id);
+        best.remove(id);
+    }
+    report(label, "delete", (long long)doomed.size(), secondsSince(start));
+}
+
+// Discontinue and introduce SKUs through WarehouseSystem, so the heap policy
+// decides how long removed products linger in the rankings
+static void runCatalogChurn(const char* label, HeapPolicy policy, int productCount) {
+    WarehouseSystem warehouse(16, 16, 16);
+    warehouse.setVerbose(false);
+    warehouse.setHeapPolicy(policy);
+    for (int id = 1; id <= productCount; id++) {
+        warehouse.addProduct(Product(id, "SKU", "Churn", 100, 1.0, id % 97));
+    }
+
+    // Each step retires the oldest live SKU and adds a new one
+    mt19937 rng(13);
+    int steps = productCount * 2;
+    int peak = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < steps; i++) {
+        warehouse.removeProduct(i + 1);
+        warehouse.addProduct(Product(productCount + i + 1, "SKU", "Churn", 100, 1.0, (int)(rng() % 97)));
+        peak = max(peak, warehouse.rankedProductCount());
+    }
+    double seconds = secondsSince(start);
+    report(label, "retire+add", steps, seconds);
+
+    SalesEntry lowest, best;
+    bool ok = warehouse.lowestSelling(lowest) && warehouse.bestSelling(best) &&
+              warehouse.searchProduct(lowest.productId) != nullptr && warehouse.searchProduct(best.productId) != nullptr;
+    printf("  %-11s %d live products, %d ranked after sweep, %d ranked at peak\n", label, warehouse.productCount(),
+           warehouse.rankedProductCount(), peak);
+    if (!ok || warehouse.rankedProductCount() != warehouse.productCount()) {
+        cout << Theme::ERR << "  " << label << ": rankings include discontinued products!" << RESET << endl;
+    }
+}
+
+void salesHeap(int productCount) {
+    int updates = productCount * 10;
+    cout << Theme::HEADER << "Sales heap benchmark (" << productCount << " products, " 
+         << updates << " sales)" << RESET << endl;
+
+    // The unindexed heap scans for the product on every update, keep its run short
+    runSalesHeap<2, false>("2-ary scan", productCount, min(updates, 20000));
+    runSalesHeap<2, true>("2-ary", productCount, updates);
+    runSalesHeap<4, true>("4-ary", productCount, updates);
+    runSalesHeap<8, true>("8-ary", productCount, updates);
+
+    int churnProducts = min(productCount, 200000);
+    cout << Theme::HEADER << "Catalog churn (" << churnProducts << " live SKUs, " << 2 * churnProducts
+         << " retired and replaced)" << RESET << endl;
+    runCatalogChurn("hard delete", HEAP_HARD_DELETE, churnProducts);
+    runCatalogChurn("tombstones", HEAP_TOMBSTONES, churnProducts);
+}
+
+void federation(int orderCount) {
+    const int siteCount = 4;
+    const int skuCount = 10000;
+    cout << Theme::HEADER << "Federation benchmark (" << siteCount << " sites, " << skuCount 
+         << " SKUs, " << orderCount << " orders)" << RESET << endl;
+
+    WarehouseFederation fed(siteCount, skuCount);
+    mt19937 rng(11);
+
+    // Each SKU is stocked at one to all sites
+    for (int id = 1; id <= skuCount; id++) {
+        for (int s = 0; s < siteCount; s++) {
+            if (s == 0 || rng() % 2) {
+                fed.addStock(s, Product(id, "SKU " + to_string(id), "Federated", 20 + (int)(rng() % 200), 10.0));
+            }
+        }
+    }
+    fed.waitIdle();
+
+    long long single = 0, split = 0, rejected = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < orderCount; i++) {
+        int id = 1 + skewedPick(rng, skuCount);
+        vector<SiteAllocation> parts = fed.placeOrder(id, 1 + (int)(rng() % 40));
+        if (parts.empty()) rejected++;
+        else if (parts.size() == 1) single++;
+        else split++;
+
+        // Restocks keep up with demand, following the same popularity
+        if (i % 8 == 0) {
+            int restockId = 1 + skewedPick(rng, skuCount);
+            fed.addStock((int)(rng() % siteCount), Product(restockId, "SKU " + to_string(restockId), "Federated", 200, 10.0));
+        }
+        if (i % 1000 == 999) fed.processPending();
+    }
+    double routeSeconds = secondsSince(start);
+    fed.processPending();
+    fed.waitIdle();
+    double totalSeconds = secondsSince(start);
+
+    report("federation", "route", orderCount, routeSeconds);
+    report("federation", "end-to-end", orderCount, totalSeconds);
+    printf("  single-site %lld, split %lld, rejected %lld\n", single, split, rejected);
+
+    // Every site is idle, so the summary must match the sites' own stock
+    long long mismatches = 0;
+    for (int id = 1; id <= skuCount; id++) {
+        vector<int> bySite = fed.availableBySite(id);
+        for (int s = 0; s < siteCount; s++) {
+            Product* p = fed.siteSystem(s).searchProduct(id);
+            if (bySite[s] != (p != nullptr ? p->quantity : 0)) mismatches++;
+        }
+    }
+    if (mismatches > 0) {
+        cout << Theme::ERR << "  " << mismatches << " SKUs with inconsistent summaries!" << RESET << endl;
+    }
+}
+
+// Same catalog and order queue for every fulfilment run: a few hot SKUs take most orders
+static WarehouseSystem* fulfilmentWarehouse(int skuCount, int orderCount) {
+    WarehouseSystem* w = new WarehouseSystem(skuCount, skuCount, skuCount);
+    w->setVerbose(false);
+    mt19937 rng(23);
+    for (int id = 1; id <= skuCount; id++) {
+        w->addProduct(Product(id, "SKU " + to_string(id), "Fulfilment", 50 + (int)(rng() % 5000), 10.0));
+    }
+    for (int i = 0; i < orderCount; i++) {
+        w->placeOrder(1 + skewedPick(rng, skuCount), 1 + (int)(rng() % 3), rng() % 16 == 0);
+    }
+    return w;
+}
+
+// Stand-in for the per-order work of a real pick (label, carrier call): a
+// dependent chain of multiplies whose result lands in the order's own slot
+static void simulatedPick(const Order& o, vector<unsigned long long>& sink, int work) {
+    unsigned long long x = (unsigned)o.orderId;
+    for (int k = 0; k < work; k++) x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    sink[o.orderId] = x;
+}
+
+static long long fulfilmentMismatches(WarehouseSystem& a, WarehouseSystem& b, int skuCount) {
+    long long mismatches = 0;
+    for (int id = 1; id <= skuCount; id++) {
+        Product* pa = a.searchProduct(id);
+        Product* pb = b.searchProduct(id);
+        if ((pa == nullptr) != (pb == nullptr)) mismatches++;
+        else if (pa != nullptr && (pa->quantity != pb->quantity || pa->salesCount != pb->salesCount)) mismatches++;
+    }
+    return mismatches;
+}
+
+static void runParallelFulfilment(const char* label, WarehouseSystem& serial, int workers, bool pin,
+                                  int skuCount, int orderCount, int work, double serialSeconds) {
+    WarehouseSystem* w = fulfilmentWarehouse(skuCount, orderCount);
+    WorkStealingPool pool(workers, pin);
+    vector<unsigned long long> sink(orderCount + 1);
+    function<void(const Order&)> pick = [&sink, work](const Order& o) { simulatedPick(o, sink, work); };
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int fulfilled = w->processOrdersParallel(pool, -1, pick);
+    double seconds = secondsSince(start);
+
+    long long steals = 0, most = 0, least = orderCount;
+    for (int i = 0; i < pool.workerCount(); i++) {
+        steals += pool.stolenBy(i);
+        most = max(most, pool.executedBy(i));
+        least = min(least, pool.executedBy(i));
+    }
+    report(label, "fulfil", orderCount, seconds);
+    printf("  %-11s %d workers (%d pinned), speedup %.2fx, %d fulfilled, %lld steals, per worker %lld..%lld tasks\n",
+           "", pool.workerCount(), pool.pinnedCount(), serialSeconds / seconds, fulfilled, steals, least, most);
+
+    long long mismatches = fulfilmentMismatches(serial, *w, skuCount);
+    if (mismatches > 0) {
+        cout << Theme::ERR << "  " << mismatches << " SKUs differ from serial processing!" << RESET << endl;
+    }
+    delete w;
+}
+
+void parallelFulfilment(int orderCount) {
+    const int skuCount = 20000;
+    const int work = 2000;
+    int hardware = (int)thread::hardware_concurrency();
+    if (hardware < 1) hardware = 1;
+    cout << Theme::HEADER << "Parallel fulfilment benchmark (" << skuCount << " SKUs, " << orderCount
+         << " skewed orders, " << hardware << " hardware threads)" << RESET << endl;
+
+    // Serial reference: the same pick work, then processNextOrder
+    WarehouseSystem* serial = fulfilmentWarehouse(skuCount, orderCount);
+    vector<unsigned long long> sink(orderCount + 1);
+    int fulfilled = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Order next;
+    while (serial->peekNextOrder(next)) {
+        Product* p = serial->searchProduct(next.productId);
+        if (p != nullptr && p->quantity >= next.quantity) simulatedPick(next, sink, work);
+        if (serial->processNextOrder()) fulfilled++;
+    }
+    double serialSeconds = secondsSince(start);
+    report("serial", "fulfil", orderCount, serialSeconds);
+    printf("  %-11s %d fulfilled\n", "", fulfilled);
+
+    vector<int> counts = {1, 2, 4};
+    if (hardware > 4) counts.push_back(hardware);
+    for (int workers : counts) {
+        runParallelFulfilment("pool", *serial, workers, false, skuCount, orderCount, work, serialSeconds);
+    }
+    runParallelFulfilment("pool pinned", *serial, hardware, true, skuCount, orderCount, work, serialSeconds);
+    delete serial;
+}
+
+#ifdef WAREHOUSE_HAS_COROUTINES
+// One pipeline run with export and history attached, checked against the serial run
+static void runPipeline(WarehouseSystem& serial, long long serialHistory, int capacity,
+                        int skuCount, int orderCount, double serialSeconds) {
+    WarehouseSystem* w = fulfilmentWarehouse(skuCount, orderCount);
+    OrderExporter exporter("warehouse-bench-pipeline.col", EXPORT_COLUMNAR);
+    OrderHistory history;
+    w->setOrderExporter(&exporter);
+    w->setOrderHistory(&history);
+
+    OrderPipeline pipeline(*w, capacity);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int fulfilled = pipeline.run();
+    double seconds = secondsSince(start);
+    w->setOrderExporter(nullptr);
+    w->setOrderHistory(nullptr);
+    exporter.close();
+    remove("warehouse-bench-pipeline.col");
+
+    char label[32];
+    snprintf(label, sizeof(label), "channel %d", capacity);
+    report(label, "fulfil", orderCount, seconds);
+    PipelineStats stats = pipeline.lastRun();
+    printf("  %-11s speedup %.2fx, %d fulfilled, %lld resumes, %lld full-channel waits, deepest %d, %d journal batches (%lld waited)\n",
+           "", serialSeconds / seconds, fulfilled, stats.resumes, stats.backpressure, stats.maxChannelDepth,
+           stats.journalBatches, stats.journalWaits);
+
+    long long mismatches = fulfilmentMismatches(serial, *w, skuCount);
+    if (mismatches > 0 || history.size() != serialHistory) {
+        cout << Theme::ERR << "  " << mismatches << " SKUs differ from serial processing, history has "
+             << history.size() << " of " << serialHistory << " orders!" << RESET << endl;
+    }
+    delete w;
+}
+#endif
+
+void orderPipeline(int orderCount) {
+#ifdef WAREHOUSE_HAS_COROUTINES
+    const int skuCount = 20000;
+    cout << Theme::HEADER << "Order pipeline benchmark (" << skuCount << " SKUs, " << orderCount
+         << " skewed orders, columnar export and history attached)" << RESET << endl;
+
+    WarehouseSystem* serial = fulfilmentWarehouse(skuCount, orderCount);
+    OrderExporter exporter("warehouse-bench-pipeline.col", EXPORT_COLUMNAR);
+    OrderHistory history;
+    serial->setOrderExporter(&exporter);
+    serial->setOrderHistory(&history);
+    int fulfilled = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (serial->pendingOrderCount() > 0) {
+        if (serial->processNextOrder()) fulfilled++;
+    }
+    double serialSeconds = secondsSince(start);
+    serial->setOrderExporter(nullptr);
+    serial->setOrderHistory(nullptr);
+    exporter.close();
+    remove("warehouse-bench-pipeline.col");
+    report("serial", "fulfil", orderCount, serialSeconds);
+    printf("  %-11s %d fulfilled\n", "", fulfilled);
+
+    for (int capacity : {8, PIPELINE_CHANNEL_CAP, 512}) {
+        runPipeline(*serial, history.size(), capacity, skuCount, orderCount, serialSeconds);
+    }
+    delete serial;
+#else
+    (void)orderCount;
+    cout << Theme::ERR << "The order pipeline needs C++20 coroutines (build with -std=c++20)." << RESET << endl;
+#endif
+}
+
+// Orders arrive in bursts of 64 and the floor works through 60 of them between
+// bursts, so the queue builds up and urgent orders overtake it
+static double runTracedOrders(OrderTracer* tracer, int skuCount, int orderCount) {
+    WarehouseSystem warehouse(skuCount, skuCount, skuCount);
+    warehouse.setVerbose(false);
+    for (int id = 1; id <= skuCount; id++) {
+        warehouse.addProduct(Product(id, "SKU " + to_string(id), "Trace", 1000000, 10.0));
+    }
+    warehouse.setOrderTracer(tracer);
+    mt19937 rng(31);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < orderCount; i++) {
+        warehouse.placeOrder(1 + skewedPick(rng, skuCount), 1 + (int)(rng() % 3), rng() % 16 == 0);
+        if (i % 64 == 63) {
+            for (int k = 0; k < 60; k++) warehouse.processNextOrder();
+        }
+    }
+    while (warehouse.pendingOrderCount() > 0) warehouse.processNextOrder();
+    return secondsSince(start);
+}
+
+void orderTracing(int orderCount) {
+    const int skuCount = 20000;
+    cout << Theme::HEADER << "Order tracing benchmark (" << skuCount << " SKUs, " << orderCount
+         << " orders in bursts, backlog growing)" << RESET << endl;
+
+    // Best of three, interleaved, so a noisy neighbour does not land on one variant only
+    double plain = 1e30, traced = 1e30, withSamples = 1e30;
+    OrderTracer histograms;
+    OrderTracer sampled(100);
+    for (int round = 0; round < 3; round++) {
+        histograms.clear();
+        sampled.clear();
+        plain = min(plain, runTracedOrders(nullptr, skuCount, orderCount));
+        traced = min(traced, runTracedOrders(&histograms, skuCount, orderCount));
+        withSamples = min(withSamples, runTracedOrders(&sampled, skuCount, orderCount));
+    }
+    report("untraced", "order", orderCount, plain);
+    report("histograms", "order", orderCount, traced);
+    report("1% sampled", "order", orderCount, withSamples);
+    // Three clock reads per order (placed, dequeued, completed) are most of the cost
+    chrono::steady_clock::time_point clockStart = chrono::steady_clock::now();
+    for (int i = 0; i < 1000000; i++) OrderTracer::now();
+    double clockSeconds = secondsSince(clockStart);
+    printf("  overhead per order: %.1f ns histograms only, %.1f ns with samples (one clock read alone: %.1f ns)\n",
+           (traced - plain) * 1e9 / orderCount, (withSamples - plain) * 1e9 / orderCount, clockSeconds * 1e3);
+
+    sampled.printSummary();
+
+    const char* path = "warehouse-bench.trace.json";
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    bool ok = sampled.writeChromeTrace(path);
+    double seconds = secondsSince(start);
+    FILE* file = fopen(path, "rb");
+    long bytes = 0;
+    if (file != nullptr) {
+        fseek(file, 0, SEEK_END);
+        bytes = ftell(file);
+        fclose(file);
+    }
+    remove(path);
+    if (!ok) {
+        cout << Theme::ERR << "  Could not write " << path << RESET << endl;
+        return;
+    }
+    printf("  trace dump: %d sampled orders, %ld bytes in %.1f ms\n", sampled.sampleCount(), bytes, seconds * 1e3);
+}
+
+// Catalog and orders both go through the recorder when one is given; only the
+// orders are timed
+static double runRecordedOrders(OperationRecorder* recorder, int skuCount, int orderCount) {
+    WarehouseSystem warehouse(skuCount, skuCount, skuCount);
+    warehouse.setVerbose(false);
+    warehouse.setOperationRecorder(recorder);
+    for (int id = 1; id <= skuCount; id++) {
+        warehouse.addProduct(Product(id, "SKU " + to_string(id), "Record", 1000000, 10.0));
+    }
+    mt19937 rng(37);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < orderCount; i++) {
+        warehouse.placeOrder(1 + skewedPick(rng, skuCount), 1 + (int)(rng() % 3), rng() % 16 == 0);
+        if (i % 64 == 63) {
+            for (int k = 0; k < 64; k++) warehouse.processNextOrder();
+        }
+    }
+    while (warehouse.pendingOrderCount() > 0) warehouse.processNextOrder();
+    double seconds = secondsSince(start);
+    warehouse.setOperationRecorder(nullptr);
+    return seconds;
+}
+
+void operationTrace(int orderCount) {
+    const int skuCount = 20000;
+    const char* path = "warehouse-bench.optrace";
+    cout << Theme::HEADER << "Operation trace benchmark (" << skuCount << " SKUs, " << orderCount
+         << " orders placed and processed)" << RESET << endl;
+
+    // Best of three, interleaved; the last recording is kept for the replay
+    double plain = 1e30, recorded = 1e30;
+    long long calls = 0, bytes = 0;
+    for (int round = 0; round < 3; round++) {
+        plain = min(plain, runRecordedOrders(nullptr, skuCount, orderCount));
+        OperationRecorder recorder(path);
+        if (!recorder.isOpen()) {
+            cout << Theme::ERR << "  Could not open " << path << RESET << endl;
+            return;
+        }
+        recorded = min(recorded, runRecordedOrders(&recorder, skuCount, orderCount));
+        calls = recorder.recordCount();
+        if (!recorder.close()) {
+            cout << Theme::ERR << "  Could not write " << path << RESET << endl;
+            return;
+        }
+        bytes = recorder.bytesWritten();
+    }
+    report("unrecorded", "order", orderCount, plain);
+    report("recorded", "order", orderCount, recorded);
+    long long orderCalls = calls - skuCount;
+    printf("  overhead per call: %.1f ns; %lld calls, %.1f bytes per call\n",
+           (recorded - plain) * 1e9 / (double)orderCalls, calls, (double)bytes / (double)calls);
+
+    ReplayConfig config;
+    config.tracePath = path;
+    TraceReplayer(config).run();
+    remove(path);
+}
+
+// Same catalog and backlog on every call: stock is short enough that some
+// orders are refused and some products sell out during the wave
+static void fillWaveBacklog(WarehouseSystem& warehouse, int skuCount, int orderCount) {
+    static const char* categories[] = { "Aisle A", "Aisle B", "Aisle C", "Aisle D", "Aisle E", "Aisle F", "Aisle G", "Aisle H" };
+    warehouse.setVerbose(false);
+    mt19937 rng(41);
+    for (int id = 1; id <= skuCount; id++) {
+        warehouse.addProduct(Product(id, "SKU " + to_string(id), categories[id % 8], 1 + (int)(rng() % 60), 10.0));
+    }
+    for (int i = 0; i < orderCount; i++) {
+        warehouse.placeOrder(1 + skewedPick(rng, skuCount), 1 + (int)(rng() % 3), rng() % 16 == 0);
+    }
+}
+
+void wavePlanning(int orderCount) {
+    const int skuCount = 20000;
+    cout << Theme::HEADER << "Wave planning benchmark (" << skuCount << " SKUs, a backlog of " << orderCount
+         << " orders)" << RESET << endl;
+
+    // Best of three, interleaved; each round starts from the same backlog
+    double serial = 1e30, planning = 1e30, committing = 1e30;
+    int serialFulfilled = 0, waveFulfilled = 0, pending = 0;
+    bool same = true;
+    for (int round = 0; round < 3; round++) {
+        WarehouseSystem oneByOne(skuCount, skuCount, skuCount);
+        fillWaveBacklog(oneByOne, skuCount, orderCount);
+        pending = oneByOne.pendingOrderCount();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        serialFulfilled = 0;
+        while (oneByOne.pendingOrderCount() > 0) {
+            if (oneByOne.processNextOrder()) serialFulfilled++;
+        }
+        serial = min(serial, secondsSince(start));
+
+        WarehouseSystem waved(skuCount, skuCount, skuCount);
+        fillWaveBacklog(waved, skuCount, orderCount);
+        WavePlanner planner(waved);
+        start = chrono::steady_clock::now();
+        planner.plan();
+        planning = min(planning, secondsSince(start));
+        if (round == 2) planner.printPickLists(3);
+        start = chrono::steady_clock::now();
+        waveFulfilled = planner.commit();
+        committing = min(committing, secondsSince(start));
+
+        // Both must end in the same state
+        same = same && waveFulfilled == serialFulfilled && waved.productCount() == oneByOne.productCount()
+            && pending == planner.orderCount();
+        for (int id = 1; id <= skuCount && same; id++) {
+            Product* a = oneByOne.searchProduct(id);
+            Product* b = waved.searchProduct(id);
+            same = (a == nullptr) == (b == nullptr)
+                && (a == nullptr || (a->quantity == b->quantity && a->salesCount == b->salesCount));
+        }
+        string problem;
+        if (!waved.checkConsistency(problem)) {
+            cout << Theme::ERR << "  Inconsistent after the wave: " << problem << RESET << endl;
+            same = false;
+        }
+    }
+    report("one by one", "order", pending, serial);
+    report("wave plan", "order", pending, planning);
+    report("wave commit", "order", pending, committing);
+    printf("  %d of %d pending orders fulfilled; wave %.2f ms (plan %.2f + commit %.2f), one by one %.2f ms\n",
+           waveFulfilled, pending, (planning + committing) * 1e3, planning * 1e3, committing * 1e3, serial * 1e3);
+    if (!same) cout << Theme::ERR << "  The wave and processNextOrder disagree!" << RESET << endl;
+}
+
+static void printLatencies(const char* label, vector<double>& micros) {
+    if (micros.empty()) return;
+    sort(micros.begin(), micros.end());
+    size_t n = micros.size();
+    printf("  %-15s %9zu ops  p50 %7.2f us  p99 %7.2f us  p99.9 %8.2f us  max %9.2f us\n", label, n,
+           micros[n / 2], micros[n * 99 / 100], micros[n * 999 / 1000], micros[n - 1]);
+}
+
+void checkpoint(int productCount) {
+    const double baselineSeconds = 1.0;
+    const double checkpointSeconds = 3.0;
+    const long long rate = 200LL * 1000 * 1000;   // Background write limit, bytes/s
+    cout << Theme::HEADER << "Checkpoint benchmark (" << productCount << " products, order path timed per order)"
+         << RESET << endl;
+
+    WarehouseSystem warehouse(productCount, productCount, productCount);
+    warehouse.setVerbose(false);
+    for (int id = 1; id <= productCount; id++) {
+        warehouse.addProduct(Product(id, "SKU " + to_string(id), "Bench", 1000000000, 10.0));
+    }
+
+    string path = "warehouse-bench.ckpt";
+    Checkpointer checkpointer(warehouse, path, 0.5, rate);
+    mt19937 rng(3);
+    vector<double> idle, during;
+    idle.reserve(8000000);
+    during.reserve(8000000);
+
+    // Place and process one order at a time; checkpoints start every 0.5 s in the second phase
+    chrono::steady_clock::time_point phaseStart = chrono::steady_clock::now();
+    bool checkpointing = false;
+    for (long long i = 0; ; i++) {
+        if ((i & 1023) == 0) {
+            double elapsed = secondsSince(phaseStart);
+            if (!checkpointing && elapsed >= baselineSeconds) checkpointing = true;
+            if (elapsed >= baselineSeconds + checkpointSeconds) break;
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (checkpointing) checkpointer.tick();
+        bool active = checkpointer.inProgress();
+        warehouse.placeOrder(1 + skewedPick(rng, productCount), 1);
+        warehouse.processNextOrder();
+        double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        (active ? during : idle).push_back(micros);
+    }
+    checkpointer.waitIdle();
+
+    CheckpointStats stats = checkpointer.stats();
+    printf("  background: %d checkpoints, last %.1f MB in %.3f s (max %.3f s), limit %.0f MB/s\n",
+           stats.completed, (double)stats.lastBytes / 1e6, stats.lastSeconds, stats.maxSeconds, (double)rate / 1e6);
+    printLatencies("no checkpoint", idle);
+    printLatencies("checkpointing", during);
+
+    // What a checkpoint written on the order thread would stall it for
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    long long bytes = 0;
+    bool ok = Checkpointer::write(warehouse.takeSnapshot(), path, 0, &bytes);
+    printf("  blocking write on the order thread: %.1f MB in %.3f s\n", (double)bytes / 1e6, secondsSince(start));
+
+    // The file must restore to the same catalog
+    WarehouseSystem restored(productCount, productCount, productCount);
+    restored.setVerbose(false);
+    ok = ok && Checkpointer::load(path, restored) && restored.productCount() == warehouse.productCount();
+    for (int id = 1; ok && id <= productCount; id += 97) {
+        Product* a = warehouse.searchProduct(id);
+        Product* b = restored.searchProduct(id);
+        ok = b != nullptr && a->quantity == b->quantity && a->salesCount == b->salesCount && a->name == b->name;
+    }
+    remove(path.c_str());
+    if (!ok) {
+        cout << Theme::ERR << "  Checkpoint did not restore to the same catalog!" << RESET << endl;
+    }
+}
+
+static void reportExport(const char* label, long long rows, long long bytes, double seconds) {
+    printf("  %-15s %10lld rows %9.1f MB %6.2f bytes/row %8.1f MB/s\n", label, rows, (double)bytes / 1e6,
+           (double)bytes / (double)rows, (double)bytes / 1e6 / seconds);
+}
+
+void exportFormats(int productCount) {
+    const char* categoryNames[] = {"Electronics", "Groceries", "Clothing", "Tools", "Toys", "Books", "Garden",
+                                   "Sports", "Beauty", "Automotive", "Office", "Pets"};
+    cout << Theme::HEADER << "Export benchmark (" << productCount << " products, " << productCount
+         << " processed orders)" << RESET << endl;
+
+    VersionedCatalog catalog;
+    mt19937 rng(9);
+    for (int id = 1; id <= productCount; id++) {
+        catalog.put(Product(id, "SKU " + to_string(id), categoryNames[rng() % 12], (int)(rng() % 5000),
+                            (double)(rng() % 100000) / 100.0, (int)(rng() % 100000)));
+    }
+    CatalogSnapshot snap = catalog.snapshot();
+
+    // Reference: the same number of bytes with a plain fwrite
+    vector<char> block(1 << 20, 'x');
+    long long target = (long long)productCount * 40;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    FILE* raw = fopen("warehouse-bench.raw", "wb");
+    long long rawBytes = 0;
+    while (raw != nullptr && rawBytes < target) {
+        rawBytes += (long long)fwrite(block.data(), 1, block.size(), raw);
+    }
+    if (raw != nullptr) fclose(raw);
+    reportExport("raw fwrite", productCount, rawBytes, secondsSince(start));
+    remove("warehouse-bench.raw");
+
+    start = chrono::steady_clock::now();
+    bool ok = ColumnarExport::exportCatalog(snap, "warehouse-bench.col", EXPORT_COLUMNAR);
+    double seconds = secondsSince(start);
+    FILE* f = fopen("warehouse-bench.col", "rb");
+    long long colBytes = 0;
+    if (f != nullptr) {
+        fseek(f, 0, SEEK_END);
+        colBytes = ftell(f);
+        fclose(f);
+    }
+    reportExport("products col", productCount, colBytes, seconds);
+
+    start = chrono::steady_clock::now();
+    ProductExporter csv("warehouse-bench.csv", EXPORT_CSV);
+    snap.forEachProduct([&csv](const Product& p) { csv.append(p); });
+    ok = csv.close() && ok;
+    reportExport("products csv", productCount, csv.bytesWritten(), secondsSince(start));
+
+    vector<Product> decoded;
+    ok = ColumnarExport::readProducts("warehouse-bench.col", decoded) && ok && (int)decoded.size() == productCount;
+    size_t row = 0;
+    snap.forEachProduct([&](const Product& p) {
+        if (row < decoded.size()) {
+            const Product& d = decoded[row++];
+            if (d.id != p.id || d.category != p.category || d.quantity != p.quantity || d.price != p.price ||
+                d.salesCount != p.salesCount) ok = false;
+        }
+    });
+
+    // Processed orders as they would stream out of processNextOrder
+    OrderExporter orders("warehouse-bench.col", EXPORT_COLUMNAR);
+    vector<Order> sent;
+    sent.reserve(productCount);
+    start = chrono::steady_clock::now();
+    for (int i = 1; i <= productCount; i++) {
+        Order o(i, 1 + skewedPick(rng, productCount), 1 + (int)(rng() % 5), rng() % 20 == 0);
+        orders.append(o);
+        sent.push_back(o);
+    }
+    ok = orders.close() && ok;
+    reportExport("orders col", productCount, orders.bytesWritten(), secondsSince(start));
+
+    vector<Order> back;
+    ok = ColumnarExport::readOrders("warehouse-bench.col", back) && ok && back.size() == sent.size();
+    for (size_t i = 0; ok && i < back.size(); i++) {
+        ok = back[i].orderId == sent[i].orderId && back[i].productId == sent[i].productId &&
+             back[i].quantity == sent[i].quantity && back[i].urgent == sent[i].urgent;
+    }
+    remove("warehouse-bench.col");
+    remove("warehouse-bench.csv");
+    if (!ok) {
+        cout << Theme::ERR << "  Columnar files did not decode to the exported rows!" << RESET << endl;
+    }
+}
+
+void orderHistory(int orderCount) {
+    const int skuCount = 1000000;
+    const int queries = 200;
+    cout << Theme::HEADER << "Order history benchmark (" << orderCount << " orders over " << skuCount
+         << " SKUs)" << RESET << endl;
+
+    // Roughly 10k orders per simulated second
+    OrderHistory history;
+    mt19937 rng(13);
+    long long time = 1700000000000000LL;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 1; i <= orderCount; i++) {
+        time += (long long)(rng() % 200);
+        history.append(Order(i, 1 + skewedPick(rng, skuCount), 1 + (int)(rng() % 5), rng() % 20 == 0), time);
+    }
+    report("history", "append", orderCount, secondsSince(start));
+    printf("  %.1f MB stored, %.2f bytes/order including the index\n", (double)history.bytesUsed() / 1e6,
+           (double)history.bytesUsed() / (double)orderCount);
+
+    // All shipments of one SKU: popular (low IDs) and long-tail products
+    vector<HistoryRecord> found;
+    double worst = 0, total = 0;
+    long long rows = 0;
+    for (int q = 0; q < queries; q++) {
+        int id = (q % 2 == 0) ? 1 + (int)(rng() % 100) : 1 + (int)(rng() % skuCount);
+        found.clear();
+        start = chrono::steady_clock::now();
+        history.forProduct(id, found);
+        double seconds = secondsSince(start);
+        worst = max(worst, seconds);
+        total += seconds;
+        rows += (long long)found.size();
+    }
+    printf("  %-11s %-12s %9.3f ms avg %9.3f ms max %10.0f rows/query\n", "history", "by product",
+           total * 1e3 / queries, worst * 1e3, (double)rows / queries);
+
+    // One-second windows anywhere in the history
+    long long first = 1700000000000000LL;
+    worst = 0;
+    total = 0;
+    rows = 0;
+    for (int q = 0; q < queries; q++) {
+        long long from = first + (long long)(rng() % (unsigned long long)max(1LL, time - first));
+        found.clear();
+        start = chrono::steady_clock::now();
+        history.between(from, from + 1000000, found);
+        double seconds = secondsSince(start);
+        worst = max(worst, seconds);
+        total += seconds;
+        rows += (long long)found.size();
+    }
+    printf("  %-11s %-12s %9.3f ms avg %9.3f ms max %10.0f rows/query\n", "history", "1 s window",
+           total * 1e3 / queries, worst * 1e3, (double)rows / queries);
+
+    // Spot-check a small history against a plain vector
+    OrderHistory small;
+    vector<HistoryRecord> all;
+    time = 0;
+    for (int i = 1; i <= 3 * HISTORY_BLOCK_ROWS + 17; i++) {
+        time += (long long)(rng() % 3);
+        Order o(i, 1 + (int)(rng() % 50), 1 + (int)(rng() % 9), rng() % 7 == 0);
+        small.append(o, time);
+        all.push_back(HistoryRecord(time, o));
+    }
+    bool ok = true;
+    for (int id = 1; id <= 50 && ok; id++) {
+        found.clear();
+        small.forProduct(id, time / 3, time / 2, found);
+        size_t k = 0;
+        for (const HistoryRecord& r : all) {
+            if (r.productId != id || r.time < time / 3 || r.time > time / 2) continue;
+            ok = ok && k < found.size() && found[k].orderId == r.orderId && found[k].time == r.time &&
+                 found[k].quantity == r.quantity && found[k].urgent == r.urgent;
+            k++;
+        }
+        ok = ok && k == found.size();
+    }
+    found.clear();
+    small.between(0, time, found);
+    ok = ok && found.size() == all.size();
+    if (!ok) {
+        cout << Theme::ERR << "  History queries disagree with a linear scan!" << RESET << endl;
+    }
+}
+
+void productFilter(int productCount) {
+    const char* categoryNames[] = {"Electronics", "Groceries", "Clothing", "Tools", "Toys", "Books", "Garden",
+                                   "Sports", "Beauty", "Automotive", "Office", "Pets"};
+    const int runs = 10;
+    cout << Theme::HEADER << "Filter benchmark (" << productCount << " products, best of " << runs << " runs)"
+         << RESET << endl;
+
+    ProductColumns columns;
+    columns.reserve(productCount);
+    vector<Product> rows;   // Row-store baseline with the same values
+    rows.reserve(productCount);
+    mt19937 rng(17);
+    for (int id = 1; id <= productCount; id++) {
+        Product p(id, "", categoryNames[rng() % 12], (int)(rng() % 500), (double)(rng() % 100000) / 100.0,
+                  (int)(rng() % 10000));
+        columns.put(p);
+        rows.push_back(p);
+    }
+
+    ProductFilter filter;
+    filter.category = "Tools";
+    filter.maxQuantity = 9;
+    filter.minPrice = 100.0;
+    filter.maxPrice = 250.0;
+
+    double best[5] = {1e9, 1e9, 1e9, 1e9, 1e9};
+    int matches = 0;
+    size_t materialized = 0;
+    for (int run = 0; run < runs; run++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        SelectionBitmap category = columns.categoryEquals(filter.category);
+        best[0] = min(best[0], secondsSince(start));
+
+        start = chrono::steady_clock::now();
+        SelectionBitmap quantity = columns.quantityBetween(filter.minQuantity, filter.maxQuantity);
+        best[1] = min(best[1], secondsSince(start));
+
+        start = chrono::steady_clock::now();
+        SelectionBitmap price = columns.priceBetween(filter.minPrice, filter.maxPrice);
+        best[2] = min(best[2], secondsSince(start));
+
+        start = chrono::steady_clock::now();
+        SelectionBitmap all = columns.select(filter);
+        vector<int> ids = columns.idsOf(all);
+        best[3] = min(best[3], secondsSince(start));
+        matches = all.count();
+        materialized = ids.size();
+
+        // Row store: one pass over whole Product structs
+        start = chrono::steady_clock::now();
+        int scalar = 0;
+        for (const Product& p : rows) {
+            if (p.category == filter.category && p.quantity <= filter.maxQuantity && p.price >= filter.minPrice &&
+                p.price <= filter.maxPrice) scalar++;
+        }
+        best[4] = min(best[4], secondsSince(start));
+        if (scalar != matches) {
+            cout << Theme::ERR << "  Column scan found " << matches << " rows, row scan " << scalar << "!" << RESET << endl;
+            return;
+        }
+    }
+
+    printf("  %-24s %8.2f ms\n", "category = Tools", best[0] * 1e3);
+    printf("  %-24s %8.2f ms\n", "quantity < 10", best[1] * 1e3);
+    printf("  %-24s %8.2f ms\n", "price in [100, 250]", best[2] * 1e3);
+    printf("  %-24s %8.2f ms  (%d matches, %zu IDs)\n", "all three + IDs", best[3] * 1e3, matches, materialized);
+    printf("  %-24s %8.2f ms\n", "row-store loop", best[4] * 1e3);
+}
+
+void priceIndex(int productCount) {
+    const int updates = 1000000;
+    const int queries = 1000;
+    cout << Theme::HEADER << "Price index benchmark (" << productCount << " products)" << RESET << endl;
+
+    PriceIndex index;
+    ProductColumns columns;   // Scan baseline
+    columns.reserve(productCount);
+    vector<double> priceOf(productCount + 1);
+    mt19937 rng(19);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int id = 1; id <= productCount; id++) {
+        priceOf[id] = (double)(rng() % 1000000) / 100.0;
+        index.insert(priceOf[id], id);
+    }
+    report("price", "insert", productCount, secondsSince(start));
+    for (int id = 1; id <= productCount; id++) {
+        columns.put(Product(id, "", "", 1, priceOf[id]));
+    }
+
+    // Repricing: small moves around the current price
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < updates; i++) {
+        int id = 1 + (int)(rng() % productCount);
+        double next = max(0.0, priceOf[id] + (double)((int)(rng() % 201) - 100) / 100.0);
+        index.update(id, priceOf[id], next);
+        columns.setPrice(id, next);
+        priceOf[id] = next;
+    }
+    report("price", "reprice", updates, secondsSince(start));
+
+    // $10-wide windows, first 100 rows, then the same window by a full column scan
+    vector<PriceKey> rows;
+    long long found = 0;
+    start = chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) {
+        double lo = (double)(rng() % 990000) / 100.0;
+        rows.clear();
+        index.range(lo, lo + 10.0, 100, rows);
+        found += (long long)rows.size();
+    }
+    report("price", "range 100", queries, secondsSince(start));
+
+    start = chrono::steady_clock::now();
+    for (int q = 0; q < queries / 10; q++) {
+        double lo = (double)(rng() % 990000) / 100.0;
+        found += columns.priceBetween(lo, lo + 10.0).count();
+    }
+    report("scan", "range all", queries / 10, secondsSince(start));
+
+    start = chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) {
+        int n = 0;
+        index.ascending([&n](const PriceKey&) { return ++n < 100; });
+        found += n;
+    }
+    report("price", "cheapest 100", queries, secondsSince(start));
+
+    // The index must hold every product once, in (price, id) order
+    bool ok = index.getSize() == productCount;
+    PriceKey prev(-1.0, 0);
+    int seen = 0;
+    index.ascending([&](const PriceKey& k) {
+        if (!(prev < k) || priceOf[k.id] != k.price) ok = false;
+        prev = k;
+        seen++;
+        return true;
+    });
+    if (!ok || seen != productCount) {
+        cout << Theme::ERR << "  Price index out of order or out of step!" << RESET << endl;
+    }
+    if (found == 0) cout << Theme::ERR << "  Queries found nothing!" << RESET << endl;
+}
+
+// Pronounceable made-up word from a few syllables
+static string syllableWord(mt19937& rng) {
+    static const char* syllables[] = {"ka", "lo", "mi", "ter", "san", "bel", "dor", "vi", "quen", "ra",
+                                      "mo", "lux", "pen", "tri", "zo", "gar", "nel", "fi", "stra", "cu"};
+    string w;
+    int parts = 2 + (int)(rng() % 3);
+    for (int i = 0; i < parts; i++) w += syllables[rng() % 20];
+    return w;
+}
+
+void nameIndex(int productCount) {
+    const int vocabulary = 50000;
+    const int queries = 2000;
+    cout << Theme::HEADER << "Name index benchmark (" << productCount << " products)" << RESET << endl;
+
+    mt19937 rng(23);
+    vector<string> words(vocabulary);
+    for (string& w : words) w = syllableWord(rng);
+    vector<string> names(productCount + 1);
+    for (int id = 1; id <= productCount; id++) {
+        int count = 2 + (int)(rng() % 3);
+        for (int i = 0; i < count; i++) {
+            if (i > 0) names[id] += ' ';
+            names[id] += words[rng() % vocabulary];
+        }
+        names[id][0] = (char)toupper((unsigned char)names[id][0]);
+    }
+
+    NameIndex index;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int id = 1; id <= productCount; id++) index.add(id, names[id]);
+    report("names", "add", productCount, secondsSince(start));
+    printf("  %d distinct terms\n", index.termCount());
+
+    // Three query shapes over random existing names; each should rank its product in the top 10
+    const char* shapes[] = {"exact", "prefix", "typo"};
+    for (int shape = 0; shape < 3; shape++) {
+        vector<double> latencies;
+        int hits = 0;
+        for (int q = 0; q < queries; q++) {
+            int id = 1 + (int)(rng() % productCount);
+            vector<string> parts;
+            NameIndex::tokenize(names[id], parts);
+            string query;
+            for (size_t i = 0; i < parts.size(); i++) {
+                string w = parts[i];
+                if (shape == 1 && i + 1 == parts.size()) w = w.substr(0, max((size_t)3, w.size() / 2));
+                if (shape == 2 && i == 0) w[rng() % w.size()] = 'x';
+                query += w + ' ';
+            }
+            chrono::steady_clock::time_point t = chrono::steady_clock::now();
+            vector<NameMatch> found = index.search(query, 10);
+            latencies.push_back(secondsSince(t));
+            for (const NameMatch& m : found) {
+                if (m.productId == id) {
+                    hits++;
+                    break;
+                }
+            }
+        }
+        sort(latencies.begin(), latencies.end());
+        double total = 0;
+        for (double l : latencies) total += l;
+        printf("  %-8s avg %7.1f us  p99 %7.1f us  max %7.1f us  found in top 10: %5.1f%%\n", shapes[shape],
+               total / queries * 1e6, latencies[(size_t)(queries * 0.99)] * 1e6, latencies.back() * 1e6,
+               100.0 * hits / queries);
+    }
+
+    // Removed products must drop out of the results
+    index.remove(1, names[1]);
+    vector<NameMatch> after = index.search(names[1], 0);
+    for (const NameMatch& m : after) {
+        if (m.productId == 1) cout << Theme::ERR << "  Removed product still found!" << RESET << endl;
+    }
+}
+
+// Same lookups against the chained HashMap and the frozen perfect-hash table
+void frozenCatalog(int productCount) {
+    const int lookups = 10000000;
+    cout << Theme::HEADER << "Frozen catalog benchmark (" << productCount << " products, " << lookups
+         << " lookups)" << RESET << endl;
+
+    // Sparse IDs, as after years of SKU churn
+    mt19937 rng(29);
+    vector<int> ids;
+    ids.reserve(productCount);
+    HashMap map(16);
+    while ((int)ids.size() < productCount) {
+        int id = (int)(rng() & 0x7fffffff);
+        if (map.contains(id)) continue;
+        map.insert(Product(id, "SKU", "Frozen", 1 + (int)(rng() % 100), 1.0));
+        ids.push_back(id);
+    }
+    vector<Product> products;
+    products.reserve(productCount);
+    map.forEach([&products](Product& p) { products.push_back(p); });
+
+    FrozenCatalog frozen;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    frozen.build(products);
+    double buildSeconds = secondsSince(start);
+    printf("  build %.1f ms, %d buckets (%.1f bits/key of seeds)\n", buildSeconds * 1e3, frozen.bucketCount(),
+           32.0 * frozen.bucketCount() / productCount);
+
+    vector<int> probes(lookups);
+    for (int& id : probes) id = ids[rng() % productCount];
+
+    long long sum = 0;
+    start = chrono::steady_clock::now();
+    for (int id : probes) sum += map.get(id)->quantity;
+    report("HashMap", "hit", lookups, secondsSince(start));
+
+    long long frozenSum = 0;
+    start = chrono::steady_clock::now();
+    for (int id : probes) frozenSum += frozen.get(id)->quantity;
+    report("frozen", "hit", lookups, secondsSince(start));
+
+    // Dependent lookups: each probe waits for the previous product, so memory
+    // latency is paid in full instead of overlapping across lookups
+    int mapChain = 0, frozenChain = 0;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) mapChain = map.get(probes[(i + mapChain) % lookups])->quantity;
+    report("HashMap", "chained hit", lookups, secondsSince(start));
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) frozenChain = frozen.get(probes[(i + frozenChain) % lookups])->quantity;
+    report("frozen", "chained hit", lookups, secondsSince(start));
+
+    // Misses: IDs not in the catalog (IDs are < 2^31, so these are all absent)
+    int falseHits = 0;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+        if (map.get(-1 - probes[i]) != nullptr) falseHits++;
+    }
+    report("HashMap", "miss", lookups, secondsSince(start));
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+        if (frozen.get(-1 - probes[i]) != nullptr) falseHits++;
+    }
+    report("frozen", "miss", lookups, secondsSince(start));
+
+    // Every frozen ID must land on its own product
+    bool ok = sum == frozenSum && mapChain == frozenChain && falseHits == 0 && frozen.size() == productCount;
+    for (int id : ids) {
+        Product* p = frozen.get(id);
+        if (p == nullptr || p->id != id) ok = false;
+    }
+    if (!ok) cout << Theme::ERR << "  Frozen table lookups disagree with the HashMap!" << RESET << endl;
+}
+
+// Per-insert latency while a HashMap grows from 16 buckets, resizing all at
+// once or incrementally; lookups are timed too since they may hit either array
+static void hashMapGrowth(bool incremental, int productCount) {
+    HashMap map(16);
+    map.setIncrementalResize(incremental);
+    LatencyHistogram inserts, lookups;
+    mt19937 rng(43);
+    long long midResize = 0, found = 0;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int id = 1; id <= productCount; id++) {
+        Product p(id, "SKU", "Rehash", 1 + id % 100, 1.0);
+        chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+        map.insert(std::move(p));
+        chrono::steady_clock::time_point t1 = chrono::steady_clock::now();
+        inserts.record(chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count());
+        if (map.isResizing()) midResize++;
+
+        int probe = 1 + (int)(rng() % (unsigned)id);
+        t0 = chrono::steady_clock::now();
+        if (map.get(probe) != nullptr) found++;
+        lookups.record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - t0).count());
+    }
+    double seconds = secondsSince(start);
+
+    const char* label = incremental ? "incremental" : "all at once";
+    LatencyHistogram* rows[2] = { &inserts, &lookups };
+    const char* ops[2] = { "insert", "get" };
+    for (int i = 0; i < 2; i++) {
+        LatencyHistogram& h = *rows[i];
+        printf("  %-12s %-7s p50 %7.0f  p99 %7.0f  p99.9 %7.0f  p99.99 %9.0f  max %11.0f ns\n", label, ops[i],
+               (double)h.percentile(0.50), (double)h.percentile(0.99), (double)h.percentile(0.999),
+               (double)h.percentile(0.9999), (double)h.max());
+    }
+    printf("  %-12s %.2f s total, %lld inserts while a resize was in progress\n", label, seconds, midResize);
+    string problem;
+    if (found != productCount || !map.checkInvariants(problem)) {
+        cout << Theme::ERR << "  HashMap lost products! " << problem << RESET << endl;
+    }
+}
+
+void hashMapResize(int productCount) {
+    cout << Theme::HEADER << "HashMap resize benchmark (" << productCount << " inserts from 16 buckets, "
+         << "a lookup after each)" << RESET << endl;
+    hashMapGrowth(false, productCount);
+    hashMapGrowth(true, productCount);
+}
+
+// Unknown-ID lookups with and without the cuckoo filter in front of the HashMap,
+// then the same traffic through WarehouseSystem for its counters
+void cuckooFilter(int productCount) {
+    const int lookups = 10000000;
+    cout << Theme::HEADER << "Cuckoo filter benchmark (" << productCount << " products, " << lookups
+         << " lookups)" << RESET << endl;
+
+    // Random sparse IDs, unknown ones drawn from the same range
+    mt19937 rng(31);
+    HashMap map(16);
+    vector<int> ids;
+    ids.reserve(productCount);
+    while ((int)ids.size() < productCount) {
+        int id = (int)(rng() & 0x7fffffff);
+        if (map.contains(id)) continue;
+        map.insert(Product(id, "SKU", "Cuckoo", 1, 1.0));
+        ids.push_back(id);
+    }
+
+    CuckooFilter filter(productCount);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int id : ids) {
+        if (!filter.insert(id)) {
+            cout << Theme::ERR << "  Filter full at " << filter.size() << " keys" << RESET << endl;
+            return;
+        }
+    }
+    report("filter", "insert", productCount, secondsSince(start));
+    printf("  %d keys, %.1f bytes/key, load %.2f\n", filter.size(), (double)filter.bytesUsed() / productCount,
+           (double)filter.size() / filter.slotCount());
+
+    vector<int> unknown, known(lookups);
+    unknown.reserve(lookups);
+    while ((int)unknown.size() < lookups) {
+        int id = (int)(rng() & 0x7fffffff);
+        if (!map.contains(id)) unknown.push_back(id);
+    }
+    for (int& id : known) id = ids[rng() % productCount];
+
+    long long found = 0;
+    start = chrono::steady_clock::now();
+    for (int id : unknown) found += map.get(id) != nullptr;
+    report("HashMap", "miss", lookups, secondsSince(start));
+
+    long long passed = 0;
+    start = chrono::steady_clock::now();
+    for (int id : unknown) {
+        if (filter.mayContain(id)) {
+            passed++;
+            found += map.get(id) != nullptr;
+        }
+    }
+    report("filter+map", "miss", lookups, secondsSince(start));
+
+    start = chrono::steady_clock::now();
+    for (int id : known) found += map.get(id) != nullptr;
+    report("HashMap", "hit", lookups, secondsSince(start));
+    start = chrono::steady_clock::now();
+    for (int id : known) found += filter.mayContain(id) && map.get(id) != nullptr;
+    report("filter+map", "hit", lookups, secondsSince(start));
+    printf("  false positive rate %.4f%% (%lld of %d unknown IDs)\n", 100.0 * passed / lookups, passed, lookups);
+
+    // Deleting half the keys must leave no false negatives among the rest
+    for (int i = 0; i < productCount; i += 2) filter.remove(ids[i]);
+    int missing = 0;
+    for (int i = 1; i < productCount; i += 2) {
+        if (!filter.mayContain(ids[i])) missing++;
+    }
+    if (found != 2LL * lookups || missing > 0) {
+        cout << Theme::ERR << "  Filter dropped stored keys!" << RESET << endl;
+    }
+
+    // Through WarehouseSystem: a mix of known and unknown searches
+    WarehouseSystem warehouse(16, 16, 16);
+    warehouse.setVerbose(false);
+    int skus = min(productCount, 100000);
+    for (int i = 0; i < skus; i++) warehouse.addProduct(Product(2 * i, "SKU", "Cuckoo", 1, 1.0));
+    LookupFilterStats before = warehouse.lookupFilterStats();
+    for (int i = 0; i < 1000000; i++) warehouse.searchProduct((int)(rng() % (unsigned)(4 * skus)));
+    LookupFilterStats after = warehouse.lookupFilterStats();
+    printf("  WarehouseSystem: %lld lookups, %lld rejected by the filter, %lld false positives\n",
+           after.lookups - before.lookups, after.rejected - before.rejected, after.falsePositives - before.falsePositives);
+}
+
+void server(int requestCount) {
+#ifdef __linux__
+    const int skuCount = 10000;
+    const int window = 1000;   // Requests in flight on the connection
+    cout << Theme::HEADER << "Server benchmark (" << skuCount << " SKUs, " << requestCount
+         << " pipelined requests over a Unix socket)" << RESET << endl;
+
+    WarehouseSystem warehouse(skuCount, skuCount, skuCount);
+    warehouse.setVerbose(false);
+    for (int id = 1; id <= skuCount; id++) {
+        warehouse.addProduct(Product(id, "SKU " + to_string(id), "Bench", 1000000, 10.0));
+    }
+
+    string path = "/tmp/warehouse-bench-" + to_string((long long)getpid()) + ".sock";
+    WarehouseServer srv(warehouse);
+    if (!srv.listenUnix(path)) {
+        cout << Theme::ERR << "  Could not listen on " << path << RESET << endl;
+        return;
+    }
+    thread serving([&srv]() { srv.run(); });
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        cout << Theme::ERR << "  Could not connect to " << path << RESET << endl;
+        srv.stop();
+        serving.join();
+        return;
+    }
+
+    // 70% SEARCH, 20% ORDER, 10% PROCESS over a skewed key space
+    mt19937 rng(5);
+    string batch;
+    char line[64];
+    char buf[65536];
+    long long errors = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int sent = 0; sent < requestCount; ) {
+        int n = min(window, requestCount - sent);
+        batch.clear();
+        for (int i = 0; i < n; i++) {
+            int roll = (int)(rng() % 10);
+            int id = 1 + skewedPick(rng, skuCount);
+            if (roll < 7) snprintf(line, sizeof(line), "SEARCH %d\n", id);
+            else if (roll < 9) snprintf(line, sizeof(line), "ORDER %d %d\n", id, 1 + (int)(rng() % 5));
+            else snprintf(line, sizeof(line), "PROCESS 4\n");
+            batch += line;
+        }
+        size_t written = 0;
+        while (written < batch.size()) {
+            ssize_t w = write(fd, batch.data() + written, batch.size() - written);
+            if (w <= 0) break;
+            written += (size_t)w;
+        }
+
+        int answered = 0;
+        while (answered < n) {
+            ssize_t r = read(fd, buf, sizeof(buf));
+            if (r <= 0) break;
+            for (ssize_t i = 0; i < r; i++) {
+                if (buf[i] == '\n') answered++;
+                else if (buf[i] == 'E' && (i == 0 || buf[i - 1] == '\n')) errors++;
+            }
+        }
+        sent += n;
+    }
+    double seconds = secondsSince(start);
+    close(fd);
+    srv.stop();
+    serving.join();
+
+    report("server", "request", requestCount, seconds);
+    printf("  error responses %lld, orders still pending %d\n", errors, warehouse.pendingOrderCount());
+#else
+    (void)requestCount;
+    cout << Theme::ERR << "The server benchmark needs Linux (epoll)." << RESET << endl;
+#endif
+}
+
+int run(int argc, char* argv[]) {
+    string name = (argc > 0) ? argv[0] : "";
+    int size = (argc > 1) ? atoi(argv[1]) : 0;
+
+    if (name == "index") {
+        orderedIndex(size > 0 ? size : 10000000);
+        return 0;
+    }
+
+    if (name == "heap") {
+        salesHeap(size > 0 ? size : 1000000);
+        return 0;
+    }
+
+    if (name == "federation") {
+        federation(size > 0 ? size : 1000000);
+        return 0;
+    }
+
+    if (name == "server") {
+        server(size > 0 ? size : 1000000);
+        return 0;
+    }
+
+    if (name == "checkpoint") {
+        checkpoint(size > 0 ? size : 500000);
+        return 0;
+    }
+
+    if (name == "export") {
+        exportFormats(size > 0 ? size : 1000000);
+        return 0;
+    }
+
+    if (name == "history") {
+        orderHistory(size > 0 ? size : 20000000);
+        return 0;
+    }
+
+    if (name == "filter") {
+        productFilter(size > 0 ? size : 10000000);
+        return 0;
+    }
+
+    if (name == "price") {
+        priceIndex(size > 0 ? size : 1000000);
+        return 0;
+    }
+
+    if (name == "rehash") {
+        hashMapResize(size > 0 ? size : 2000000);
+        return 0;
+    }
+
+    if (name == "frozen") {
+        frozenCatalog(size > 0 ? size : 1000000);
+        return 0;
+    }
+
+    if (name == "pool") {
+        parallelFulfilment(size > 0 ? size : 200000);
+        return 0;
+    }
+
+    if (name == "pipeline") {
+        orderPipeline(size > 0 ? size : 1000000);
+        return 0;
+    }
+
+    if (name == "trace") {
+        orderTracing(size > 0 ? size : 1000000);
+        return 0;
+    }
+
+    if (name == "wave") {
+        wavePlanning(size > 0 ? size : 100000);
+        return 0;
+    }
+
+    if (name == "record") {
+        operationTrace(size > 0 ? size : 1000000);
+        return 0;
+    }
+
+    if (name == "cuckoo") {
+        cuckooFilter(size > 0 ? size : 1000000);
+        return 0;
+    }
+
+    if (name == "names") {
+        nameIndex(size > 0 ? size : 1000000);
+        return 0;
+    }
+
+    cout << "Usage: bench <name> [size]" << endl;
+    cout << "  index    AVLTree vs BPlusTree (default 10^7 keys)" << endl;
+    cout << "  heap     binary vs d-ary sales heaps (default 10^6 products)" << endl;
+    cout << "  federation  order routing over 4 site threads (default 10^6 orders)" << endl;
+    cout << "  pool     order fulfilment on the work-stealing pool vs serial (default 2*10^5 orders)" << endl;
+    cout << "  pipeline coroutine order stages vs processNextOrder, export and history on (default 10^6 orders)" << endl;
+    cout << "  trace    cost of queue-wait / service histograms and trace sampling (default 10^6 orders)" << endl;
+    cout << "  wave     plan and commit a wave of pending orders vs processNextOrder (default 10^5 orders)" << endl;
+    cout << "  record   cost of recording every call to an operation trace, then its replay (default 10^6 orders)" << endl;
+    cout << "  server   pipelined requests through the socket server (default 10^6 requests)" << endl;
+    cout << "  checkpoint  order latency while checkpointing in the background (default 5*10^5 products)" << endl;
+    cout << "  export   columnar vs CSV export of products and orders (default 10^6 rows)" << endl;
+    cout << "  history  append and query the processed-order history (default 2*10^7 orders)" << endl;
+    cout << "  filter   column scans vs a row-store loop (default 10^7 products)" << endl;
+    cout << "  price    repricing, price-range and cheapest-N queries (default 10^6 products)" << endl;
+    cout << "  rehash   HashMap insert tail latency, incremental vs all-at-once resize (default 2*10^6 inserts)" << endl;
+    cout << "  frozen   perfect-hash table vs HashMap lookups (default 10^6 products)" << endl;
+    cout << "  cuckoo   unknown-ID lookups with and without the cuckoo filter (default 10^6 products)" << endl;
+    cout << "  names    prefix, exact and misspelled name search (default 10^6 products)" << endl;
+    return 1;
+}
+
+}
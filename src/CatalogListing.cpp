@@ -0,0 +1,169 @@
+#include "../include/CatalogListing.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <queue>
+#include <thread>
+
+// Below this many rows a single thread sorts faster than spawning workers
+#define PARALLEL_SORT_THRESHOLD 50000
+
+bool ListingOrder::before(const Product& a, const Product& b) const {
+    int cmp = 0;
+    switch (sortBy) {
+    case SORT_BY_ID:
+        cmp = (a.id < b.id) ? -1 : (a.id > b.id ? 1 : 0);
+        break;
+    case SORT_BY_NAME:
+        cmp = a.name.compare(b.name);
+        break;
+    case SORT_BY_PRICE:
+        cmp = (a.price < b.price) ? -1 : (a.price > b.price ? 1 : 0);
+        break;
+    case SORT_BY_QUANTITY:
+        cmp = (a.quantity < b.quantity) ? -1 : (a.quantity > b.quantity ? 1 : 0);
+        break;
+    case SORT_BY_SALES:
+        cmp = (a.salesCount < b.salesCount) ? -1 : (a.salesCount > b.salesCount ? 1 : 0);
+        break;
+    }
+    if (descending) cmp = -cmp;
+    if (cmp != 0) return cmp < 0;
+    return a.id < b.id;
+}
+
+ListingPage CatalogListing::list(ProductIndex& tree, const CatalogSnapshot& snap, const ListingQuery& query) {
+    ListingPage page;
+    page.total = snap.productCount();
+
+    if (query.sortBy == SORT_BY_ID && !query.descending) {
+        listById(tree, query, page);
+    } else {
+        listFromSnapshot(snap, query, page);
+    }
+
+    if (page.hasMore && !page.rows.empty()) {
+        page.next.valid = true;
+        page.next.last = page.rows.back();
+    }
+    return page;
+}
+
+// Ascending ID: the index is already ordered, walk from the cursor
+void CatalogListing::listById(ProductIndex& tree, const ListingQuery& query, ListingPage& page) {
+    bool hasAfter = query.cursor.valid;
+    int skip = hasAfter ? 0 : query.offset;
+    page.hasMore = tree.collectAfter(hasAfter, query.cursor.last.id, skip, query.limit, page.rows);
+}
+
+// Any other order: filter the snapshot past the cursor, then select and sort the page
+void CatalogListing::listFromSnapshot(const CatalogSnapshot& snap, const ListingQuery& query, ListingPage& page) {
+    ListingOrder order(query.sortBy, query.descending);
+
+    vector<const Product*> rows;
+    rows.reserve(snap.productCount());
+    if (query.cursor.valid) {
+        const Product& last = query.cursor.last;
+        snap.forEachProduct([&](const Product& p) {
+            if (order.before(last, p)) rows.push_back(&p);
+        });
+    } else {
+        snap.forEachProduct([&](const Product& p) { rows.push_back(&p); });
+    }
+
+    size_t skip = query.cursor.valid ? 0 : (size_t)max(query.offset, 0);
+    if (skip >= rows.size()) return;
+
+    size_t k = 0;
+    if (query.limit > 0) {
+        k = min(rows.size(), skip + (size_t)query.limit);
+    }
+    parallelTopK(rows, order, k);
+
+    size_t end = (k == 0) ? rows.size() : k;
+    page.rows.reserve(end - skip);
+    for (size_t i = skip; i < end; i++) {
+        page.rows.push_back(*rows[i]);
+    }
+    page.hasMore = end < rows.size();
+}
+
+// Each worker partially sorts its chunk down to k rows, then the chunk heads are
+// k-way merged back into rows[0..k)
+void CatalogListing::parallelTopK(vector<const Product*>& rows, const ListingOrder& order, size_t k) {
+    size_t n = rows.size();
+    if (k == 0 || k > n) k = n;
+
+    unsigned workers = thread::hardware_concurrency();
+    if (n < PARALLEL_SORT_THRESHOLD || workers < 2) {
+        partial_sort(rows.begin(), rows.begin() + k, rows.end(), order);
+        return;
+    }
+
+    size_t chunkSize = (n + workers - 1) / workers;
+    vector<size_t> begin, end;
+    for (size_t b = 0; b < n; b += chunkSize) {
+        begin.push_back(b);
+        end.push_back(min(n, b + chunkSize));
+    }
+
+    vector<thread> pool;
+    for (size_t c = 0; c < begin.size(); c++) {
+        size_t b = begin[c];
+        size_t e = end[c];
+        size_t top = min(k, e - b);
+        pool.push_back(thread([&rows, &order, b, e, top]() {
+            partial_sort(rows.begin() + b, rows.begin() + b + top, rows.begin() + e, order);
+        }));
+    }
+    for (thread& t : pool) t.join();
+
+    // Merge the sorted chunk prefixes; heap holds (next index, chunk) per chunk
+    vector<const Product*> merged;
+    merged.reserve(k);
+    vector<size_t> limitOf(begin.size());
+    typedef pair<size_t, size_t> Head;
+    auto later = [&rows, &order](const Head& a, const Head& b) { return order(rows[b.first], rows[a.first]); };
+    priority_queue<Head, vector<Head>, decltype(later)> heads(later);
+    for (size_t c = 0; c < begin.size(); c++) {
+        limitOf[c] = begin[c] + min(k, end[c] - begin[c]);
+        heads.push(Head(begin[c], c));
+    }
+    while (merged.size() < k && !heads.empty()) {
+        Head h = heads.top();
+        heads.pop();
+        merged.push_back(rows[h.first]);
+        if (h.first + 1 < limitOf[h.second]) {
+            heads.push(Head(h.first + 1, h.second));
+        }
+    }
+
+    copy(merged.begin(), merged.end(), rows.begin());
+}
+
+// One row per line, same layout as the catalog display
+string CatalogListing::format(const ListingPage& page) {
+    string out;
+    out.reserve(64 + page.rows.size() * 96);
+
+    char line[160];
+    for (const Product& p : page.rows) {
+        snprintf(line, sizeof(line), "ID: %d, Name: ", p.id);
+        out += line;
+        out += p.name;
+        out += ", Category: ";
+        out += p.category;
+        snprintf(line, sizeof(line), ", Quantity: %d, Price: $%.2f, Sales: %d\n", p.quantity, p.price, p.salesCount);
+        out += line;
+    }
+    snprintf(line, sizeof(line), "(%d row(s) of %d%s)\n", (int)page.rows.size(), page.total,
+             page.hasMore ? ", more available" : "");
+    out += line;
+    return out;
+}
+
+void CatalogListing::print(const ListingPage& page) {
+    string out = format(page);
+    cout.write(out.data(), out.size());
+    cout.flush();
+}
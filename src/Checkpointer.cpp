@@ -0,0 +1,237 @@
+#include "../include/Checkpointer.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define CHECKPOINT_MAGIC "WAREHOUSE-CHECKPOINT"
+#define CHECKPOINT_FORMAT 2   // 2 added the next order ID; format 1 files still load
+#define CHECKPOINT_CHUNK 65536   // Bytes buffered per write, also the throttling granularity
+
+Checkpointer::Checkpointer(WarehouseSystem& system, const string& filePath, double everySeconds, long long maxBytesPerSecond)
+    : warehouse(system), path(filePath), intervalSeconds(everySeconds), bytesPerSecond(maxBytesPerSecond),
+      hasWork(false), stopping(false), writing(false), lastStart(chrono::steady_clock::now()) {
+    writer = thread(writerLoop, this);
+}
+
+Checkpointer::~Checkpointer() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    writer.join();
+}
+
+void Checkpointer::writerLoop(Checkpointer* self) {
+    while (true) {
+        CatalogSnapshot snap;
+        {
+            unique_lock<mutex> guard(self->lock);
+            self->wake.wait(guard, [self]() { return self->stopping || self->hasWork; });
+            if (!self->hasWork) return;
+            snap = self->queued;
+            self->queued = CatalogSnapshot();
+            self->hasWork = false;
+        }
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        long long bytes = 0;
+        bool ok = write(snap, self->path, self->bytesPerSecond, &bytes);
+        long long version = snap.version();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        // Drop the snapshot first, so writers stop copying its pages
+        snap = CatalogSnapshot();
+        {
+            lock_guard<mutex> guard(self->lock);
+            if (ok) {
+                self->totals.completed++;
+                self->totals.lastSeconds = seconds;
+                self->totals.maxSeconds = max(self->totals.maxSeconds, seconds);
+                self->totals.lastBytes = bytes;
+                self->totals.lastVersion = version;
+            } else {
+                self->totals.failed++;
+            }
+            self->writing.store(false);
+        }
+        self->wake.notify_all();
+    }
+}
+
+bool Checkpointer::tick() {
+    if (writing.load()) return false;
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - lastStart).count();
+    if (elapsed < intervalSeconds) return false;
+    return checkpointNow();
+}
+
+bool Checkpointer::checkpointNow() {
+    if (writing.load()) return false;
+    writing.store(true);
+    lastStart = chrono::steady_clock::now();
+
+    CatalogSnapshot snap = warehouse.snapshotForCheckpoint();
+    {
+        lock_guard<mutex> guard(lock);
+        queued = std::move(snap);
+        hasWork = true;
+    }
+    wake.notify_all();
+    return true;
+}
+
+bool Checkpointer::inProgress() {
+    return writing.load();
+}
+
+void Checkpointer::waitIdle() {
+    unique_lock<mutex> guard(lock);
+    wake.wait(guard, [this]() { return !writing.load(); });
+}
+
+CheckpointStats Checkpointer::stats() {
+    lock_guard<mutex> guard(lock);
+    return totals;
+}
+
+// Buffered file writer that sleeps between chunks to stay under a byte rate
+struct ThrottledFile {
+    FILE* file;
+    long long limit;
+    long long written;
+    bool ok;
+    string buffer;
+    chrono::steady_clock::time_point start;
+
+    ThrottledFile(FILE* f, long long bytesPerSecond)
+        : file(f), limit(bytesPerSecond), written(0), ok(true), start(chrono::steady_clock::now()) {
+        buffer.reserve(CHECKPOINT_CHUNK + 1024);
+    }
+
+    void flushChunk() {
+        if (buffer.empty()) return;
+        if (fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) ok = false;
+        written += (long long)buffer.size();
+        buffer.clear();
+
+        if (limit > 0) {
+            double due = (double)written / (double)limit;
+            double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            if (due > elapsed) this_thread::sleep_for(chrono::duration<double>(due - elapsed));
+        }
+    }
+
+    void append(const char* data, size_t n) {
+        buffer.append(data, n);
+        if (buffer.size() >= CHECKPOINT_CHUNK) flushChunk();
+    }
+    void append(const string& s) { append(s.data(), s.size()); }
+};
+
+// Format: a header line (magic, format, version, products, orders, next order ID),
+// then per product "P id qty price sales catLen nameLen\n<cat><name>\n",
+// per pending order "O orderId productId qty urgent\n", and a closing "END\n"
+bool Checkpointer::write(const CatalogSnapshot& snap, const string& path, long long bytesPerSecond, long long* bytesWritten) {
+    string tmpPath = path + ".tmp";
+    FILE* file = fopen(tmpPath.c_str(), "wb");
+    if (file == nullptr) return false;
+
+    ThrottledFile out(file, bytesPerSecond);
+    char line[160];
+    int n = snprintf(line, sizeof(line), "%s %d %lld %d %d %d\n", CHECKPOINT_MAGIC, CHECKPOINT_FORMAT,
+                     snap.version(), snap.productCount(), (int)snap.pendingOrders.size(), snap.nextOrderId);
+    out.append(line, (size_t)n);
+
+    snap.forEachProduct([&](const Product& p) {
+        int len = snprintf(line, sizeof(line), "P %d %d %.17g %d %d %d\n", p.id, p.quantity, p.price,
+                           p.salesCount, (int)p.category.size(), (int)p.name.size());
+        out.append(line, (size_t)len);
+        out.append(p.category);
+        out.append(p.name);
+        out.append("\n", 1);
+    });
+    for (const Order& o : snap.pendingOrders) {
+        int len = snprintf(line, sizeof(line), "O %d %d %d %d\n", o.orderId, o.productId, o.quantity, o.urgent ? 1 : 0);
+        out.append(line, (size_t)len);
+    }
+    out.append("END\n", 4);
+    out.flushChunk();
+
+    // On disk before the rename, or a crash could leave an empty file under the final name
+    bool ok = out.ok && fflush(file) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    // rename() replaces atomically on POSIX; elsewhere the old file must go first
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        remove(path.c_str());
+        if (rename(tmpPath.c_str(), path.c_str()) != 0) return false;
+    }
+    if (bytesWritten != nullptr) *bytesWritten = out.written;
+    return true;
+}
+
+static bool readBytes(FILE* file, int n, string& out) {
+    if (n < 0) return false;
+    out.resize((size_t)n);
+    return n == 0 || fread(&out[0], 1, (size_t)n, file) == (size_t)n;
+}
+
+bool Checkpointer::load(const string& path, WarehouseSystem& into, bool* missing) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (missing != nullptr) *missing = file == nullptr && errno == ENOENT;
+    if (file == nullptr) return false;
+
+    char magic[32];
+    int format, productCount, orderCount, nextOrderId = 0;
+    long long version;
+    if (fscanf(file, "%31s %d %lld %d %d", magic, &format, &version, &productCount, &orderCount) != 5 ||
+        strcmp(magic, CHECKPOINT_MAGIC) != 0 || format < 1 || format > CHECKPOINT_FORMAT ||
+        (format >= 2 && fscanf(file, "%d", &nextOrderId) != 1)) {
+        fclose(file);
+        return false;
+    }
+
+    bool ok = productCount >= 0 && orderCount >= 0 && nextOrderId >= 0;
+    vector<Product> products;
+    for (int i = 0; i < productCount && ok; i++) {
+        Product p;
+        int catLen = 0, nameLen = 0;
+        ok = fscanf(file, " P %d %d %lf %d %d %d", &p.id, &p.quantity, &p.price, &p.salesCount, &catLen, &nameLen) == 6 &&
+             fgetc(file) == '\n' && readBytes(file, catLen, p.category) && readBytes(file, nameLen, p.name);
+        if (ok) products.push_back(std::move(p));
+    }
+
+    vector<Order> orders;
+    for (int i = 0; i < orderCount && ok; i++) {
+        Order o;
+        int urgent = 0;
+        ok = fscanf(file, " O %d %d %d %d", &o.orderId, &o.productId, &o.quantity, &urgent) == 4;
+        o.urgent = urgent != 0;
+        orders.push_back(o);
+    }
+
+    char end[8];
+    ok = ok && fscanf(file, "%7s", end) == 1 && strcmp(end, "END") == 0;
+    fclose(file);
+    if (!ok) return false;
+
+    // Only a complete file is applied
+    for (Product& p : products) into.addProduct(std::move(p));
+    into.restorePendingOrders(orders, nextOrderId);
+    return true;
+}
@@ -0,0 +1,444 @@
+#include "../include/ColumnarExport.h"
+#include "../include/Varint.h"
+#include <cstring>
+
+// Columnar file layout (all integers little-endian or LEB128 varints):
+//   header  "WHCOL1" + kind ('P' products, 'O' orders) + '\0'
+//   block   varint rows (0 ends the file)
+//           products only: varint newEntries, then per entry varint id, varint len, bytes
+//           per column: u8 encoding, varint byteLength, encoded values
+//   trailer varint total rows
+// Product columns: id, category, quantity, price, salesCount.
+// Order columns: orderId, productId, quantity, urgent.
+#define EXPORT_BUFFER_BYTES (1 << 20)
+
+#define ENC_DELTA 1    // Zigzag varint of the difference to the previous value in the block
+#define ENC_VARINT 2   // Zigzag varint
+#define ENC_DICT 3     // Unsigned varint dictionary ID
+#define ENC_F64 4      // Raw 8-byte IEEE double
+#define ENC_BITS 5     // One bit per row, LSB first
+
+static const char PRODUCT_MAGIC[8] = {'W', 'H', 'C', 'O', 'L', '1', 'P', '\0'};
+static const char ORDER_MAGIC[8] = {'W', 'H', 'C', 'O', 'L', '1', 'O', '\0'};
+
+// ---------- encoding helpers ----------
+
+static void putVarint(vector<unsigned char>& out, unsigned long long v) {
+    unsigned char bytes[10];
+    out.insert(out.end(), bytes, writeVarint(bytes, v));
+}
+
+// Varint columns are encoded into a buffer sized for the worst case, then trimmed
+static void encodeDelta(vector<unsigned char>& out, const vector<int>& values) {
+    out.resize(values.size() * 10);
+    unsigned char* dst = out.data();
+    long long prev = 0;
+    for (int v : values) {
+        dst = writeVarint(dst, zigzag((long long)v - prev));
+        prev = v;
+    }
+    out.resize((size_t)(dst - out.data()));
+}
+
+static void encodeVarint(vector<unsigned char>& out, const vector<int>& values) {
+    out.resize(values.size() * 10);
+    unsigned char* dst = out.data();
+    for (int v : values) dst = writeVarint(dst, zigzag(v));
+    out.resize((size_t)(dst - out.data()));
+}
+
+static void encodeDict(vector<unsigned char>& out, const vector<int>& values) {
+    out.resize(values.size() * 5);
+    unsigned char* dst = out.data();
+    for (int v : values) dst = writeVarint(dst, (unsigned long long)(unsigned)v);
+    out.resize((size_t)(dst - out.data()));
+}
+
+static void encodeF64(vector<unsigned char>& out, const vector<double>& values) {
+    out.resize(values.size() * 8);
+    unsigned char* dst = out.data();
+    for (double d : values) {
+        unsigned long long bits;
+        memcpy(&bits, &d, sizeof(bits));
+        for (int i = 0; i < 8; i++) *dst++ = (unsigned char)(bits >> (8 * i));
+    }
+}
+
+static void encodeBits(vector<unsigned char>& out, const vector<bool>& values) {
+    unsigned char byte = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (values[i]) byte |= (unsigned char)(1u << (i % 8));
+        if (i % 8 == 7) {
+            out.push_back(byte);
+            byte = 0;
+        }
+    }
+    if (values.size() % 8 != 0) out.push_back(byte);
+}
+
+// Write one encoded column: encoding, length, bytes
+static void putColumn(ExportFile& file, unsigned char encoding, vector<unsigned char>& column, vector<unsigned char>& prefix) {
+    prefix.clear();
+    prefix.push_back(encoding);
+    putVarint(prefix, column.size());
+    file.put(prefix.data(), prefix.size());
+    file.put(column.data(), column.size());
+    column.clear();
+}
+
+static void putVarintTo(ExportFile& file, unsigned long long v) {
+    unsigned char bytes[10];
+    file.put(bytes, (size_t)(writeVarint(bytes, v) - bytes));
+}
+
+// Quote a CSV field only when it needs it
+static void putCsvField(ExportFile& file, const string& s) {
+    if (s.find_first_of(",\"\n\r") == string::npos) {
+        file.put(s);
+        return;
+    }
+    string quoted = "\"";
+    for (char c : s) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    quoted += '"';
+    file.put(quoted);
+}
+
+// ---------- ExportFile ----------
+
+ExportFile::ExportFile() : file(nullptr), written(0), failed(false) {}
+
+ExportFile::~ExportFile() {
+    close();
+}
+
+bool ExportFile::open(const string& path) {
+    file = fopen(path.c_str(), "wb");
+    buffer.reserve(EXPORT_BUFFER_BYTES);
+    return file != nullptr;
+}
+
+void ExportFile::put(const void* data, size_t n) {
+    if (file == nullptr) return;
+    if (buffer.size() + n > EXPORT_BUFFER_BYTES) {
+        if (!buffer.empty() && fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) failed = true;
+        buffer.clear();
+    }
+    if (n > EXPORT_BUFFER_BYTES) {
+        if (fwrite(data, 1, n, file) != n) failed = true;
+    } else {
+        const unsigned char* bytes = (const unsigned char*)data;
+        buffer.insert(buffer.end(), bytes, bytes + n);
+    }
+    written += (long long)n;
+}
+
+bool ExportFile::close() {
+    if (file == nullptr) return !failed;
+    if (!buffer.empty() && fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) failed = true;
+    buffer.clear();
+    if (fclose(file) != 0) failed = true;
+    file = nullptr;
+    return !failed;
+}
+
+// ---------- ProductExporter ----------
+
+ProductExporter::ProductExporter(const string& path, ExportFormat fmt) : format(fmt), rows(0) {
+    if (!out.open(path)) return;
+    if (format == EXPORT_CSV) {
+        out.put(string("id,category,quantity,price,salesCount\n"));
+    } else {
+        out.put(PRODUCT_MAGIC, sizeof(PRODUCT_MAGIC));
+        ids.reserve(EXPORT_BLOCK_ROWS);
+        categories.reserve(EXPORT_BLOCK_ROWS);
+        quantities.reserve(EXPORT_BLOCK_ROWS);
+        sales.reserve(EXPORT_BLOCK_ROWS);
+        prices.reserve(EXPORT_BLOCK_ROWS);
+    }
+}
+
+ProductExporter::~ProductExporter() {
+    close();
+}
+
+void ProductExporter::append(const Product& p) {
+    if (!out.isOpen()) return;
+    rows++;
+
+    if (format == EXPORT_CSV) {
+        char line[96];
+        int n = snprintf(line, sizeof(line), "%d,", p.id);
+        out.put(line, (size_t)n);
+        putCsvField(out, p.category);
+        n = snprintf(line, sizeof(line), ",%d,%.2f,%d\n", p.quantity, p.price, p.salesCount);
+        out.put(line, (size_t)n);
+        return;
+    }
+
+    unordered_map<string, int>::iterator it = categoryIds.find(p.category);
+    int category;
+    if (it != categoryIds.end()) {
+        category = it->second;
+    } else {
+        category = (int)dictionary.size();
+        dictionary.push_back(p.category);
+        categoryIds[p.category] = category;
+        newEntries.push_back(category);
+    }
+
+    ids.push_back(p.id);
+    categories.push_back(category);
+    quantities.push_back(p.quantity);
+    prices.push_back(p.price);
+    sales.push_back(p.salesCount);
+    if ((int)ids.size() == EXPORT_BLOCK_ROWS) writeBlock();
+}
+
+void ProductExporter::writeBlock() {
+    if (ids.empty()) return;
+    putVarintTo(out, ids.size());
+
+    putVarintTo(out, newEntries.size());
+    for (int id : newEntries) {
+        putVarintTo(out, (unsigned long long)id);
+        putVarintTo(out, dictionary[id].size());
+        out.put(dictionary[id]);
+    }
+    newEntries.clear();
+
+    vector<unsigned char> prefix;
+    encodeDelta(scratch, ids);
+    putColumn(out, ENC_DELTA, scratch, prefix);
+    encodeDict(scratch, categories);
+    putColumn(out, ENC_DICT, scratch, prefix);
+    encodeVarint(scratch, quantities);
+    putColumn(out, ENC_VARINT, scratch, prefix);
+    encodeF64(scratch, prices);
+    putColumn(out, ENC_F64, scratch, prefix);
+    encodeVarint(scratch, sales);
+    putColumn(out, ENC_VARINT, scratch, prefix);
+
+    ids.clear();
+    categories.clear();
+    quantities.clear();
+    prices.clear();
+    sales.clear();
+}
+
+bool ProductExporter::close() {
+    if (!out.isOpen()) return false;
+    if (format == EXPORT_COLUMNAR) {
+        writeBlock();
+        putVarintTo(out, 0);
+        putVarintTo(out, (unsigned long long)rows);
+    }
+    return out.close();
+}
+
+// ---------- OrderExporter ----------
+
+OrderExporter::OrderExporter(const string& path, ExportFormat fmt) : format(fmt), rows(0) {
+    if (!out.open(path)) return;
+    if (format == EXPORT_CSV) {
+        out.put(string("orderId,productId,quantity,urgent\n"));
+    } else {
+        out.put(ORDER_MAGIC, sizeof(ORDER_MAGIC));
+        orderIds.reserve(EXPORT_BLOCK_ROWS);
+        productIds.reserve(EXPORT_BLOCK_ROWS);
+        quantities.reserve(EXPORT_BLOCK_ROWS);
+        urgent.reserve(EXPORT_BLOCK_ROWS);
+    }
+}
+
+OrderExporter::~OrderExporter() {
+    close();
+}
+
+void OrderExporter::append(const Order& o) {
+    if (!out.isOpen()) return;
+    rows++;
+
+    if (format == EXPORT_CSV) {
+        char line[64];
+        int n = snprintf(line, sizeof(line), "%d,%d,%d,%d\n", o.orderId, o.productId, o.quantity, o.urgent ? 1 : 0);
+        out.put(line, (size_t)n);
+        return;
+    }
+
+    orderIds.push_back(o.orderId);
+    productIds.push_back(o.productId);
+    quantities.push_back(o.quantity);
+    urgent.push_back(o.urgent);
+    if ((int)orderIds.size() == EXPORT_BLOCK_ROWS) writeBlock();
+}
+
+void OrderExporter::writeBlock() {
+    if (orderIds.empty()) return;
+    putVarintTo(out, orderIds.size());
+
+    vector<unsigned char> prefix;
+    encodeDelta(scratch, orderIds);
+    putColumn(out, ENC_DELTA, scratch, prefix);
+    encodeDelta(scratch, productIds);
+    putColumn(out, ENC_DELTA, scratch, prefix);
+    encodeVarint(scratch, quantities);
+    putColumn(out, ENC_VARINT, scratch, prefix);
+    encodeBits(scratch, urgent);
+    putColumn(out, ENC_BITS, scratch, prefix);
+
+    orderIds.clear();
+    productIds.clear();
+    quantities.clear();
+    urgent.clear();
+}
+
+bool OrderExporter::close() {
+    if (!out.isOpen()) return false;
+    if (format == EXPORT_COLUMNAR) {
+        writeBlock();
+        putVarintTo(out, 0);
+        putVarintTo(out, (unsigned long long)rows);
+    }
+    return out.close();
+}
+
+// ---------- reading ----------
+
+// Cursor over a whole file loaded in memory
+struct ColumnReader {
+    vector<unsigned char> data;
+    size_t pos;
+    bool ok;
+
+    ColumnReader() : pos(0), ok(true) {}
+
+    bool load(const string& path) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr) return false;
+        unsigned char chunk[65536];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) data.insert(data.end(), chunk, chunk + n);
+        fclose(file);
+        return true;
+    }
+    unsigned long long varint() {
+        unsigned long long v;
+        const unsigned char* next = readVarint(data.data() + pos, data.data() + data.size(), v);
+        if (next == nullptr) {
+            ok = false;
+            return 0;
+        }
+        pos = (size_t)(next - data.data());
+        return v;
+    }
+    // Start of a column with the expected encoding, returns its end offset
+    size_t column(unsigned char encoding) {
+        if (pos >= data.size() || data[pos] != encoding) {
+            ok = false;
+            return pos;
+        }
+        pos++;
+        size_t len = (size_t)varint();
+        if (pos + len > data.size()) ok = false;
+        return pos + len;
+    }
+    void ints(unsigned char encoding, size_t rows, vector<long long>& out) {
+        size_t end = column(encoding);
+        out.clear();
+        long long prev = 0;
+        for (size_t i = 0; i < rows && ok; i++) {
+            unsigned long long raw = varint();
+            if (encoding == ENC_DICT) out.push_back((long long)raw);
+            else if (encoding == ENC_DELTA) out.push_back(prev += unzigzag(raw));
+            else out.push_back(unzigzag(raw));
+        }
+        if (pos != end) ok = false;
+    }
+    bool magic(const char expected[8]) {
+        if (data.size() < 8 || memcmp(data.data(), expected, 8) != 0) return false;
+        pos = 8;
+        return true;
+    }
+};
+
+bool ColumnarExport::readProducts(const string& path, vector<Product>& out) {
+    ColumnReader r;
+    if (!r.load(path) || !r.magic(PRODUCT_MAGIC)) return false;
+
+    vector<string> dictionary;
+    vector<long long> ids, categories, quantities, sales;
+    long long total = 0;
+    while (r.ok) {
+        size_t rows = (size_t)r.varint();
+        if (rows == 0) break;
+
+        size_t entries = (size_t)r.varint();
+        for (size_t i = 0; i < entries && r.ok; i++) {
+            size_t id = (size_t)r.varint();
+            size_t len = (size_t)r.varint();
+            if (r.pos + len > r.data.size() || id != dictionary.size()) {
+                r.ok = false;
+                break;
+            }
+            dictionary.push_back(string((const char*)&r.data[r.pos], len));
+            r.pos += len;
+        }
+
+        r.ints(ENC_DELTA, rows, ids);
+        r.ints(ENC_DICT, rows, categories);
+        r.ints(ENC_VARINT, rows, quantities);
+        size_t priceEnd = r.column(ENC_F64);
+        if (!r.ok || priceEnd - r.pos != rows * 8) return false;
+        size_t priceStart = r.pos;
+        r.pos = priceEnd;
+        r.ints(ENC_VARINT, rows, sales);
+        if (!r.ok) return false;
+
+        for (size_t i = 0; i < rows; i++) {
+            if (categories[i] >= (long long)dictionary.size()) return false;
+            unsigned long long bits = 0;
+            for (int b = 0; b < 8; b++) bits |= (unsigned long long)r.data[priceStart + i * 8 + b] << (8 * b);
+            double price;
+            memcpy(&price, &bits, sizeof(price));
+            out.push_back(Product((int)ids[i], "", dictionary[categories[i]], (int)quantities[i], price, (int)sales[i]));
+        }
+        total += (long long)rows;
+    }
+    return r.ok && (long long)r.varint() == total && r.ok;
+}
+
+bool ColumnarExport::readOrders(const string& path, vector<Order>& out) {
+    ColumnReader r;
+    if (!r.load(path) || !r.magic(ORDER_MAGIC)) return false;
+
+    vector<long long> orderIds, productIds, quantities;
+    long long total = 0;
+    while (r.ok) {
+        size_t rows = (size_t)r.varint();
+        if (rows == 0) break;
+
+        r.ints(ENC_DELTA, rows, orderIds);
+        r.ints(ENC_DELTA, rows, productIds);
+        r.ints(ENC_VARINT, rows, quantities);
+        size_t bitsEnd = r.column(ENC_BITS);
+        if (!r.ok || bitsEnd - r.pos != (rows + 7) / 8) return false;
+
+        for (size_t i = 0; i < rows; i++) {
+            bool urgent = (r.data[r.pos + i / 8] >> (i % 8)) & 1;
+            out.push_back(Order((int)orderIds[i], (int)productIds[i], (int)quantities[i], urgent));
+        }
+        r.pos = bitsEnd;
+        total += (long long)rows;
+    }
+    return r.ok && (long long)r.varint() == total && r.ok;
+}
+
+bool ColumnarExport::exportCatalog(const CatalogSnapshot& snap, const string& path, ExportFormat fmt) {
+    ProductExporter exporter(path, fmt);
+    if (!exporter.isOpen()) return false;
+    snap.forEachProduct([&exporter](const Product& p) { exporter.append(p); });
+    return exporter.close();
+}
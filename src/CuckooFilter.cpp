@@ -0,0 +1,115 @@
+#include "../include/CuckooFilter.h"
+#include <cstring>
+
+CuckooFilter::CuckooFilter(int expectedKeys) : bucketMask(0), count(0), kickState(2463534242u) {
+    reset(expectedKeys);
+}
+
+// Power-of-two bucket count so the alternate bucket is an XOR away
+void CuckooFilter::reset(int expectedKeys) {
+    unsigned needed = (unsigned)((double)expectedKeys / (CUCKOO_BUCKET_SLOTS * CUCKOO_TARGET_LOAD)) + 1;
+    unsigned buckets = 1;
+    while (buckets < needed) buckets <<= 1;
+    table.assign((size_t)buckets * CUCKOO_BUCKET_SLOTS, 0);
+    bucketMask = buckets - 1;
+    count = 0;
+}
+
+unsigned long long CuckooFilter::hashKey(int key) {
+    unsigned long long x = (unsigned)key;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+unsigned CuckooFilter::altBucket(unsigned bucket, unsigned short fp) const {
+    return (bucket ^ ((unsigned)fp * 0x5bd1e995u)) & bucketMask;
+}
+
+bool CuckooFilter::place(unsigned bucket, unsigned short fp) {
+    unsigned short* slots = &table[(size_t)bucket * CUCKOO_BUCKET_SLOTS];
+    for (int i = 0; i < CUCKOO_BUCKET_SLOTS; i++) {
+        if (slots[i] == 0) {
+            slots[i] = fp;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Fingerprint from the high bits, bucket from the low bits (0 is reserved for empty)
+void CuckooFilter::split(int key, unsigned& bucket, unsigned short& fp) const {
+    unsigned long long h = hashKey(key);
+    fp = (unsigned short)(h >> 48);
+    if (fp == 0) fp = 1;
+    bucket = (unsigned)h & bucketMask;
+}
+
+// A bucket is one 64-bit word of four fingerprints: XOR with the fingerprint in
+// every lane and test for a zero lane, without branches. Which slot holds a
+// fingerprint is random, so a loop with an early exit mispredicts on most
+// lookups and flushes the caller's in-flight loads with it.
+static bool bucketHas(const unsigned short* slots, unsigned short fp) {
+    unsigned long long word;
+    memcpy(&word, slots, sizeof(word));
+    unsigned long long v = word ^ ((unsigned long long)fp * 0x0001000100010001ULL);
+    return ((v - 0x0001000100010001ULL) & ~v & 0x8000800080008000ULL) != 0;
+}
+
+bool CuckooFilter::insert(int key) {
+    unsigned b1;
+    unsigned short fp;
+    split(key, b1, fp);
+    unsigned b2 = altBucket(b1, fp);
+    if (place(b1, fp) || place(b2, fp)) {
+        count++;
+        return true;
+    }
+
+    // Both full: evict a random resident and move it to its other bucket
+    unsigned bucket = (kickState & 1) ? b1 : b2;
+    for (int kick = 0; kick < CUCKOO_MAX_KICKS; kick++) {
+        kickState ^= kickState << 13;
+        kickState ^= kickState >> 17;
+        kickState ^= kickState << 5;
+        unsigned short& victim = table[(size_t)bucket * CUCKOO_BUCKET_SLOTS + kickState % CUCKOO_BUCKET_SLOTS];
+        unsigned short displaced = victim;
+        victim = fp;
+        fp = displaced;
+        bucket = altBucket(bucket, fp);
+        if (place(bucket, fp)) {
+            count++;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CuckooFilter::mayContain(int key) const {
+    unsigned b1;
+    unsigned short fp;
+    split(key, b1, fp);
+    return bucketHas(&table[(size_t)b1 * CUCKOO_BUCKET_SLOTS], fp) |
+           bucketHas(&table[(size_t)altBucket(b1, fp) * CUCKOO_BUCKET_SLOTS], fp);
+}
+
+bool CuckooFilter::remove(int key) {
+    unsigned b1;
+    unsigned short fp;
+    split(key, b1, fp);
+    unsigned buckets[2] = {b1, altBucket(b1, fp)};
+    for (unsigned bucket : buckets) {
+        unsigned short* slots = &table[(size_t)bucket * CUCKOO_BUCKET_SLOTS];
+        for (int i = 0; i < CUCKOO_BUCKET_SLOTS; i++) {
+            if (slots[i] == fp) {
+                slots[i] = 0;
+                count--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,652 @@
+#include "../include/DifferentialCheck.h"
+#include "../include/OrderPipeline.h"
+#include "../include/Colors.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+using namespace Colors;
+
+static const char* VERIFY_CATEGORIES[] = { "Electronics", "Groceries", "Apparel", "Toys" };
+static const int VERIFY_CATEGORY_COUNT = 4;
+static const char* VERIFY_WORDS[] = { "Widget", "Cable", "Lamp", "Kettle", "Drill", "Puzzle", "Jacket", "Blender" };
+static const int VERIFY_WORD_COUNT = 8;
+
+static const char* VERIFY_OP_NAMES[VERIFY_OP_KINDS] = {
+    "add", "remove", "stock", "price", "order", "process", "drain", "lookup", "filter",
+    "price range", "cheapest", "name", "ranking", "queue", "freeze", "heap policy"
+};
+
+// Per mille; orders dominate, as they do in service
+static const int VERIFY_OP_WEIGHTS[VERIFY_OP_KINDS] = {
+    90, 30, 60, 60, 250, 130, 40, 120, 30, 40, 20, 50, 50, 20, 4, 6
+};
+
+bool VerifyConfig::set(const string& key, const string& value) {
+    double v = atof(value.c_str());
+    if (key == "seed") seed = strtoull(value.c_str(), nullptr, 10);
+    else if (key == "ops") operations = (int)v;
+    else if (key == "ids") idRange = (int)v;
+    else if (key == "check") checkEvery = (int)v;
+    else if (key == "timed") timedOperations = (int)v;
+    else if (key == "repeats") repeats = (int)v;
+    else if (key == "tolerance") tolerance = v;
+    else if (key == "baseline") baselinePath = value;
+    else if (key == "record") recordPath = value;
+    else return false;
+    return true;
+}
+
+DifferentialCheck::DifferentialCheck(const VerifyConfig& cfg) : config(cfg), state(cfg.seed), operationIndex(0) {
+    for (int i = 0; i < VERIFY_OP_KINDS; i++) counts[i] = 0;
+    if (config.idRange < 1) config.idRange = 1;
+    if (config.checkEvery < 1) config.checkEvery = 1;
+    if (config.repeats < 1) config.repeats = 1;
+}
+
+unsigned long long DifferentialCheck::nextRandom() {
+    unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int DifferentialCheck::below(int n) {
+    return n > 0 ? (int)(nextRandom() % (unsigned long long)n) : 0;
+}
+
+// The ID is in the name, so a name search for "item<id>" must rank it first
+Product DifferentialCheck::randomProduct(int id) {
+    string name = "Item" + to_string(id) + " " + VERIFY_WORDS[below(VERIFY_WORD_COUNT)];
+    int sales = below(3) == 0 ? below(100) : 0;
+    return Product(id, name, VERIFY_CATEGORIES[below(VERIFY_CATEGORY_COUNT)], 1 + below(40), below(100000) / 100.0, sales);
+}
+
+void DifferentialCheck::note(const string& op) {
+    recent[operationIndex % VERIFY_RECENT_OPS] = to_string(operationIndex) + ": " + op;
+}
+
+bool DifferentialCheck::fail(const string& what) {
+    if (failure.empty()) failure = what;
+    return false;
+}
+
+static bool sameAsModel(const Product& a, const Product& b) {
+    return a.id == b.id && a.name == b.name && a.category == b.category && a.quantity == b.quantity
+        && a.price == b.price && a.salesCount == b.salesCount;
+}
+
+// processNextOrder on the model
+static bool modelProcessNext(ReferenceWarehouse& model) {
+    if (model.queue.empty()) return false;
+    Order o = model.queue.front();
+    model.queue.pop_front();
+    map<int, Product>::iterator it = model.products.find(o.productId);
+    if (it == model.products.end() || it->second.quantity < o.quantity) return false;
+    it->second.quantity -= o.quantity;
+    it->second.salesCount += o.quantity;
+    if (it->second.quantity == 0) model.products.erase(it);
+    return true;
+}
+
+bool DifferentialCheck::compareProduct(WarehouseSystem& warehouse, ReferenceWarehouse& model, int id) {
+    Product* p = warehouse.searchProduct(id);
+    map<int, Product>::iterator it = model.products.find(id);
+    if (it == model.products.end()) {
+        return p == nullptr || fail("product " + to_string(id) + " found, the model has none");
+    }
+    if (p == nullptr) return fail("product " + to_string(id) + " missing");
+    return sameAsModel(*p, it->second) || fail("product " + to_string(id) + " differs from the model");
+}
+
+// Every product by lookup, then every index against the store
+bool DifferentialCheck::compareAll(WarehouseSystem& warehouse, ReferenceWarehouse& model) {
+    if (warehouse.productCount() != (int)model.products.size()) {
+        return fail(to_string(warehouse.productCount()) + " products, the model has " + to_string(model.products.size()));
+    }
+    for (const pair<const int, Product>& entry : model.products) {
+        if (!compareProduct(warehouse, model, entry.first)) return false;
+    }
+    string problem;
+    return warehouse.checkConsistency(problem) || fail("inconsistent indexes: " + problem);
+}
+
+// Take up to limit orders through one of the batch paths; the model takes
+// them one by one
+bool DifferentialCheck::drain(WarehouseSystem& warehouse, ReferenceWarehouse& model, WorkStealingPool& pool, WavePlanner& waves,
+                              OrderPipeline* pipeline) {
+    static const char* paths[] = { " one by one", " on the pool", " as a wave", " through the pipeline" };
+    int limit = 1 + below(64);
+    int path = below(pipeline != nullptr ? 4 : 3);
+    note(string("drain ") + to_string(limit) + paths[path]);
+
+    // A stock change between plan and commit must make the commit refuse
+    if (path == 2) {
+        waves.plan(limit);
+        if (!model.queue.empty() && below(4) == 0) {
+            int id = model.queue.front().productId;
+            int qty = below(60);
+            map<int, Product>::iterator it = model.products.find(id);
+            if (it != model.products.end()) it->second.quantity = qty;
+            warehouse.updateStock(id, qty);
+            note(string("drain ") + to_string(limit) + paths[path] + ", stock " + to_string(id) + " = " + to_string(qty) + " after planning");
+        }
+    }
+
+    int expected = 0;
+    for (int i = 0; i < limit && !model.queue.empty(); i++) {
+        if (modelProcessNext(model)) expected++;
+    }
+
+    int fulfilled = 0;
+    if (path == 0) {
+        for (int i = 0; i < limit && warehouse.pendingOrderCount() > 0; i++) {
+            if (warehouse.processNextOrder()) fulfilled++;
+        }
+    } else if (path == 1) {
+        fulfilled = warehouse.processOrdersParallel(pool, limit);
+    } else if (path == 2) {
+        fulfilled = waves.commit();
+        if (fulfilled < 0) {
+            waves.plan(limit);
+            fulfilled = waves.commit();
+        }
+    } else {
+#ifdef WAREHOUSE_HAS_COROUTINES
+        fulfilled = pipeline->run(limit);
+#endif
+    }
+    if (fulfilled != expected) {
+        return fail("drain fulfilled " + to_string(fulfilled) + " orders, the model " + to_string(expected));
+    }
+    return true;
+}
+
+// Cheapest first, ties by ID: the price index order
+static bool byPriceThenId(const Product* a, const Product* b) {
+    return a->price < b->price || (a->price == b->price && a->id < b->id);
+}
+
+bool DifferentialCheck::step(WarehouseSystem& warehouse, ReferenceWarehouse& model, WorkStealingPool& pool, WavePlanner& waves,
+                             OrderPipeline* pipeline) {
+    int roll = below(1000);
+    int op = 0;
+    while (roll >= VERIFY_OP_WEIGHTS[op]) roll -= VERIFY_OP_WEIGHTS[op++];
+    counts[op]++;
+    int id = 1 + below(config.idRange);
+    map<int, Product>::iterator it = model.products.find(id);
+    bool known = it != model.products.end();
+
+    switch (op) {
+    case VERIFY_ADD: {
+        Product p = randomProduct(id);
+        note("add " + to_string(id) + " qty " + to_string(p.quantity) + " sales " + to_string(p.salesCount));
+        model.products[id] = p;
+        warehouse.addProduct(p);
+        return compareProduct(warehouse, model, id);
+    }
+    case VERIFY_REMOVE:
+        note("remove " + to_string(id));
+        if (known) model.products.erase(it);
+        warehouse.removeProduct(id);
+        return compareProduct(warehouse, model, id);
+    case VERIFY_STOCK: {
+        int qty = below(10) == 0 ? 0 : below(60);
+        note("stock " + to_string(id) + " = " + to_string(qty));
+        if (known) it->second.quantity = qty;
+        warehouse.updateStock(id, qty);
+        return compareProduct(warehouse, model, id);
+    }
+    case VERIFY_PRICE: {
+        double price = below(100000) / 100.0;
+        note("price " + to_string(id) + " = " + to_string(price));
+        if (known) it->second.price = price;
+        if (warehouse.updatePrice(id, price) != known) return fail("updatePrice answered for the wrong products");
+        return compareProduct(warehouse, model, id);
+    }
+    case VERIFY_ORDER: {
+        int qty = below(50) == 0 ? 0 : 1 + below(8);
+        bool urgent = below(10) == 0;
+        note("order " + to_string(id) + " qty " + to_string(qty) + (urgent ? " urgent" : ""));
+        int expected = 0;
+        if (known && it->second.quantity >= qty) {
+            expected = model.nextOrderId++;
+            Order o(expected, id, qty, urgent);
+            if (urgent) model.queue.push_front(o);
+            else model.queue.push_back(o);
+        }
+        int placed = warehouse.placeOrder(id, qty, urgent);
+        if (placed != expected) return fail("placeOrder returned " + to_string(placed) + ", the model " + to_string(expected));
+        return true;
+    }
+    case VERIFY_PROCESS: {
+        note("process");
+        bool expected = modelProcessNext(model);
+        if (warehouse.processNextOrder() != expected) return fail("processNextOrder disagrees with the model");
+        return true;
+    }
+    case VERIFY_DRAIN:
+        return drain(warehouse, model, pool, waves, pipeline);
+    case VERIFY_LOOKUP:
+        note("lookup " + to_string(id));
+        return compareProduct(warehouse, model, id);
+    case VERIFY_FILTER: {
+        ProductFilter filter;
+        if (below(5) != 0) filter.category = VERIFY_CATEGORIES[below(VERIFY_CATEGORY_COUNT)];
+        filter.minQuantity = below(20);
+        filter.maxQuantity = filter.minQuantity + below(30);
+        if (below(2) == 0) {
+            filter.minPrice = below(50000) / 100.0;
+            filter.maxPrice = filter.minPrice + below(50000) / 100.0;
+        }
+        note("filter " + filter.category + " qty " + to_string(filter.minQuantity) + ".." + to_string(filter.maxQuantity));
+        vector<Product> got = warehouse.filterProducts(filter);
+        size_t matched = 0;
+        for (const pair<const int, Product>& entry : model.products) {
+            const Product& p = entry.second;
+            if (!filter.category.empty() && p.category != filter.category) continue;
+            if (p.quantity < filter.minQuantity || p.quantity > filter.maxQuantity) continue;
+            if (p.price < filter.minPrice || p.price > filter.maxPrice) continue;
+            if (matched >= got.size() || !sameAsModel(got[matched], p)) return fail("filterProducts disagrees with the model");
+            matched++;
+        }
+        return matched == got.size() || fail("filterProducts returned extra products");
+    }
+    case VERIFY_PRICE_RANGE: {
+        double lo = below(100000) / 100.0;
+        double hi = lo + below(20000) / 100.0;
+        int limit = below(3) == 0 ? 0 : 1 + below(20);
+        note("price range " + to_string(lo) + ".." + to_string(hi) + " limit " + to_string(limit));
+        vector<const Product*> expected;
+        for (const pair<const int, Product>& entry : model.products) {
+            if (entry.second.price >= lo && entry.second.price <= hi) expected.push_back(&entry.second);
+        }
+        sort(expected.begin(), expected.end(), byPriceThenId);
+        if (limit > 0 && (int)expected.size() > limit) expected.resize(limit);
+        vector<Product> got = warehouse.productsInPriceRange(lo, hi, limit);
+        if (got.size() != expected.size()) return fail("productsInPriceRange returned the wrong number of products");
+        for (size_t i = 0; i < got.size(); i++) {
+            if (!sameAsModel(got[i], *expected[i])) return fail("productsInPriceRange disagrees with the model");
+        }
+        return true;
+    }
+    case VERIFY_CHEAPEST: {
+        int n = 1 + below(20);
+        note("cheapest " + to_string(n));
+        vector<const Product*> expected;
+        for (const pair<const int, Product>& entry : model.products) {
+            if (entry.second.quantity > 0) expected.push_back(&entry.second);
+        }
+        int keep = min(n, (int)expected.size());
+        partial_sort(expected.begin(), expected.begin() + keep, expected.end(), byPriceThenId);
+        vector<Product> got = warehouse.cheapestInStock(n);
+        if ((int)got.size() != keep) return fail("cheapestInStock returned the wrong number of products");
+        for (int i = 0; i < keep; i++) {
+            if (!sameAsModel(got[i], *expected[i])) return fail("cheapestInStock disagrees with the model");
+        }
+        return true;
+    }
+    case VERIFY_NAME: {
+        note("name item" + to_string(id));
+        vector<NameMatch> got = warehouse.searchByName("item" + to_string(id), 5);
+        bool first = !got.empty() && got[0].productId == id;
+        bool anywhere = false;
+        for (const NameMatch& m : got) anywhere = anywhere || m.productId == id;
+        if (known && !first) return fail("name search does not rank product " + to_string(id) + " first");
+        if (!known && anywhere) return fail("name search finds removed product " + to_string(id));
+        return true;
+    }
+    case VERIFY_RANKING: {
+        note("ranking");
+        SalesEntry lowest, best;
+        bool hasLowest = warehouse.lowestSelling(lowest);
+        bool hasBest = warehouse.bestSelling(best);
+        if (hasLowest != !model.products.empty() || hasBest != !model.products.empty()) {
+            return fail("rankings disagree with the model on emptiness");
+        }
+        if (model.products.empty()) return true;
+        // Ties may resolve to any product with the extreme sales count
+        int minSales = model.products.begin()->second.salesCount;
+        int maxSales = minSales;
+        for (const pair<const int, Product>& entry : model.products) {
+            minSales = min(minSales, entry.second.salesCount);
+            maxSales = max(maxSales, entry.second.salesCount);
+        }
+        map<int, Product>::iterator low = model.products.find(lowest.productId);
+        map<int, Product>::iterator high = model.products.find(best.productId);
+        if (lowest.salesCount != minSales || low == model.products.end() || low->second.salesCount != minSales) {
+            return fail("lowestSelling disagrees with the model");
+        }
+        if (best.salesCount != maxSales || high == model.products.end() || high->second.salesCount != maxSales) {
+            return fail("bestSelling disagrees with the model");
+        }
+        return true;
+    }
+    case VERIFY_QUEUE: {
+        note("queue");
+        CatalogSnapshot snap = warehouse.takeSnapshot();
+        if (snap.pendingOrders.size() != model.queue.size()) return fail("queue length differs from the model");
+        for (size_t i = 0; i < model.queue.size(); i++) {
+            const Order& a = snap.pendingOrders[i];
+            const Order& b = model.queue[i];
+            if (a.orderId != b.orderId || a.productId != b.productId || a.quantity != b.quantity || a.urgent != b.urgent) {
+                return fail("queued order " + to_string(i) + " differs from the model");
+            }
+        }
+        return true;
+    }
+    case VERIFY_FREEZE:
+        note("freeze");
+        warehouse.freezeCatalog();
+        return true;
+    default: {
+        HeapPolicy policy = below(2) == 0 ? HEAP_HARD_DELETE : HEAP_TOMBSTONES;
+        note(policy == HEAP_HARD_DELETE ? "heaps hard delete" : "heaps tombstones");
+        warehouse.setHeapPolicy(policy);
+        if (below(4) == 0) warehouse.compactHeaps();
+        return true;
+    }
+    }
+}
+
+// Multi-word name queries where one word is in tens of thousands of names:
+// the exact match must win whatever order the names were added in
+static bool nameRanksFirst(NameIndex& index, const string& query, int id, int words) {
+    vector<NameMatch> got = index.search(query, 5);
+    return !got.empty() && got[0].productId == id && got[0].wordsMatched == words;
+}
+
+bool DifferentialCheck::checkNameScenarios() {
+    const int common = 25000;
+    NameIndex later, first, rare;
+    for (int i = 1; i <= common; i++) {
+        later.add(i, "steel bolt" + to_string(i));
+        first.add(i + 1, "steel bolt" + to_string(i));
+    }
+    for (int i = 1; i <= common; i++) {
+        later.add(common + i, "nail" + to_string(i) + " hammer");
+        first.add(common + i + 1, "nail" + to_string(i) + " hammer");
+    }
+    later.add(2 * common + 1, "steel hammer");
+    first.add(1, "steel hammer");
+    if (!nameRanksFirst(later, "steel hammer", 2 * common + 1, 2) || !nameRanksFirst(later, "hammer steel", 2 * common + 1, 2)) {
+        return fail("name search misses \"steel hammer\" added after the common words");
+    }
+    if (!nameRanksFirst(first, "steel hammer", 1, 2)) return fail("name search misses \"steel hammer\" added first");
+
+    // A rare word with a common one: the common word is only probed, and the
+    // two-word matches come first, then the lowest IDs of the common word
+    for (int i = 1; i <= 2 * common; i++) rare.add(i, "widget " + to_string(i));
+    for (int i = 1; i <= 3; i++) rare.add(2 * common + i, "zebra widget");
+    vector<NameMatch> got = rare.search("zebra widget", 5);
+    bool ok = got.size() == 5;
+    for (int i = 0; i < 5 && ok; i++) {
+        int id = i < 3 ? 2 * common + 1 + i : i - 2;
+        ok = got[i].productId == id && got[i].wordsMatched == (i < 3 ? 2 : 1);
+    }
+    if (!ok) return fail("name search ranks \"zebra widget\" wrongly");
+    if ((int)rare.search("zebra widget", 0).size() != 2 * common + 3) return fail("name search without a limit misses products");
+
+    // Removed products must not hide live ones: a dead exact term would stop
+    // the typo fallback, dead completions would fill the prefix expansion
+    NameIndex removed;
+    removed.add(1, "Hammer");
+    removed.add(2, "Hamper");
+    removed.remove(1, "Hammer");
+    if (!nameRanksFirst(removed, "hammer", 2, 1)) return fail("name search misses \"Hamper\" once \"Hammer\" is removed");
+    for (int i = 1; i <= NAME_MAX_PREFIX_TERMS; i++) removed.add(10 + i, "ab" + to_string(i) + " ab" + to_string(i));
+    removed.add(10 + NAME_MAX_PREFIX_TERMS + 1, "abzzzzzz");
+    for (int i = 1; i <= NAME_MAX_PREFIX_TERMS; i++) removed.remove(10 + i, "ab" + to_string(i) + " ab" + to_string(i));
+    if (!nameRanksFirst(removed, "ab", 10 + NAME_MAX_PREFIX_TERMS + 1, 1)) {
+        return fail("name search misses \"abzzzzzz\" behind removed completions");
+    }
+    return true;
+}
+
+int DifferentialCheck::runDifferential() {
+    WarehouseSystem warehouse(16, 16, 16);
+    warehouse.setVerbose(false);
+    ReferenceWarehouse model;
+    WorkStealingPool pool(2);
+    WavePlanner waves(warehouse);
+    OrderPipeline* pipeline = nullptr;
+#ifdef WAREHOUSE_HAS_COROUTINES
+    OrderPipeline stagedPipeline(warehouse, 8);
+    pipeline = &stagedPipeline;
+#endif
+
+    cout << Theme::HEADER << "Differential run: " << config.operations << " operations, seed " << config.seed
+         << ", IDs 1.." << config.idRange << RESET << endl;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (!checkNameScenarios()) {
+        cout << Theme::ERR << "Fixed name search case failed: " << failure << RESET << endl;
+        return 1;
+    }
+    int checks = 0;
+    bool agree = true;
+    for (operationIndex = 0; operationIndex < config.operations && agree; operationIndex++) {
+        agree = step(warehouse, model, pool, waves, pipeline);
+        if (agree && warehouse.pendingOrderCount() != (int)model.queue.size()) {
+            agree = fail("queue length differs from the model");
+        }
+        if (agree && (operationIndex + 1) % config.checkEvery == 0) {
+            agree = compareAll(warehouse, model);
+            checks++;
+        }
+    }
+    if (agree) {
+        agree = compareAll(warehouse, model);
+        checks++;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (!agree) {
+        cout << Theme::ERR << "Mismatch after operation " << operationIndex - 1 << ": " << failure << RESET << endl;
+        cout << Theme::INFO << "Last operations (rerun with seed=" << config.seed << " ops=" << operationIndex << "):" << RESET << endl;
+        for (long long i = max(0LL, operationIndex - VERIFY_RECENT_OPS); i < operationIndex; i++) {
+            cout << "  " << recent[i % VERIFY_RECENT_OPS] << endl;
+        }
+        return 1;
+    }
+
+    for (int op = 0; op < VERIFY_OP_KINDS; op++) {
+        printf("  %-12s %9lld\n", VERIFY_OP_NAMES[op], counts[op]);
+    }
+    cout << Theme::SUCCESS << "All answers agree with the model; " << checks << " full consistency checks passed ("
+         << model.products.size() << " products left, " << seconds << " s)." << RESET << endl;
+    return 0;
+}
+
+// Throughput of each kind of operation on a warehouse of timedOperations
+// products, no model and no checks; the fastest of `repeats` runs counts
+vector<PhaseTiming> DifferentialCheck::runTimed() {
+    int n = config.timedOperations;
+    int scans = max(10, n / 1000);
+    int queries = max(100, n / 10);
+    const char* names[] = { "add", "lookup", "reprice", "order", "filter", "price range", "name search", "remove" };
+    long long ops[] = { n, n, n, n, scans, queries, queries, n };
+    const int phaseCount = 8;
+
+    vector<PhaseTiming> phases;
+    for (int i = 0; i < phaseCount; i++) {
+        PhaseTiming t;
+        t.name = names[i];
+        t.operations = ops[i];
+        t.seconds = 0;
+        phases.push_back(t);
+    }
+
+    vector<Product> catalog;
+    catalog.reserve(n);
+    for (int id = 1; id <= n; id++) {
+        Product p = randomProduct(id);
+        p.quantity = 1000000;
+        catalog.push_back(p);
+    }
+
+    for (int r = 0; r < config.repeats; r++) {
+        WarehouseSystem warehouse(n, n, 16);
+        warehouse.setVerbose(false);
+        double seconds[phaseCount];
+        chrono::steady_clock::time_point start;
+
+        start = chrono::steady_clock::now();
+        for (const Product& p : catalog) warehouse.addProduct(p);
+        seconds[0] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) warehouse.searchProduct(1 + below(2 * n));
+        seconds[1] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) warehouse.updatePrice(1 + below(n), below(100000) / 100.0);
+        seconds[2] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) {
+            warehouse.placeOrder(1 + below(n), 1 + below(5));
+            warehouse.processNextOrder();
+        }
+        seconds[3] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < scans; i++) {
+            ProductFilter filter;
+            filter.category = VERIFY_CATEGORIES[i % VERIFY_CATEGORY_COUNT];
+            filter.minPrice = below(90000) / 100.0;
+            filter.maxPrice = filter.minPrice + 10.0;
+            warehouse.filterProducts(filter);
+        }
+        seconds[4] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < queries; i++) {
+            double lo = below(100000) / 100.0;
+            warehouse.productsInPriceRange(lo, lo + 50.0, 100);
+        }
+        seconds[5] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < queries; i++) {
+            warehouse.searchByName("item" + to_string(1 + below(n)), 10);
+        }
+        seconds[6] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        for (const Product& p : catalog) warehouse.removeProduct(p.id);
+        seconds[7] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        for (int i = 0; i < phaseCount; i++) {
+            if (r == 0 || seconds[i] < phases[i].seconds) phases[i].seconds = seconds[i];
+        }
+    }
+    return phases;
+}
+
+// Baseline file: "<phase> <ns per op>" per line, # starts a comment; phase
+// names may contain spaces, the number is the last field
+static map<string, double> readBaseline(const string& path, bool& ok, int& timedOperations) {
+    map<string, double> baseline;
+    ifstream in(path.c_str());
+    ok = (bool)in;
+    timedOperations = 0;
+    string line;
+    while (getline(in, line)) {
+        size_t timed = line.find("timed=");
+        if (!line.empty() && line[0] == '#' && timed != string::npos) timedOperations = atoi(line.c_str() + timed + 6);
+        if (line.empty() || line[0] == '#') continue;
+        size_t space = line.find_last_of(' ');
+        if (space == string::npos) continue;
+        baseline[line.substr(0, space)] = atof(line.c_str() + space + 1);
+    }
+    return baseline;
+}
+
+static bool writeBaseline(const string& path, const vector<PhaseTiming>& phases, int timedOperations) {
+    ofstream out(path.c_str());
+    out << "# warehouse verify baseline, timed=" << timedOperations << ": <phase> <ns per op>\n";
+    for (const PhaseTiming& t : phases) {
+        out << t.name << " " << t.seconds * 1e9 / (double)t.operations << "\n";
+    }
+    return (bool)out;
+}
+
+// Table of this run against the baseline; non-zero if a phase is slower than
+// the tolerance allows, or if the baseline asked for cannot judge this run
+// (unreadable, recorded with another timed=, or missing a phase)
+int DifferentialCheck::compareBaseline(const vector<PhaseTiming>& phases) {
+    bool haveBaseline = false;
+    bool unusable = false;
+    map<string, double> baseline;
+    if (!config.baselinePath.empty()) {
+        int baselineSize = 0;
+        baseline = readBaseline(config.baselinePath, haveBaseline, baselineSize);
+        if (!haveBaseline) {
+            cout << Theme::ERR << "Cannot read the baseline " << config.baselinePath << "." << RESET << endl;
+            unusable = true;
+        } else if (baselineSize != config.timedOperations) {
+            cout << Theme::ERR << "Baseline was recorded with timed=" << baselineSize << ", this run uses timed="
+                 << config.timedOperations << "." << RESET << endl;
+            unusable = true;
+        }
+    }
+
+    int regressions = 0;
+    int unmatched = 0;
+    long long totalOps = 0;
+    double totalSeconds = 0;
+    for (const PhaseTiming& t : phases) {
+        double ns = t.seconds * 1e9 / (double)t.operations;
+        totalOps += t.operations;
+        totalSeconds += t.seconds;
+        printf("  %-12s %9lld ops %12.1f ns/op %14.0f ops/s", t.name.c_str(), t.operations, ns, (double)t.operations / t.seconds);
+        map<string, double>::iterator it = baseline.find(t.name);
+        if (it != baseline.end() && it->second > 0) {
+            double ratio = ns / it->second;
+            bool regressed = ratio > 1.0 + config.tolerance;
+            if (regressed) regressions++;
+            printf("   baseline %10.1f  x%.2f%s", it->second, ratio, regressed ? "  REGRESSED" : "");
+        } else if (haveBaseline) {
+            unmatched++;
+            printf("   NOT IN BASELINE");
+        }
+        printf("\n");
+    }
+    printf("  %-12s %9lld ops %12.1f ns/op %14.0f ops/s\n", "all", totalOps, totalSeconds * 1e9 / (double)totalOps,
+           (double)totalOps / totalSeconds);
+
+    if (!config.recordPath.empty()) {
+        if (writeBaseline(config.recordPath, phases, config.timedOperations)) {
+            cout << Theme::SUCCESS << "Baseline written to " << config.recordPath << RESET << endl;
+        } else {
+            cout << Theme::ERR << "Could not write " << config.recordPath << RESET << endl;
+            return 1;
+        }
+    }
+    if (unmatched > 0) {
+        cout << Theme::ERR << unmatched << " phase(s) missing from the baseline, record it again." << RESET << endl;
+        unusable = true;
+    }
+    if (regressions > 0) {
+        cout << Theme::ERR << regressions << " phase(s) slower than the baseline by more than "
+             << (int)(config.tolerance * 100) << "%." << RESET << endl;
+        return 1;
+    }
+    if (unusable) return 1;
+    if (haveBaseline) {
+        cout << Theme::SUCCESS << "Within " << (int)(config.tolerance * 100) << "% of the baseline." << RESET << endl;
+    }
+    return 0;
+}
+
+int DifferentialCheck::run() {
+    int status = runDifferential();
+    if (status != 0 || config.timedOperations <= 0) return status;
+
+    cout << Theme::HEADER << "Timed run: " << config.timedOperations << " products, fastest of "
+         << config.repeats << RESET << endl;
+    state = config.seed;
+    return compareBaseline(runTimed());
+}
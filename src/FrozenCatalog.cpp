@@ -0,0 +1,142 @@
+#include "../include/FrozenCatalog.h"
+#include <algorithm>
+
+#define FROZEN_MAX_SEED (1 << 22)   // Seeds tried per bucket before the build restarts with a new salt
+
+// splitmix64 finalizer over the key and a 32-bit seed
+static inline unsigned long long frozenHash(int key, unsigned seed) {
+    unsigned long long x = (unsigned long long)(unsigned)key | ((unsigned long long)seed << 32);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Map the high 32 bits onto [0, n) without a division
+static inline int frozenReduce(unsigned long long h, int n) {
+    return (int)(((h >> 32) * (unsigned long long)n) >> 32);
+}
+
+static inline int frozenSlot(int key, int seed, unsigned salt, int n) {
+    return frozenReduce(frozenHash(key, (unsigned)seed * 0x9e3779b9u ^ salt), n);
+}
+
+FrozenCatalog::FrozenCatalog() : salt(0x2545f491u), liveCount(0) {}
+
+int FrozenCatalog::bucketOf(int key) const {
+    return frozenReduce(frozenHash(key, salt), (int)seeds.size());
+}
+
+void FrozenCatalog::build(vector<Product>& products) {
+    salt = 0x2545f491u;
+    while (!tryBuild(products)) salt = salt * 2654435761u + 1;
+}
+
+// Place buckets largest first, each with the first seed that lands all of its
+// keys on free, distinct slots; single-key buckets take the remaining slots directly
+bool FrozenCatalog::tryBuild(vector<Product>& products) {
+    int n = (int)products.size();
+    seeds.assign(max(1, (n + FROZEN_BUCKET_KEYS - 1) / FROZEN_BUCKET_KEYS), 0);
+    int bucketTotal = (int)seeds.size();
+
+    // Keys grouped by bucket (counting sort)
+    vector<int> start(bucketTotal + 1, 0);
+    for (const Product& p : products) start[bucketOf(p.id) + 1]++;
+    for (int b = 0; b < bucketTotal; b++) start[b + 1] += start[b];
+    vector<int> members(n);
+    vector<int> fill(start.begin(), start.end() - 1);
+    for (int i = 0; i < n; i++) members[fill[bucketOf(products[i].id)]++] = i;
+
+    vector<int> order(bucketTotal);
+    for (int b = 0; b < bucketTotal; b++) order[b] = b;
+    stable_sort(order.begin(), order.end(), [&start](int a, int b) {
+        return start[a + 1] - start[a] > start[b + 1] - start[b];
+    });
+
+    vector<char> taken(n, 0);
+    vector<int> slotOfKey(n, -1);
+    vector<int> candidate;
+    int nextFree = 0;
+    for (int b : order) {
+        int count = start[b + 1] - start[b];
+        if (count == 0) break;
+        if (count == 1) {
+            while (taken[nextFree]) nextFree++;
+            taken[nextFree] = 1;
+            slotOfKey[members[start[b]]] = nextFree;
+            seeds[b] = -(nextFree + 1);
+            continue;
+        }
+
+        int seed = 1;
+        for (; seed < FROZEN_MAX_SEED; seed++) {
+            candidate.clear();
+            bool fits = true;
+            for (int k = start[b]; k < start[b + 1] && fits; k++) {
+                int slot = frozenSlot(products[members[k]].id, seed, salt, n);
+                if (taken[slot] || find(candidate.begin(), candidate.end(), slot) != candidate.end()) fits = false;
+                candidate.push_back(slot);
+            }
+            if (fits) break;
+        }
+        if (seed == FROZEN_MAX_SEED) return false;
+        seeds[b] = seed;
+        for (int k = 0; k < count; k++) {
+            taken[candidate[k]] = 1;
+            slotOfKey[members[start[b] + k]] = candidate[k];
+        }
+    }
+
+    slots.assign(n, Product());
+    keys.assign(n, 0);
+    for (int i = 0; i < n; i++) {
+        keys[slotOfKey[i]] = products[i].id;
+        slots[slotOfKey[i]] = std::move(products[i]);
+    }
+    live.assign(n, 1);
+    liveCount = n;
+    return true;
+}
+
+int FrozenCatalog::slotOf(int productId) const {
+    if (slots.empty()) return -1;
+    int seed = seeds[bucketOf(productId)];
+    if (seed == 0) return -1;
+    int slot = (seed < 0) ? -seed - 1 : frozenSlot(productId, seed, salt, (int)slots.size());
+    return keys[slot] == productId ? slot : -1;
+}
+
+// Written as early returns rather than one conditional expression: the
+// compiler then emits predicted branches instead of a conditional move, and
+// the caller's loads need not wait for the slot's ID to arrive
+Product* FrozenCatalog::get(int productId) {
+    if (slots.empty()) return nullptr;
+    int seed = seeds[bucketOf(productId)];
+    if (seed == 0) return nullptr;
+    int slot = (seed < 0) ? -seed - 1 : frozenSlot(productId, seed, salt, (int)slots.size());
+    if (keys[slot] != productId) return nullptr;
+    if (!live[slot]) return nullptr;
+    return &slots[slot];
+}
+
+bool FrozenCatalog::put(Product&& product) {
+    int slot = slotOf(product.id);
+    if (slot < 0) return false;
+    slots[slot] = std::move(product);
+    if (!live[slot]) {
+        live[slot] = 1;
+        liveCount++;
+    }
+    return true;
+}
+
+bool FrozenCatalog::remove(int productId) {
+    int slot = slotOf(productId);
+    if (slot < 0 || !live[slot]) return false;
+    slots[slot] = Product();    // Release the strings; keys[] still maps the ID here
+    live[slot] = 0;
+    liveCount--;
+    return true;
+}
@@ -5,6 +5,10 @@
 HashMap::HashMap(int initialCapacity) {
     capacity = initialCapacity;
     size = 0;
+    oldBuckets = nullptr;
+    oldCapacity = 0;
+    migrated = 0;
+    incremental = true;
     buckets = new HashNode*[capacity];
     
     // Initialize all buckets to nullptr
@@ -13,17 +17,10 @@ HashMap::HashMap(int initialCapacity) {
     }
 }
 
-//  Free all memory
+//  Free all memory (nodes are released in bulk by nodePool)
 HashMap::~HashMap() {
-    for (int i = 0; i < capacity; i++) {
-        HashNode* current = buckets[i];
-        while (current != nullptr) {
-            HashNode* temp = current;
-            current = current->next;
-            delete temp;
-        }
-    }
     delete[] buckets;
+    delete[] oldBuckets;
 }
 
 // Hash function which is a simple modulo hash for product IDs
@@ -31,37 +28,53 @@ int HashMap::hashFunction(int key) {
     return abs(key) % capacity;
 }
 
+// Keys of old buckets that have not moved yet stay in the old array
+HashNode*& HashMap::chainOf(int key) {
+    if (oldBuckets != nullptr) {
+        int oldIndex = abs(key) % oldCapacity;
+        if (oldIndex >= migrated) return oldBuckets[oldIndex];
+    }
+    return buckets[hashFunction(key)];
+}
+
 // Insert or update a product
-void HashMap::insert(Product product) {
-    int index = hashFunction(product.id);
-    HashNode* current = buckets[index];
+void HashMap::insert(const Product& product) {
+    Product copy = product;
+    insert(std::move(copy));
+}
+
+// Insert or update a product, taking ownership of its data
+void HashMap::insert(Product&& product) {
+    if (oldBuckets != nullptr) migrate(HASHMAP_MIGRATE_STEP);
+    HashNode*& head = chainOf(product.id);
+    HashNode* current = head;
 
     // Check if product already exists in this bucket
     while (current != nullptr) {
         if (current->key == product.id) {
             // Update existing product
-            current->value = product;
+            current->value = std::move(product);
             return;
         }
         current = current->next;
     }
 
     // Product doesn't exist, insert new node at the beginning of the chain
-    HashNode* newNode = new HashNode(product.id, product);
-    newNode->next = buckets[index];
-    buckets[index] = newNode;
+    HashNode* newNode = nodePool.create(product.id, std::move(product));
+    newNode->next = head;
+    head = newNode;
     size++;
 
-    // Resize if load factor exceeds 0.75 
-    if ((double)size / capacity > 0.75) {
+    // Resize if load factor exceeds 0.75 (a resize in progress finishes
+    // long before that: it moves four old buckets per insert)
+    if (oldBuckets == nullptr && (double)size / capacity > 0.75) {
         resize();
     }
 }
 
 // Get a product by ID
 Product* HashMap::get(int productId) {
-    int index = hashFunction(productId);
-    HashNode* current = buckets[index];
+    HashNode* current = chainOf(productId);
 
     while (current != nullptr) {
         if (current->key == productId) {
@@ -75,8 +88,9 @@ Product* HashMap::get(int productId) {
 
 // Remove a product by ID
 void HashMap::remove(int productId) {
-    int index = hashFunction(productId);
-    HashNode* current = buckets[index];
+    if (oldBuckets != nullptr) migrate(HASHMAP_MIGRATE_STEP);
+    HashNode*& head = chainOf(productId);
+    HashNode* current = head;
     HashNode* prev = nullptr;
 
     // Traverse the chain to find the product
@@ -85,12 +99,12 @@ void HashMap::remove(int productId) {
             // Found the product, remove it
             if (prev == nullptr) {
                 // Product is at the head of the chain
-                buckets[index] = current->next;
+                head = current->next;
             } else {
                 // Product is in the middle or end
                 prev->next = current->next;
             }
-            delete current;
+            nodePool.destroy(current);
             size--;
             return;
         }
@@ -114,37 +128,57 @@ bool HashMap::isEmpty() {
     return size == 0;
 }
 
-// Resize the hash table to maintain O(1) average performance
-void HashMap::resize() {
-    int oldCapacity = capacity;
-    capacity *= 2; // Double the capacity
-    
-    // Create new bucket array
-    HashNode** newBuckets = new HashNode*[capacity];
+// Remove all products (nodes are released in bulk by nodePool)
+void HashMap::clear() {
+    nodePool.clear();
+    delete[] oldBuckets;
+    oldBuckets = nullptr;
     for (int i = 0; i < capacity; i++) {
-        newBuckets[i] = nullptr;
+        buckets[i] = nullptr;
     }
+    size = 0;
+}
+
+void HashMap::setIncrementalResize(bool on) {
+    incremental = on;
+    if (!on && oldBuckets != nullptr) migrate(oldCapacity);
+}
+
+// Double the bucket array to maintain O(1) average performance. The new array
+// is left uninitialized: each of its buckets is set when its old bucket moves
+void HashMap::resize() {
+    oldBuckets = buckets;
+    oldCapacity = capacity;
+    migrated = 0;
+    capacity *= 2;
+    buckets = new HashNode*[capacity];
+    if (!incremental) migrate(oldCapacity);
+}
 
-    // Rehash all existing elements
-    for (int i = 0; i < oldCapacity; i++) {
-        HashNode* current = buckets[i];
+// Rehash old buckets into the new array, n at a time
+void HashMap::migrate(int n) {
+    int end = min(oldCapacity, migrated + n);
+    for (; migrated < end; migrated++) {
+        buckets[migrated] = nullptr;
+        buckets[migrated + oldCapacity] = nullptr;
+        HashNode* current = oldBuckets[migrated];
         while (current != nullptr) {
             HashNode* next = current->next;
-            
+
             // Calculate new index for this key
             int newIndex = hashFunction(current->key);
-            
+
             // Insert into new bucket
-            current->next = newBuckets[newIndex];
-            newBuckets[newIndex] = current;
-            
+            current->next = buckets[newIndex];
+            buckets[newIndex] = current;
+
             current = next;
         }
     }
-
-    // Delete old bucket array and update pointer
-    delete[] buckets;
-    buckets = newBuckets;
+    if (migrated == oldCapacity) {
+        delete[] oldBuckets;
+        oldBuckets = nullptr;
+    }
 }
 
 // Display all products in the hash map
@@ -155,15 +189,46 @@ void HashMap::display() {
     }
 
     cout << "Products in HashMap (Total: " << size << "):" << endl;
-    for (int i = 0; i < capacity; i++) {
-        HashNode* current = buckets[i];
-        while (current != nullptr) {
-            Product p = current->value;
-            cout << "ID: " << p.id << ", Name: " << p.name 
-                 << ", Category: " << p.category 
-                 << ", Quantity: " << p.quantity 
-                 << ", Price: $" << p.price << endl;
-            current = current->next;
+    forEach([](Product& p) {
+        cout << "ID: " << p.id << ", Name: " << p.name 
+             << ", Category: " << p.category 
+             << ", Quantity: " << p.quantity 
+             << ", Price: $" << p.price << endl;
+    });
+}
+
+bool HashMap::checkInvariants(string& problem) {
+    int count = 0;
+    bool placed = true;
+    int misplaced = 0;
+    auto walk = [this, &count, &placed, &misplaced](HashNode*& head) {
+        for (HashNode* current = head; current != nullptr; current = current->next) {
+            count++;
+            if (placed && &chainOf(current->key) != &head) {
+                placed = false;
+                misplaced = current->key;
+            }
         }
+    };
+    if (oldBuckets == nullptr) {
+        for (int i = 0; i < capacity; i++) walk(buckets[i]);
+    } else {
+        for (int i = 0; i < oldCapacity; i++) {
+            if (i < migrated) {
+                walk(buckets[i]);
+                walk(buckets[i + oldCapacity]);
+            } else {
+                walk(oldBuckets[i]);
+            }
+        }
+    }
+    if (!placed) {
+        problem = "product " + to_string(misplaced) + " is in the wrong bucket";
+        return false;
+    }
+    if (count != size) {
+        problem = to_string(count) + " nodes, size says " + to_string(size);
+        return false;
     }
+    return true;
 }
@@ -0,0 +1,238 @@
+#include "../include/LoadSimulator.h"
+#include "../include/Colors.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+
+using namespace Colors;
+
+static const char* SIM_CATEGORIES[] = {
+    "Electronics", "Groceries", "Apparel", "Home & Kitchen", "Toys", "Sports",
+    "Beauty", "Automotive", "Books", "Office Supplies", "Garden", "Pet Supplies"
+};
+static const int SIM_CATEGORY_COUNT = 12;
+static const int SIM_FIRST_ID = 100000;
+
+// Typical unit price per category, individual prices vary around it
+static const double SIM_BASE_PRICE[] = { 180.0, 4.5, 35.0, 25.0, 20.0, 40.0, 15.0, 60.0, 12.0, 8.0, 22.0, 18.0 };
+
+bool SimulationConfig::set(const string& key, const string& value) {
+    double v = atof(value.c_str());
+    if (key == "seed") seed = strtoull(value.c_str(), nullptr, 10);
+    else if (key == "skus") skuCount = (int)v;
+    else if (key == "zipf") zipfExponent = v;
+    else if (key == "rate") orderRate = v;
+    else if (key == "service") serviceRate = v;
+    else if (key == "restock") restockRate = v;
+    else if (key == "urgent") urgentRatio = v;
+    else if (key == "duration") duration = v;
+    else if (key == "qty") maxOrderQty = (int)v;
+    else if (key == "samples") samples = (int)v;
+    else return false;
+    return true;
+}
+
+LoadSimulator::LoadSimulator(const SimulationConfig& cfg) : config(cfg), state(cfg.seed) {}
+
+unsigned long long LoadSimulator::nextRandom() {
+    unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+double LoadSimulator::uniform() {
+    return (double)(nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double LoadSimulator::exponential(double rate) {
+    return -log(1.0 - uniform()) / rate;
+}
+
+int LoadSimulator::pickProduct() {
+    double u = uniform();
+    int rank = (int)(lower_bound(popularityCdf.begin(), popularityCdf.end(), u) - popularityCdf.begin());
+    if (rank >= (int)idOfRank.size()) rank = (int)idOfRank.size() - 1;
+    return idOfRank[rank];
+}
+
+// Build the catalog and the popularity model; popular items get deeper stock
+void LoadSimulator::generateCatalog(WarehouseSystem& warehouse) {
+    int n = config.skuCount;
+
+    popularityCdf.resize(n);
+    double total = 0;
+    for (int r = 0; r < n; r++) {
+        total += 1.0 / pow((double)(r + 1), config.zipfExponent);
+        popularityCdf[r] = total;
+    }
+    for (int r = 0; r < n; r++) popularityCdf[r] /= total;
+
+    // Product IDs are not in popularity order
+    idOfRank.resize(n);
+    for (int r = 0; r < n; r++) idOfRank[r] = SIM_FIRST_ID + r;
+    for (int r = n - 1; r > 0; r--) {
+        int j = (int)(nextRandom() % (unsigned long long)(r + 1));
+        swap(idOfRank[r], idOfRank[j]);
+    }
+
+    double expectedUnits = config.orderRate * config.duration * (config.maxOrderQty + 1) / 2.0;
+    masterData.resize(n);
+    for (int r = 0; r < n; r++) {
+        int id = idOfRank[r];
+        int category = (int)(nextRandom() % SIM_CATEGORY_COUNT);
+        double share = popularityCdf[r] - (r > 0 ? popularityCdf[r - 1] : 0.0);
+        int stock = 20 + (int)(share * expectedUnits * 0.5) + (int)(nextRandom() % 50);
+        double price = floor(SIM_BASE_PRICE[category] * (0.5 + uniform() * 1.5) * 100.0) / 100.0;
+        string name = string(SIM_CATEGORIES[category]) + " item #" + to_string(id);
+        masterData[id - SIM_FIRST_ID] = Product(id, name, SIM_CATEGORIES[category], stock, price, 0);
+    }
+    for (const Product& p : masterData) warehouse.addProduct(p);
+}
+
+static double percentile(vector<double>& values, double q) {
+    if (values.empty()) return 0;
+    size_t k = (size_t)(q * (double)(values.size() - 1));
+    nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+static void printLatency(const char* label, vector<double>& values, double scale, const char* unit) {
+    if (values.empty()) {
+        printf("  %-18s (no samples)\n", label);
+        return;
+    }
+    double maxValue = *max_element(values.begin(), values.end());
+    printf("  %-18s p50 %9.2f  p90 %9.2f  p99 %9.2f  p99.9 %9.2f  max %9.2f %s\n", label,
+           percentile(values, 0.50) * scale, percentile(values, 0.90) * scale,
+           percentile(values, 0.99) * scale, percentile(values, 0.999) * scale, maxValue * scale, unit);
+}
+
+int LoadSimulator::run() {
+    if (config.skuCount <= 0 || config.orderRate <= 0 || config.serviceRate <= 0 || config.duration <= 0 ||
+        config.maxOrderQty < 1 || !(config.urgentRatio >= 0 && config.urgentRatio <= 1)) {
+        cout << Theme::ERR << "Invalid simulation parameters." << RESET << endl;
+        return 1;
+    }
+
+    WarehouseSystem warehouse(config.skuCount, config.skuCount, config.skuCount * 2);
+    warehouse.setVerbose(false);
+
+    cout << Theme::HEADER << "Load simulation" << RESET << endl;
+    printf("  seed %llu, %d SKUs, zipf %.2f, %.0f orders/s, service %.0f orders/s, %.0f restocks/s, %.1f%% urgent, %.0f s\n",
+           config.seed, config.skuCount, config.zipfExponent, config.orderRate, config.serviceRate,
+           config.restockRate, config.urgentRatio * 100.0, config.duration);
+
+    chrono::steady_clock::time_point setupStart = chrono::steady_clock::now();
+    generateCatalog(warehouse);
+    printf("  catalog generated in %.2f s\n",
+           chrono::duration<double>(chrono::steady_clock::now() - setupStart).count());
+
+    unordered_map<int, double> placedAt;    // Order ID -> simulated arrival time
+    vector<double> placeWall, processWall;  // Wall-clock seconds per call
+    vector<double> sojourn, urgentSojourn;  // Simulated seconds from arrival to processing
+    vector<pair<double, int> > depthSamples;
+    placeWall.reserve((size_t)(config.orderRate * config.duration * 1.1));
+    processWall.reserve(placeWall.capacity());
+
+    long long placed = 0, rejected = 0, fulfilled = 0, failed = 0, restocks = 0, relisted = 0;
+    int maxDepth = 0;
+
+    double nextArrival = exponential(config.orderRate);
+    double nextRestock = config.restockRate > 0 ? exponential(config.restockRate) : 1e300;
+    double nextService = 1e300;                      // Only scheduled while orders are pending
+    double serviceTime = 1.0 / config.serviceRate;
+    double sampleEvery = config.duration / max(config.samples, 1);
+    double nextSample = sampleEvery;
+
+    chrono::steady_clock::time_point runStart = chrono::steady_clock::now();
+    while (true) {
+        double now = min(min(nextArrival, nextRestock), min(nextService, nextSample));
+        if (now > config.duration) break;
+
+        if (now == nextSample) {
+            depthSamples.push_back(make_pair(now, warehouse.pendingOrderCount()));
+            nextSample += sampleEvery;
+        } else if (now == nextArrival) {
+            int productId = pickProduct();
+            int qty = 1 + (int)(nextRandom() % (unsigned long long)config.maxOrderQty);
+            bool urgent = uniform() < config.urgentRatio;
+
+            chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+            int orderId = warehouse.placeOrder(productId, qty, urgent);
+            placeWall.push_back(chrono::duration<double>(chrono::steady_clock::now() - t0).count());
+
+            if (orderId != 0) {
+                placed++;
+                placedAt[orderId] = now;
+                if (nextService == 1e300) nextService = now + serviceTime;
+            } else {
+                rejected++;
+            }
+            int depth = warehouse.pendingOrderCount();
+            if (depth > maxDepth) maxDepth = depth;
+            nextArrival = now + exponential(config.orderRate);
+        } else if (now == nextRestock) {
+            // Popular items sell out first, so restocks follow the same popularity
+            int productId = pickProduct();
+            int amount = 50 + (int)(nextRandom() % 200);
+            Product* p = warehouse.searchProduct(productId);
+            if (p != nullptr) {
+                warehouse.updateStock(productId, p->quantity + amount);
+            } else {
+                Product again = masterData[productId - SIM_FIRST_ID];
+                again.quantity = amount;
+                warehouse.addProduct(again);
+                relisted++;
+            }
+            restocks++;
+            nextRestock = now + exponential(config.restockRate);
+        } else {
+            Order next;
+            if (warehouse.peekNextOrder(next)) {
+                chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+                bool ok = warehouse.processNextOrder();
+                processWall.push_back(chrono::duration<double>(chrono::steady_clock::now() - t0).count());
+
+                if (ok) fulfilled++;
+                else failed++;
+                unordered_map<int, double>::iterator it = placedAt.find(next.orderId);
+                if (it != placedAt.end()) {
+                    (next.urgent ? urgentSojourn : sojourn).push_back(now - it->second);
+                    placedAt.erase(it);
+                }
+            }
+            nextService = warehouse.pendingOrderCount() > 0 ? now + serviceTime : 1e300;
+        }
+    }
+    double wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - runStart).count();
+
+    cout << Theme::HEADER << "Results" << RESET << endl;
+    printf("  orders placed %lld, rejected %lld (out of stock), fulfilled %lld, failed at processing %lld\n",
+           placed, rejected, fulfilled, failed);
+    printf("  restocks %lld (%lld sold-out SKUs re-listed), pending at end %d, max queue depth %d\n",
+           restocks, relisted, warehouse.pendingOrderCount(), maxDepth);
+    printf("  simulated %.0f s in %.3f s wall: %.0f warehouse calls/s sustained (%.0fx real time)\n",
+           config.duration, wallSeconds, (double)(placeWall.size() + processWall.size()) / wallSeconds,
+           config.duration / wallSeconds);
+
+    cout << Theme::HEADER << "Call latency (wall clock)" << RESET << endl;
+    printLatency("placeOrder", placeWall, 1e6, "us");
+    printLatency("processNextOrder", processWall, 1e6, "us");
+
+    cout << Theme::HEADER << "Order latency, arrival to processing (simulated)" << RESET << endl;
+    printLatency("regular", sojourn, 1e3, "ms");
+    printLatency("urgent", urgentSojourn, 1e3, "ms");
+
+    cout << Theme::HEADER << "Queue depth over time" << RESET << endl;
+    int peak = 1;
+    for (const pair<double, int>& s : depthSamples) peak = max(peak, s.second);
+    for (const pair<double, int>& s : depthSamples) {
+        int bar = (int)(40.0 * s.second / peak);
+        printf("  t=%8.1fs %8d %s\n", s.first, s.second, string(bar, '#').c_str());
+    }
+    return 0;
+}
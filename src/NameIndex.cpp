@@ -0,0 +1,427 @@
+#include "../include/NameIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+NameIndex::NameIndex() : deadDocs(0), stamp(0) {
+    nodes.push_back(TrieNode('\0'));
+}
+
+// Lower-case alphanumeric runs, everything else separates words
+void NameIndex::tokenize(const string& name, vector<string>& words) {
+    string word;
+    for (char c : name) {
+        if (isalnum((unsigned char)c)) {
+            word += (char)tolower((unsigned char)c);
+        } else if (!word.empty()) {
+            words.push_back(word);
+            word.clear();
+        }
+    }
+    if (!word.empty()) words.push_back(word);
+}
+
+static void termTrigrams(const string& term, vector<unsigned>& out) {
+    string padded = "$" + term + "$";
+    for (size_t i = 0; i + 3 <= padded.size(); i++) {
+        out.push_back(((unsigned)(unsigned char)padded[i] << 16) | ((unsigned)(unsigned char)padded[i + 1] << 8) |
+                      (unsigned)(unsigned char)padded[i + 2]);
+    }
+}
+
+int NameIndex::childOf(int node, char c) const {
+    int child = nodes[node].firstChild;
+    while (child >= 0 && nodes[child].letter < c) child = nodes[child].nextSibling;
+    return (child >= 0 && nodes[child].letter == c) ? child : -1;
+}
+
+int NameIndex::findTerm(const string& word) const {
+    int node = 0;
+    for (char c : word) {
+        node = childOf(node, c);
+        if (node < 0) return -1;
+    }
+    return nodes[node].term;
+}
+
+// Walk or extend the trie, keeping each sibling list sorted by letter
+int NameIndex::addTerm(const string& word) {
+    int node = 0;
+    for (char c : word) {
+        int prev = -1;
+        int child = nodes[node].firstChild;
+        while (child >= 0 && nodes[child].letter < c) {
+            prev = child;
+            child = nodes[child].nextSibling;
+        }
+        if (child < 0 || nodes[child].letter != c) {
+            int created = (int)nodes.size();
+            nodes.push_back(TrieNode(c));
+            nodes[created].nextSibling = child;
+            if (prev < 0) nodes[node].firstChild = created;
+            else nodes[prev].nextSibling = created;
+            child = created;
+        }
+        node = child;
+    }
+
+    if (nodes[node].term < 0) {
+        int term = (int)terms.size();
+        nodes[node].term = term;
+        terms.push_back(word);
+        postings.push_back(vector<int>());
+        liveCount.push_back(0);
+        hitCount.push_back(0);
+        hitStamp.push_back(0);
+
+        vector<unsigned> grams;
+        termTrigrams(word, grams);
+        for (unsigned g : grams) {
+            vector<int>& list = trigrams[g];
+            if (list.empty() || list.back() != term) list.push_back(term);
+        }
+    }
+    return nodes[node].term;
+}
+
+// A product already indexed keeps its document and gains the new words
+void NameIndex::add(int productId, const string& name) {
+    int doc;
+    unordered_map<int, int>::iterator it = docOf.find(productId);
+    if (it != docOf.end()) {
+        doc = it->second;
+    } else {
+        doc = (int)productOf.size();
+        productOf.push_back(productId);
+        renumbered.push_back(-1);
+        docOf[productId] = doc;
+        wordScore.push_back(0);
+        wordStamp.push_back(0);
+        totalScore.push_back(0);
+        totalWords.push_back(0);
+        totalStamp.push_back(0);
+    }
+
+    // New documents are the largest so far; a re-added product's may not be
+    vector<string> words;
+    tokenize(name, words);
+    for (const string& w : words) {
+        int term = addTerm(w);
+        vector<int>& posting = postings[term];
+        if (posting.empty() || posting.back() < doc) {
+            posting.push_back(doc);
+            liveCount[term]++;
+        } else {
+            vector<int>::iterator at = lower_bound(posting.begin(), posting.end(), doc);
+            if (*at != doc) {
+                posting.insert(at, doc);
+                liveCount[term]++;
+            }
+        }
+    }
+}
+
+// The document is marked dead and its postings are left for compact(); only
+// the live counts of the name's terms drop, so a term whose products are all
+// gone stops hiding completions and typo matches. Documents are never reused
+// before compact(), so stale postings cannot match.
+void NameIndex::remove(int productId, const string& name) {
+    unordered_map<int, int>::iterator it = docOf.find(productId);
+    if (it == docOf.end()) return;
+    int doc = it->second;
+
+    // The name's words are walked down the trie as tokenize() splits them, so
+    // removal allocates nothing; a term is counted once (stamped), as each
+    // posting holds the document once however often the word repeats
+    int seen = ++stamp;
+    int node = 0;
+    bool inWord = false;
+    for (size_t i = 0; i <= name.size(); i++) {
+        if (i < name.size() && isalnum((unsigned char)name[i])) {
+            if (node >= 0) node = childOf(node, (char)tolower((unsigned char)name[i]));
+            inWord = true;
+            continue;
+        }
+        int term = (inWord && node >= 0) ? nodes[node].term : -1;
+        if (term >= 0 && hitStamp[term] != seen) {
+            hitStamp[term] = seen;
+            const vector<int>& posting = postings[term];
+            if (binary_search(posting.begin(), posting.end(), doc)) liveCount[term]--;
+        }
+        node = 0;
+        inWord = false;
+    }
+    productOf[doc] = -1;
+    docOf.erase(it);
+    deadDocs++;
+    if (deadDocs >= 1024 && deadDocs > (int)docOf.size()) compact();
+}
+
+// Drop dead documents from every posting and renumber the live ones densely
+void NameIndex::compact() {
+    fill(renumbered.begin(), renumbered.end(), -1);
+    int live = 0;
+    for (size_t doc = 0; doc < productOf.size(); doc++) {
+        if (productOf[doc] < 0) continue;
+        renumbered[doc] = live;
+        productOf[live] = productOf[doc];
+        docOf[productOf[live]] = live;
+        live++;
+    }
+    productOf.resize(live);
+    for (vector<int>& posting : postings) {
+        size_t kept = 0;
+        for (int doc : posting) {
+            if (renumbered[doc] >= 0) posting[kept++] = renumbered[doc];
+        }
+        posting.resize(kept);
+    }
+    for (size_t term = 0; term < postings.size(); term++) liveCount[term] = (int)postings[term].size();
+    renumbered.resize(live);
+    deadDocs = 0;
+
+    // Scratch stamps may hold any value from here on; reset them with the new size
+    wordScore.assign(live, 0);
+    wordStamp.assign(live, 0);
+    totalScore.assign(live, 0);
+    totalWords.assign(live, 0);
+    totalStamp.assign(live, 0);
+}
+
+// Terms under the prefix node, breadth first so shorter completions come first
+void NameIndex::prefixTerms(const string& prefix, vector<int>& out) const {
+    int node = 0;
+    for (char c : prefix) {
+        int child = nodes[node].firstChild;
+        while (child >= 0 && nodes[child].letter < c) child = nodes[child].nextSibling;
+        if (child < 0 || nodes[child].letter != c) return;
+        node = child;
+    }
+
+    vector<int> level(1, node), next;
+    while (!level.empty() && (int)out.size() < NAME_MAX_PREFIX_TERMS) {
+        next.clear();
+        for (int n : level) {
+            int term = nodes[n].term;
+            if (term >= 0 && liveCount[term] > 0) {
+                out.push_back(term);
+                if ((int)out.size() == NAME_MAX_PREFIX_TERMS) return;
+            }
+            for (int child = nodes[n].firstChild; child >= 0; child = nodes[child].nextSibling) {
+                next.push_back(child);
+            }
+        }
+        level.swap(next);
+    }
+}
+
+// Levenshtein distance, or limit + 1 once it must exceed limit
+static int boundedDistance(const string& a, const string& b, int limit) {
+    int n = (int)a.size(), m = (int)b.size();
+    if (abs(n - m) > limit) return limit + 1;
+    vector<int> prev(m + 1), cur(m + 1);
+    for (int j = 0; j <= m; j++) prev[j] = j;
+    for (int i = 1; i <= n; i++) {
+        cur[0] = i;
+        int rowMin = cur[0];
+        for (int j = 1; j <= m; j++) {
+            int cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
+            cur[j] = min(min(prev[j] + 1, cur[j - 1] + 1), prev[j - 1] + cost);
+            rowMin = min(rowMin, cur[j]);
+        }
+        if (rowMin > limit) return limit + 1;
+        prev.swap(cur);
+    }
+    return prev[m];
+}
+
+// Terms within 1 (short words) or 2 edits: trigram overlap picks candidates,
+// the edit distance confirms them
+void NameIndex::fuzzyTerms(const string& word, vector<pair<int, int>>& out) const {
+    if (word.size() < 3) return;
+    int maxDist = (word.size() <= 4) ? 1 : 2;
+
+    vector<unsigned> grams;
+    termTrigrams(word, grams);
+    int needed = max(1, (int)grams.size() - 3 * maxDist);
+
+    stamp++;
+    vector<int> touched;
+    for (unsigned g : grams) {
+        unordered_map<unsigned, vector<int>>::const_iterator it = trigrams.find(g);
+        if (it == trigrams.end()) continue;
+        for (int term : it->second) {
+            if (hitStamp[term] != stamp) {
+                hitStamp[term] = stamp;
+                hitCount[term] = 0;
+                touched.push_back(term);
+            }
+            hitCount[term]++;
+        }
+    }
+
+    vector<pair<int, int>> candidates;   // (-hits, term)
+    for (int term : touched) {
+        if (hitCount[term] >= needed && abs((int)terms[term].size() - (int)word.size()) <= maxDist &&
+            liveCount[term] > 0) {
+            candidates.push_back(make_pair(-hitCount[term], term));
+        }
+    }
+    size_t keep = min(candidates.size(), (size_t)(4 * NAME_MAX_FUZZY_TERMS));
+    partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end());
+
+    for (size_t i = 0; i < keep; i++) {
+        int term = candidates[i].second;
+        int d = boundedDistance(word, terms[term], maxDist);
+        if (d > 0 && d <= maxDist) out.push_back(make_pair(term, d));
+    }
+    sort(out.begin(), out.end(), [](const pair<int, int>& a, const pair<int, int>& b) {
+        return a.second < b.second || (a.second == b.second && a.first < b.first);
+    });
+    if ((int)out.size() > NAME_MAX_FUZZY_TERMS) out.resize(NAME_MAX_FUZZY_TERMS);
+}
+
+// Terms a query word matches, with their scores. A word with completions is
+// taken as unfinished rather than misspelled.
+void NameIndex::wordTerms(const string& w, bool last, vector<pair<int, float>>& out) const {
+    int exact = findTerm(w);
+    bool hasExact = exact >= 0 && liveCount[exact] > 0;
+    if (hasExact) out.push_back(make_pair(exact, 1.0f));
+    vector<int> prefixed;
+    if (last || !hasExact) {
+        prefixTerms(w, prefixed);
+        for (int term : prefixed) {
+            if (term != exact) out.push_back(make_pair(term, 0.5f + 0.4f * (float)w.size() / (float)terms[term].size()));
+        }
+    }
+    if (!hasExact && prefixed.empty()) {
+        vector<pair<int, int>> fuzzy;
+        fuzzyTerms(w, fuzzy);
+        for (const pair<int, int>& f : fuzzy) out.push_back(make_pair(f.first, 0.6f - 0.2f * (float)f.second));
+    }
+}
+
+// Add one query word's best score to each document it matches. Scanning walks
+// its postings; otherwise only the documents matched so far are looked up.
+void NameIndex::creditWord(const vector<pair<int, float>>& wordTermList, bool scan, int queryStamp, vector<int>& matchedDocs) const {
+    int wordStampNow = ++stamp;
+    vector<int> wordDocs;
+    auto credit = [&](int doc, float score) {
+        if (wordStamp[doc] != wordStampNow) {
+            wordStamp[doc] = wordStampNow;
+            wordScore[doc] = score;
+            wordDocs.push_back(doc);
+        } else if (score > wordScore[doc]) {
+            wordScore[doc] = score;
+        }
+    };
+    for (const pair<int, float>& t : wordTermList) {
+        const vector<int>& posting = postings[t.first];
+        if (scan) {
+            for (int doc : posting) {
+                if (productOf[doc] >= 0) credit(doc, t.second);
+            }
+        } else {
+            for (int doc : matchedDocs) {
+                if (binary_search(posting.begin(), posting.end(), doc)) credit(doc, t.second);
+            }
+        }
+    }
+
+    for (int doc : wordDocs) {
+        if (totalStamp[doc] != queryStamp) {
+            totalStamp[doc] = queryStamp;
+            totalWords[doc] = 0;
+            totalScore[doc] = 0;
+            matchedDocs.push_back(doc);
+        }
+        totalWords[doc]++;
+        totalScore[doc] += wordScore[doc];
+    }
+}
+
+vector<NameMatch> NameIndex::search(const string& query, int limit) const {
+    vector<string> words;
+    tokenize(query, words);
+    vector<string> seen;
+    for (size_t i = 0; i < words.size(); i++) {
+        if (find(seen.begin(), seen.end(), words[i]) == seen.end()) seen.push_back(words[i]);
+    }
+    words.swap(seen);
+
+    int n = (int)words.size();
+    vector<vector<pair<int, float>>> wordTermLists(n);
+    vector<long long> wordPostings(n, 0);
+    int rarest = -1;
+    for (int i = 0; i < n; i++) {
+        wordTerms(words[i], i + 1 == n, wordTermLists[i]);
+        for (const pair<int, float>& t : wordTermLists[i]) wordPostings[i] += (long long)postings[t.first].size();
+        if (rarest < 0 || wordPostings[i] < wordPostings[rarest]) rarest = i;
+    }
+
+    // Words are scanned rarest first. A common word is probed instead when
+    // looking up each document matched so far is cheaper than its postings
+    vector<int> order(n);
+    for (int i = 0; i < n; i++) order[i] = i;
+    sort(order.begin(), order.end(), [&wordPostings](int a, int b) { return wordPostings[a] < wordPostings[b]; });
+    vector<char> probe(n, 0);
+    long long scanned = 0;
+    int probed = 0;
+    for (int i : order) {
+        long long lookups = scanned * (long long)wordTermLists[i].size() * NAME_PROBE_COST;
+        if (limit > 0 && i != rarest && wordPostings[i] > NAME_SCAN_POSTINGS && lookups < wordPostings[i]) {
+            probe[i] = 1;
+            probed++;
+        } else {
+            scanned += wordPostings[i];
+        }
+    }
+
+    // A document the probes miss matches only probed words, at most `probed`
+    // of them: once `limit` documents match more, none of those is missed
+    int queryStamp = 0;
+    vector<int> matchedDocs;
+    for (int pass = 0; pass < 2; pass++) {
+        queryStamp = ++stamp;
+        matchedDocs.clear();
+        for (int i : order) {
+            if (!probe[i]) creditWord(wordTermLists[i], true, queryStamp, matchedDocs);
+        }
+        for (int i : order) {
+            if (probe[i]) creditWord(wordTermLists[i], false, queryStamp, matchedDocs);
+        }
+        if (probed == 0) break;
+        int settled = 0;
+        for (int doc : matchedDocs) {
+            if (totalWords[doc] > probed) settled++;
+        }
+        if (settled >= limit) break;
+        probe.assign(n, 0);
+        probed = 0;
+    }
+
+    // Only documents that can still make the top `limit` by words matched are ranked
+    int minWords = 0;
+    if (limit > 0) {
+        vector<int> withWords(n + 1, 0);
+        for (int doc : matchedDocs) withWords[totalWords[doc]]++;
+        int atLeast = 0;
+        for (minWords = n; minWords > 0; minWords--) {
+            atLeast += withWords[minWords];
+            if (atLeast >= limit) break;
+        }
+    }
+    vector<NameMatch> matches;
+    for (int doc : matchedDocs) {
+        if (totalWords[doc] >= minWords) matches.push_back(NameMatch(productOf[doc], totalWords[doc], totalScore[doc]));
+    }
+    auto better = [](const NameMatch& a, const NameMatch& b) {
+        if (a.wordsMatched != b.wordsMatched) return a.wordsMatched > b.wordsMatched;
+        if (a.score != b.score) return a.score > b.score;
+        return a.productId < b.productId;
+    };
+    size_t keep = (limit > 0) ? min(matches.size(), (size_t)limit) : matches.size();
+    partial_sort(matches.begin(), matches.begin() + keep, matches.end(), better);
+    matches.erase(matches.begin() + keep, matches.end());
+    return matches;
+}
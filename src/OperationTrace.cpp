@@ -0,0 +1,341 @@
+#include "../include/OperationTrace.h"
+#include "../include/Varint.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// Trace file layout (integers are LEB128 varints, zigzag for signed values):
+//   header  8-byte magic "WHTRACE1", u64 little-endian wall-clock start (us)
+//   call    u8 op, varint ns since the previous call (the first: since open),
+//           then the op's arguments in the order listed in OperationTrace.h:
+//           integers zigzag varint, prices raw 64-bit, strings varint length
+//           + bytes, products id, name, category, quantity, price, sales,
+//           filters category, quantity, price and sales bounds
+// There is no trailer: a trace cut short by a crash reads up to its last whole call.
+
+#define TRACE_MAGIC "WHTRACE2"
+
+static const char* TRACE_OP_NAMES[TRACE_OP_KINDS] = {
+    "?", "add", "remove", "stock", "price", "search", "freeze", "list", "filter", "filter ids",
+    "price range", "cheapest", "name search", "order", "process", "process batch", "snapshot",
+    "lowest", "best", "heap policy", "compact", "restore orders", "wave"
+};
+
+const char* traceOpName(int op) {
+    return op > 0 && op < TRACE_OP_KINDS ? TRACE_OP_NAMES[op] : TRACE_OP_NAMES[0];
+}
+
+static long long traceNow() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------- OperationRecorder ----------
+
+OperationRecorder::OperationRecorder(const string& path) : last(traceNow()), records(0) {
+    if (!out.open(path)) return;
+    scratch.reserve(256);
+    unsigned char header[16];
+    memcpy(header, TRACE_MAGIC, 8);
+    unsigned long long micros = (unsigned long long)chrono::duration_cast<chrono::microseconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+    for (int i = 0; i < 8; i++) header[8 + i] = (unsigned char)(micros >> (8 * i));
+    out.put(header, sizeof(header));
+}
+
+OperationRecorder::~OperationRecorder() {
+    close();
+}
+
+bool OperationRecorder::close() {
+    return out.close();
+}
+
+void OperationRecorder::begin(TraceOp op) {
+    long long now = traceNow();
+    scratch.clear();
+    scratch.push_back((unsigned char)op);
+    unsigned char bytes[10];
+    scratch.insert(scratch.end(), bytes, writeVarint(bytes, (unsigned long long)(now - last)));
+    last = now;
+}
+
+void OperationRecorder::putInt(long long v) {
+    unsigned char bytes[10];
+    scratch.insert(scratch.end(), bytes, writeVarint(bytes, zigzag(v)));
+}
+
+void OperationRecorder::putDouble(double v) {
+    unsigned long long bits;
+    memcpy(&bits, &v, sizeof(bits));
+    for (int i = 0; i < 8; i++) scratch.push_back((unsigned char)(bits >> (8 * i)));
+}
+
+void OperationRecorder::putString(const string& s) {
+    unsigned char bytes[10];
+    scratch.insert(scratch.end(), bytes, writeVarint(bytes, s.size()));
+    scratch.insert(scratch.end(), s.begin(), s.end());
+}
+
+void OperationRecorder::putProduct(const Product& p) {
+    putInt(p.id);
+    putString(p.name);
+    putString(p.category);
+    putInt(p.quantity);
+    putDouble(p.price);
+    putInt(p.salesCount);
+}
+
+void OperationRecorder::putFilter(const ProductFilter& f) {
+    putString(f.category);
+    putInt(f.minQuantity);
+    putInt(f.maxQuantity);
+    putDouble(f.minPrice);
+    putDouble(f.maxPrice);
+    putInt(f.minSales);
+    putInt(f.maxSales);
+}
+
+void OperationRecorder::finish() {
+    out.put(scratch.data(), scratch.size());
+    records++;
+}
+
+void OperationRecorder::call(TraceOp op) {
+    begin(op);
+    finish();
+}
+
+void OperationRecorder::call(TraceOp op, long long a) {
+    begin(op);
+    putInt(a);
+    finish();
+}
+
+void OperationRecorder::call(TraceOp op, long long a, long long b) {
+    begin(op);
+    putInt(a);
+    putInt(b);
+    finish();
+}
+
+void OperationRecorder::call(TraceOp op, long long a, long long b, long long c) {
+    begin(op);
+    putInt(a);
+    putInt(b);
+    putInt(c);
+    finish();
+}
+
+void OperationRecorder::addProduct(const Product& p) {
+    begin(TRACE_ADD);
+    putProduct(p);
+    finish();
+}
+
+void OperationRecorder::updatePrice(int productId, double price) {
+    begin(TRACE_PRICE);
+    putInt(productId);
+    putDouble(price);
+    finish();
+}
+
+void OperationRecorder::listProducts(const ListingQuery& query) {
+    begin(TRACE_LIST);
+    putInt(query.sortBy);
+    putInt(query.descending ? 1 : 0);
+    putInt(query.limit);
+    putInt(query.offset);
+    putInt(query.cursor.valid ? 1 : 0);
+    if (query.cursor.valid) putProduct(query.cursor.last);
+    finish();
+}
+
+void OperationRecorder::filter(TraceOp op, const ProductFilter& f) {
+    begin(op);
+    putFilter(f);
+    finish();
+}
+
+void OperationRecorder::priceRange(double lo, double hi, int limit) {
+    begin(TRACE_PRICE_RANGE);
+    putDouble(lo);
+    putDouble(hi);
+    putInt(limit);
+    finish();
+}
+
+void OperationRecorder::searchByName(const string& query, int limit) {
+    begin(TRACE_NAME_SEARCH);
+    putString(query);
+    putInt(limit);
+    finish();
+}
+
+void OperationRecorder::restorePendingOrders(const vector<Order>& orders, int nextId) {
+    begin(TRACE_RESTORE_ORDERS);
+    putInt((long long)orders.size());
+    for (const Order& o : orders) {
+        putInt(o.orderId);
+        putInt(o.productId);
+        putInt(o.quantity);
+        putInt(o.urgent ? 1 : 0);
+    }
+    putInt(nextId);
+    finish();
+}
+
+// ---------- TraceReader ----------
+
+TraceReader::TraceReader() : pos(0), at(0), startMicros(0), ok(true) {}
+
+bool TraceReader::open(const string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) return false;
+    unsigned char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(file);
+
+    if (data.size() < 16 || memcmp(data.data(), TRACE_MAGIC, 8) != 0) return false;
+    unsigned long long micros = 0;
+    for (int i = 0; i < 8; i++) micros |= (unsigned long long)data[8 + i] << (8 * i);
+    startMicros = (long long)micros;
+    pos = 16;
+    return true;
+}
+
+unsigned long long TraceReader::getVarint() {
+    unsigned long long v = 0;
+    const unsigned char* next = readVarint(data.data() + pos, data.data() + data.size(), v);
+    if (next == nullptr) {
+        ok = false;
+        return 0;
+    }
+    pos = (size_t)(next - data.data());
+    return v;
+}
+
+long long TraceReader::getInt() {
+    return unzigzag(getVarint());
+}
+
+double TraceReader::getDouble() {
+    if (pos + 8 > data.size()) {
+        ok = false;
+        return 0;
+    }
+    unsigned long long bits = 0;
+    for (int i = 0; i < 8; i++) bits |= (unsigned long long)data[pos + i] << (8 * i);
+    pos += 8;
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+void TraceReader::getString(string& s) {
+    unsigned long long len = getVarint();
+    if (!ok || len > data.size() - pos) {
+        ok = false;
+        s.clear();
+        return;
+    }
+    s.assign((const char*)data.data() + pos, (size_t)len);
+    pos += (size_t)len;
+}
+
+void TraceReader::getProduct(Product& p) {
+    p.id = (int)getInt();
+    getString(p.name);
+    getString(p.category);
+    p.quantity = (int)getInt();
+    p.price = getDouble();
+    p.salesCount = (int)getInt();
+}
+
+void TraceReader::getFilter(ProductFilter& f) {
+    getString(f.category);
+    f.minQuantity = (int)getInt();
+    f.maxQuantity = (int)getInt();
+    f.minPrice = getDouble();
+    f.maxPrice = getDouble();
+    f.minSales = (int)getInt();
+    f.maxSales = (int)getInt();
+}
+
+bool TraceReader::next(TraceRecord& r) {
+    if (!ok || pos >= data.size()) return false;
+    int op = data[pos++];
+    if (op <= 0 || op >= TRACE_OP_KINDS) {
+        ok = false;
+        return false;
+    }
+    r.op = (TraceOp)op;
+    at += (long long)getVarint();
+    r.at = at;
+
+    switch (r.op) {
+    case TRACE_ADD:
+        getProduct(r.product);
+        break;
+    case TRACE_PRICE:
+        r.args[0] = getInt();
+        r.lo = getDouble();
+        break;
+    case TRACE_LIST:
+        r.listing = ListingQuery();
+        r.listing.sortBy = (ListingSort)getInt();
+        r.listing.descending = getInt() != 0;
+        r.listing.limit = (int)getInt();
+        r.listing.offset = (int)getInt();
+        r.listing.cursor.valid = getInt() != 0;
+        if (r.listing.cursor.valid) getProduct(r.listing.cursor.last);
+        break;
+    case TRACE_FILTER:
+    case TRACE_FILTER_IDS:
+        getFilter(r.filter);
+        break;
+    case TRACE_PRICE_RANGE:
+        r.lo = getDouble();
+        r.hi = getDouble();
+        r.args[0] = getInt();
+        break;
+    case TRACE_NAME_SEARCH:
+        getString(r.text);
+        r.args[0] = getInt();
+        break;
+    case TRACE_RESTORE_ORDERS: {
+        long long count = getInt();
+        r.orders.clear();
+        for (long long i = 0; i < count && ok; i++) {
+            Order o;
+            o.orderId = (int)getInt();
+            o.productId = (int)getInt();
+            o.quantity = (int)getInt();
+            o.urgent = getInt() != 0;
+            r.orders.push_back(o);
+        }
+        r.args[0] = getInt();
+        break;
+    }
+    case TRACE_STOCK:
+        r.args[0] = getInt();
+        r.args[1] = getInt();
+        break;
+    case TRACE_ORDER:
+        r.args[0] = getInt();
+        r.args[1] = getInt();
+        r.args[2] = getInt();
+        break;
+    case TRACE_REMOVE:
+    case TRACE_SEARCH:
+    case TRACE_CHEAPEST:
+    case TRACE_PROCESS_BATCH:
+    case TRACE_HEAP_POLICY:
+    case TRACE_WAVE:
+        r.args[0] = getInt();
+        break;
+    default:
+        break;
+    }
+    return ok;
+}
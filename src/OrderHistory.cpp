@@ -0,0 +1,205 @@
+#include "../include/OrderHistory.h"
+#include "../include/Varint.h"
+#include <algorithm>
+#include <cstring>
+
+// Sealed block layout for n records (native byte order, the store never leaves the process):
+//   productId  n x int32, scanned directly by per-product lookups
+//   groups     per HISTORY_GROUP_ROWS rows: base time, base orderId, offset of the group's rows
+//   urgent     one bit per record, LSB first
+//   rows       per record: varint time delta, zigzag varint orderId delta, varint quantity,
+//              deltas restarting from the group bases
+struct HistoryGroup {
+    long long baseTime;
+    int baseOrderId;
+    int offset;
+};
+
+OrderHistory::OrderHistory() : lastTime(0), recordCount(0) {
+    tail.reserve(HISTORY_BLOCK_ROWS);
+}
+
+void OrderHistory::append(const Order& o, long long timeMicros) {
+    if (timeMicros < lastTime) timeMicros = lastTime;
+    lastTime = timeMicros;
+
+    // Posting lists name the block the record will be sealed into
+    int block = (int)blocks.size();
+    vector<int>& posting = postings[o.productId];
+    if (posting.empty() || posting.back() != block) posting.push_back(block);
+
+    tail.push_back(HistoryRecord(timeMicros, o));
+    recordCount++;
+    if ((int)tail.size() == HISTORY_BLOCK_ROWS) seal();
+}
+
+void OrderHistory::seal() {
+    int n = (int)tail.size();
+    int groupCount = (n + HISTORY_GROUP_ROWS - 1) / HISTORY_GROUP_ROWS;
+    size_t idBytes = (size_t)n * sizeof(int);
+    size_t groupBytes = (size_t)groupCount * sizeof(HistoryGroup);
+    size_t bitBytes = (size_t)(n + 7) / 8;
+    scratch.assign(idBytes + groupBytes + bitBytes + (size_t)n * 25, 0);
+    unsigned char* start = scratch.data();
+
+    for (int i = 0; i < n; i++) memcpy(start + i * sizeof(int), &tail[i].productId, sizeof(int));
+
+    unsigned char* bits = start + idBytes + groupBytes;
+    for (int i = 0; i < n; i++) {
+        if (tail[i].urgent) bits[i / 8] |= (unsigned char)(1u << (i % 8));
+    }
+
+    unsigned char* dst = bits + bitBytes;
+    long long prevTime = 0, prevOrder = 0;
+    for (int i = 0; i < n; i++) {
+        const HistoryRecord& r = tail[i];
+        if (i % HISTORY_GROUP_ROWS == 0) {
+            HistoryGroup group;
+            group.baseTime = prevTime = r.time;
+            group.baseOrderId = r.orderId;
+            prevOrder = r.orderId;
+            group.offset = (int)(dst - start);
+            memcpy(start + idBytes + (i / HISTORY_GROUP_ROWS) * sizeof(HistoryGroup), &group, sizeof(group));
+        }
+        dst = writeVarint(dst, (unsigned long long)(r.time - prevTime));
+        dst = writeVarint(dst, zigzag((long long)r.orderId - prevOrder));
+        dst = writeVarint(dst, zigzag(r.quantity));
+        prevTime = r.time;
+        prevOrder = r.orderId;
+    }
+    int bytes = (int)(dst - start);
+
+    if (segments.empty() || segments.back().size() + (size_t)bytes > HISTORY_SEGMENT_BYTES) {
+        segments.push_back(vector<unsigned char>());
+        segments.back().reserve(max(HISTORY_SEGMENT_BYTES, bytes));
+    }
+    vector<unsigned char>& segment = segments.back();
+
+    HistoryBlock block;
+    block.firstTime = tail.front().time;
+    block.lastTime = tail.back().time;
+    block.segment = (int)segments.size() - 1;
+    block.offset = (int)segment.size();
+    block.bytes = bytes;
+    block.count = n;
+    segment.insert(segment.end(), start, dst);
+    blocks.push_back(block);
+    tail.clear();
+}
+
+void OrderHistory::decodeRows(int index, const int* rows, int rowCount, vector<HistoryRecord>& out) const {
+    const HistoryBlock& block = blocks[index];
+    const unsigned char* base = segments[block.segment].data() + block.offset;
+    const unsigned char* end = base + block.bytes;
+    int n = block.count;
+    size_t idBytes = (size_t)n * sizeof(int);
+    int groupCount = (n + HISTORY_GROUP_ROWS - 1) / HISTORY_GROUP_ROWS;
+    const unsigned char* bits = base + idBytes + (size_t)groupCount * sizeof(HistoryGroup);
+    if (rows == nullptr) rowCount = n;
+
+    // Walk forward from the nearest restart point of each wanted row
+    int group = -1, row = 0;
+    const unsigned char* src = nullptr;
+    long long time = 0, orderId = 0, quantity = 0;
+    unsigned long long v;
+    for (int k = 0; k < rowCount; k++) {
+        int want = (rows == nullptr) ? k : rows[k];
+        if (want / HISTORY_GROUP_ROWS != group || want < row) {
+            group = want / HISTORY_GROUP_ROWS;
+            HistoryGroup g;
+            memcpy(&g, base + idBytes + (size_t)group * sizeof(HistoryGroup), sizeof(g));
+            src = base + g.offset;
+            time = g.baseTime;
+            orderId = g.baseOrderId;
+            row = group * HISTORY_GROUP_ROWS;
+        }
+        for (; row <= want; row++) {
+            src = readVarint(src, end, v);
+            time += (long long)v;
+            src = readVarint(src, end, v);
+            orderId += unzigzag(v);
+            src = readVarint(src, end, v);
+            quantity = unzigzag(v);
+        }
+
+        HistoryRecord r;
+        r.time = time;
+        r.orderId = (int)orderId;
+        memcpy(&r.productId, base + (size_t)want * sizeof(int), sizeof(int));
+        r.quantity = (int)quantity;
+        r.urgent = (bits[want / 8] >> (want % 8)) & 1;
+        out.push_back(r);
+    }
+}
+
+void OrderHistory::forProduct(int productId, vector<HistoryRecord>& out) const {
+    forProduct(productId, 0, lastTime, out);
+}
+
+void OrderHistory::forProduct(int productId, long long from, long long to, vector<HistoryRecord>& out) const {
+    unordered_map<int, vector<int>>::const_iterator it = postings.find(productId);
+    if (it == postings.end()) return;
+
+    vector<int> rows;
+    vector<HistoryRecord> decoded;
+    for (int block : it->second) {
+        if (block == (int)blocks.size()) break;   // The tail, scanned below
+        const HistoryBlock& b = blocks[block];
+        if (b.lastTime < from) continue;
+        if (b.firstTime > to) break;
+
+        // Fixed-width ID column: compare without decoding. Blocks start at any
+        // byte offset, so each ID is copied out rather than read through an int*
+        const unsigned char* ids = segments[b.segment].data() + b.offset;
+        rows.clear();
+        for (int i = 0; i < b.count; i++) {
+            int id;
+            memcpy(&id, ids + (size_t)i * sizeof(int), sizeof(int));
+            if (id == productId) rows.push_back(i);
+        }
+
+        decoded.clear();
+        decodeRows(block, rows.data(), (int)rows.size(), decoded);
+        for (const HistoryRecord& r : decoded) {
+            if (r.time >= from && r.time <= to) out.push_back(r);
+        }
+    }
+    for (const HistoryRecord& r : tail) {
+        if (r.productId == productId && r.time >= from && r.time <= to) out.push_back(r);
+    }
+}
+
+void OrderHistory::between(long long from, long long to, vector<HistoryRecord>& out) const {
+    if (from > to) return;
+
+    // First block that can hold a record at or after `from`
+    int lo = 0, hi = (int)blocks.size();
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (blocks[mid].lastTime < from) lo = mid + 1;
+        else hi = mid;
+    }
+
+    vector<HistoryRecord> decoded;
+    for (int block = lo; block < (int)blocks.size() && blocks[block].firstTime <= to; block++) {
+        decoded.clear();
+        decodeRows(block, nullptr, 0, decoded);
+        for (const HistoryRecord& r : decoded) {
+            if (r.time >= from && r.time <= to) out.push_back(r);
+        }
+    }
+    for (const HistoryRecord& r : tail) {
+        if (r.time >= from && r.time <= to) out.push_back(r);
+    }
+}
+
+long long OrderHistory::bytesUsed() const {
+    long long bytes = 0;
+    for (const vector<unsigned char>& segment : segments) bytes += (long long)segment.size();
+    bytes += (long long)blocks.size() * (long long)sizeof(HistoryBlock);
+    bytes += (long long)tail.capacity() * (long long)sizeof(HistoryRecord);
+    for (unordered_map<int, vector<int>>::const_iterator it = postings.begin(); it != postings.end(); ++it) {
+        bytes += (long long)(it->second.capacity() * sizeof(int)) + 32;
+    }
+    return bytes;
+}
@@ -0,0 +1,251 @@
+#include "../include/OrderPipeline.h"
+#include "../include/Colors.h"
+
+#ifdef WAREHOUSE_HAS_COROUTINES
+
+#include <chrono>
+
+using namespace Colors;
+
+void PipelineScheduler::expectRemote() {
+    lock_guard<mutex> guard(remoteLock);
+    remotePending++;
+}
+
+void PipelineScheduler::resumeFromThread(coroutine_handle<> h) {
+    {
+        lock_guard<mutex> guard(remoteLock);
+        remoteReady.push_back(h);
+        remotePending--;
+    }
+    remoteWake.notify_one();
+}
+
+// Stages parked on another thread are picked up once nothing local is ready;
+// the bounded channels keep the others from running far ahead meanwhile
+void PipelineScheduler::run() {
+    while (true) {
+        if (ready.empty()) {
+            unique_lock<mutex> guard(remoteLock);
+            remoteWake.wait(guard, [this]() { return !remoteReady.empty() || remotePending == 0; });
+            if (remoteReady.empty()) return;
+            for (coroutine_handle<> h : remoteReady) ready.push_back(h);
+            remoteReady.clear();
+        }
+        coroutine_handle<> h = ready.front();
+        ready.pop_front();
+        resumes++;
+        h.resume();
+    }
+}
+
+OrderPipeline::OrderPipeline(WarehouseSystem& warehouse, int capacity)
+    : system(warehouse),
+      channelCapacity(capacity > 0 ? capacity : PIPELINE_CHANNEL_CAP),
+      writerBusy(false),
+      writerStopping(false),
+      journalWaiting(nullptr),
+      activeScheduler(nullptr) {
+    writer = thread(writerLoop, this);
+}
+
+OrderPipeline::~OrderPipeline() {
+    {
+        lock_guard<mutex> guard(writerLock);
+        writerStopping = true;
+    }
+    writerWake.notify_all();
+    writer.join();
+}
+
+// Write handed-over batches to the export file and history, then wake the
+// journal stage if it is waiting to hand over the next one
+void OrderPipeline::writerLoop(OrderPipeline* self) {
+    while (true) {
+        {
+            unique_lock<mutex> guard(self->writerLock);
+            self->writerWake.wait(guard, [self]() { return self->writerBusy || self->writerStopping; });
+            if (!self->writerBusy) return;
+        }
+
+        OrderExporter* exporter = self->system.orderExporter;
+        OrderHistory* history = self->system.orderHistory;
+        for (size_t i = 0; i < self->writing.size(); i++) {
+            if (exporter != nullptr) exporter->append(self->writing[i]);
+            if (history != nullptr) history->append(self->writing[i], self->writingTimes[i]);
+        }
+
+        coroutine_handle<> waiting = nullptr;
+        PipelineScheduler* scheduler = nullptr;
+        {
+            lock_guard<mutex> guard(self->writerLock);
+            self->writerBusy = false;
+            waiting = self->journalWaiting;
+            scheduler = self->activeScheduler;
+            self->journalWaiting = nullptr;
+        }
+        self->writerWake.notify_all();
+        if (waiting) scheduler->resumeFromThread(waiting);
+    }
+}
+
+bool OrderPipeline::JournalHandOff::await_suspend(coroutine_handle<> h) {
+    lock_guard<mutex> guard(pipeline->writerLock);
+    if (!pipeline->writerBusy) return false;
+    pipeline->journalWaiting = h;
+    pipeline->activeScheduler->expectRemote();
+    pipeline->current.journalWaits++;
+    return true;
+}
+
+// The writer is idle: swap buffers so both sides keep their capacity
+void OrderPipeline::JournalHandOff::await_resume() {
+    {
+        lock_guard<mutex> guard(pipeline->writerLock);
+        pipeline->writing.swap(batch);
+        pipeline->writingTimes.swap(times);
+        pipeline->writerBusy = true;
+    }
+    pipeline->writerWake.notify_all();
+    batch.clear();
+    times.clear();
+    pipeline->current.journalBatches++;
+}
+
+void OrderPipeline::waitForWriter() {
+    unique_lock<mutex> guard(writerLock);
+    writerWake.wait(guard, [this]() { return !writerBusy; });
+}
+
+// Take orders off the queue and drop those that cannot succeed: unknown
+// products and orders above the current stock (stock only falls during a run)
+StageTask OrderPipeline::validate(int count, BoundedChannel<OrderInFlight>& out) {
+    for (int i = 0; i < count; i++) {
+        OrderInFlight f;
+        f.order = system.orderQueue.dequeue();
+        f.dequeuedAt = system.orderTracer != nullptr ? OrderTracer::now() : 0;
+        f.product = nullptr;
+        f.remaining = 0;
+        f.salesCount = 0;
+        if (soldOut.empty() || soldOut.count(f.order.productId) == 0) {
+            f.product = system.findProduct(f.order.productId);
+        }
+        if (f.product == nullptr) {
+            system.reportMissing(f.order);
+            system.traceOrder(f.order, f.dequeuedAt, false);
+            continue;
+        }
+        if (f.product->quantity < f.order.quantity) {
+            system.reportShortfall(f.order, f.product->quantity);
+            system.traceOrder(f.order, f.dequeuedAt, false);
+            continue;
+        }
+        co_await out.push(f);
+    }
+    out.close();
+}
+
+// The one place stock is decided: orders reach it in queue order
+StageTask OrderPipeline::reserve(BoundedChannel<OrderInFlight>& in, BoundedChannel<OrderInFlight>& out) {
+    OrderInFlight f;
+    while (co_await in.pop(f)) {
+        // Sold out by an earlier order: its product is (or is about to be) removed
+        if (!soldOut.empty() && soldOut.count(f.order.productId) != 0) {
+            system.reportMissing(f.order);
+            system.traceOrder(f.order, f.dequeuedAt, false);
+            continue;
+        }
+        Product* p = f.product;
+        if (p->quantity < f.order.quantity) {
+            system.reportShortfall(f.order, p->quantity);
+            system.traceOrder(f.order, f.dequeuedAt, false);
+            continue;
+        }
+        p->quantity -= f.order.quantity;
+        f.remaining = p->quantity;
+        if (f.remaining == 0) soldOut.insert(f.order.productId);
+        co_await out.push(f);
+    }
+    out.close();
+}
+
+StageTask OrderPipeline::fulfil(BoundedChannel<OrderInFlight>& in, BoundedChannel<OrderInFlight>& out) {
+    OrderInFlight f;
+    while (co_await in.pop(f)) {
+        f.product->salesCount += f.order.quantity;
+        f.salesCount = f.product->salesCount;
+        system.recordSale(f.order, f.remaining, f.salesCount);
+        co_await out.push(f);
+    }
+    out.close();
+}
+
+StageTask OrderPipeline::rank(BoundedChannel<OrderInFlight>& in, BoundedChannel<OrderInFlight>& out) {
+    OrderInFlight f;
+    while (co_await in.pop(f)) {
+        system.updateRankings(f.order.productId, f.salesCount);
+        co_await out.push(f);
+    }
+    out.close();
+}
+
+// Export and history writes go to the writer thread in batches; removal of
+// sold-out products and the status line stay here
+StageTask OrderPipeline::journal(BoundedChannel<OrderInFlight>& in) {
+    bool journaling = system.orderExporter != nullptr || system.orderHistory != nullptr;
+    vector<Order> batch;
+    vector<long long> times;
+    OrderInFlight f;
+    while (co_await in.pop(f)) {
+        if (journaling) {
+            batch.push_back(f.order);
+            times.push_back(chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count());
+            if ((int)batch.size() >= PIPELINE_JOURNAL_BATCH) co_await handOff(batch, times);
+        }
+        current.fulfilled++;
+        system.finishOrder(f.order, f.product, f.remaining, f.salesCount);
+        system.traceOrder(f.order, f.dequeuedAt, true);
+    }
+    if (!batch.empty()) co_await handOff(batch, times);
+}
+
+int OrderPipeline::run(int limit) {
+    current = PipelineStats();
+    int n = system.orderQueue.getSize();
+    if (limit >= 0 && limit < n) n = limit;
+    if (n == 0) {
+        if (system.verbose) cout << Theme::INFO << "No orders to process." << RESET << endl;
+        return 0;
+    }
+    current.orders = n;
+
+    PipelineScheduler scheduler;
+    activeScheduler = &scheduler;
+    BoundedChannel<OrderInFlight> toReserve(scheduler, channelCapacity);
+    BoundedChannel<OrderInFlight> toFulfil(scheduler, channelCapacity);
+    BoundedChannel<OrderInFlight> toRank(scheduler, channelCapacity);
+    BoundedChannel<OrderInFlight> toJournal(scheduler, channelCapacity);
+
+    StageTask stages[] = {
+        validate(n, toReserve),
+        reserve(toReserve, toFulfil),
+        fulfil(toFulfil, toRank),
+        rank(toRank, toJournal),
+        journal(toJournal),
+    };
+    for (StageTask& stage : stages) scheduler.schedule(stage.handle);
+    scheduler.run();
+    waitForWriter();
+    activeScheduler = nullptr;
+    soldOut.clear();
+
+    BoundedChannel<OrderInFlight>* channels[] = {&toReserve, &toFulfil, &toRank, &toJournal};
+    for (BoundedChannel<OrderInFlight>* ch : channels) {
+        current.backpressure += ch->fullWaits;
+        if (ch->maxDepth > current.maxChannelDepth) current.maxChannelDepth = ch->maxDepth;
+    }
+    current.resumes = scheduler.resumes;
+    return current.fulfilled;
+}
+
+#endif
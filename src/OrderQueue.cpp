@@ -1,39 +1,56 @@
 #include "../include/OrderQueue.h"
 
 // Constructor
-OrderQueue::OrderQueue() {
+OrderQueue::OrderQueue(int initialCapacity) {
+    capacity = initialCapacity > 0 ? initialCapacity : ORDER_QUEUE_INITIAL_CAP;
+    orders = new Order[capacity];
     front = 0;
-    rear = -1;
     size = 0;
 }
 
+OrderQueue::~OrderQueue() {
+    delete[] orders;
+}
+
+// Double the buffer, unwrapping the pending orders to the start
+void OrderQueue::grow() {
+    reserve(capacity * 2);
+}
+
+void OrderQueue::reserve(int n) {
+    if (n <= capacity) return;
+
+    Order* bigger = new Order[n];
+    for (int i = 0; i < size; i++) {
+        bigger[i] = orders[(front + i) % capacity];
+    }
+    delete[] orders;
+    orders = bigger;
+    capacity = n;
+    front = 0;
+}
+
 // Check if queue is empty
 bool OrderQueue::isEmpty() {
     return size == 0;
 }
 
-// Check if queue is full
-bool OrderQueue::isFull() {
-    return size == MAX_ORDERS;
+int OrderQueue::getSize() {
+    return size;
 }
 
 // Add order to the queue
-void OrderQueue::enqueue(Order o) {
-    if (isFull()) {
-        cout << "Order queue is full!\n";
-        return;
+void OrderQueue::enqueue(const Order& o) {
+    if (size == capacity) {
+        grow();
     }
 
     if (o.urgent) {
         // Place urgent orders at the front
-        for (int i = size; i > 0; i--) {
-            orders[i] = orders[i-1];
-        }
-        orders[0] = o;
-        rear++;
+        front = (front - 1 + capacity) % capacity;
+        orders[front] = o;
     } else {
-        rear = (rear + 1) % MAX_ORDERS;
-        orders[rear] = o;
+        orders[(front + size) % capacity] = o;
     }
     size++;
 }
@@ -45,20 +62,26 @@ Order OrderQueue::dequeue() {
         return Order();
     }
     Order o = orders[front];
-    front = (front + 1) % MAX_ORDERS;
+    front = (front + 1) % capacity;
     size--;
     return o;
 }
 
 // Peek at the front order
-Order OrderQueue::peek() {
+const Order& OrderQueue::peek() {
+    static const Order none;
     if (isEmpty()) {
         cout << "Order queue is empty!\n";
-        return Order();
+        return none;
     }
     return orders[front];
 }
 
+// Pending order by position (caller keeps i < getSize())
+const Order& OrderQueue::at(int i) {
+    return orders[(front + i) % capacity];
+}
+
 // Print queue for debugging
 void OrderQueue::printQueue() {
     cout << "Order Queue: ";
@@ -66,7 +89,7 @@ void OrderQueue::printQueue() {
     int idx = front;
     while (count--) {
         cout << "(" << orders[idx].productId << "," << orders[idx].quantity << ")";
-        idx = (idx + 1) % MAX_ORDERS;
+        idx = (idx + 1) % capacity;
         if (count) cout << " <- ";
     }
     cout << endl;
@@ -0,0 +1,157 @@
+#include "../include/OrderTracing.h"
+#include "../include/Colors.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+using namespace Colors;
+
+LatencyHistogram::LatencyHistogram() {
+    clear();
+}
+
+void LatencyHistogram::clear() {
+    memset(counts, 0, sizeof(counts));
+    total = 0;
+    sum = 0;
+    maxValue = 0;
+}
+
+// Below 2^SUB_BITS the value is its own bucket; above, the exponent picks a
+// group of 2^SUB_BITS buckets and the next SUB_BITS bits below the top one pick
+// the bucket inside it
+int LatencyHistogram::bucketOf(long long ns) {
+    unsigned long long v = ns < 0 ? 0 : (unsigned long long)ns;
+    if (v < (1ULL << LATENCY_SUB_BITS)) return (int)v;
+    int exponent = 63 - __builtin_clzll(v);
+    int sub = (int)((v >> (exponent - LATENCY_SUB_BITS)) & ((1ULL << LATENCY_SUB_BITS) - 1));
+    return ((exponent - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS) + sub;
+}
+
+long long LatencyHistogram::bucketLow(int bucket) {
+    if (bucket < (1 << LATENCY_SUB_BITS)) return bucket;
+    int exponent = (bucket >> LATENCY_SUB_BITS) + LATENCY_SUB_BITS - 1;
+    long long sub = bucket & ((1 << LATENCY_SUB_BITS) - 1);
+    return ((1LL << LATENCY_SUB_BITS) + sub) << (exponent - LATENCY_SUB_BITS);
+}
+
+void LatencyHistogram::record(long long ns) {
+    if (ns < 0) ns = 0;
+    counts[bucketOf(ns)]++;
+    total++;
+    sum += ns;
+    if (ns > maxValue) maxValue = ns;
+}
+
+long long LatencyHistogram::percentile(double q) const {
+    if (total == 0) return 0;
+    long long rank = (long long)(q * (double)total);
+    if (rank >= total) rank = total - 1;
+    long long seenCount = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        seenCount += counts[b];
+        if (seenCount > rank) {
+            long long low = bucketLow(b);
+            long long high = b + 1 < LATENCY_BUCKETS ? bucketLow(b + 1) : maxValue;
+            long long mid = low + (high - low) / 2;
+            return mid < maxValue ? mid : maxValue;
+        }
+    }
+    return maxValue;
+}
+
+OrderTracer::OrderTracer(int sampleEveryN) : failed(0), sampleEvery(sampleEveryN), seen(0) {
+    if (sampleEvery > 0) samples.reserve(TRACE_MAX_SAMPLES);
+}
+
+long long OrderTracer::now() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void OrderTracer::record(const Order& o, long long dequeuedAt, long long completedAt, bool fulfilled) {
+    int lane = o.urgent ? 1 : 0;
+    if (o.placedAt != 0) waits[lane].record(dequeuedAt - o.placedAt);
+    if (fulfilled) services[lane].record(completedAt - dequeuedAt);
+    else failed++;
+
+    if (sampleEvery > 0 && seen++ % sampleEvery == 0 && samples.size() < TRACE_MAX_SAMPLES) {
+        TraceSample s;
+        s.orderId = o.orderId;
+        s.productId = o.productId;
+        s.quantity = o.quantity;
+        s.urgent = o.urgent;
+        s.fulfilled = fulfilled;
+        s.placedAt = o.placedAt;
+        s.dequeuedAt = dequeuedAt;
+        s.completedAt = completedAt;
+        samples.push_back(s);
+    }
+}
+
+void OrderTracer::clear() {
+    for (int lane = 0; lane < 2; lane++) {
+        waits[lane].clear();
+        services[lane].clear();
+    }
+    failed = 0;
+    seen = 0;
+    samples.clear();
+}
+
+static void printHistogramRow(const char* label, const LatencyHistogram& h) {
+    if (h.count() == 0) {
+        printf("  %-16s (no samples)\n", label);
+        return;
+    }
+    printf("  %-16s n %9lld  p50 %9.2f  p90 %9.2f  p99 %9.2f  p99.9 %9.2f  max %9.2f us\n", label, h.count(),
+           h.percentile(0.50) / 1e3, h.percentile(0.90) / 1e3, h.percentile(0.99) / 1e3,
+           h.percentile(0.999) / 1e3, h.max() / 1e3);
+}
+
+void OrderTracer::printSummary() const {
+    cout << Theme::HEADER << "Order lifecycle (wall clock)" << RESET << endl;
+    printHistogramRow("wait regular", waits[0]);
+    printHistogramRow("wait urgent", waits[1]);
+    printHistogramRow("service regular", services[0]);
+    printHistogramRow("service urgent", services[1]);
+    if (failed > 0) printf("  %lld orders failed at processing\n", failed);
+}
+
+// Async begin/end pairs keyed by order ID: queue waits overlap one another,
+// which complete ("X") events on one thread track cannot show. Times are in
+// microseconds from the first sampled placement.
+bool OrderTracer::writeChromeTrace(const string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) return false;
+
+    long long origin = 0;
+    for (const TraceSample& s : samples) {
+        long long first = s.placedAt != 0 ? s.placedAt : s.dequeuedAt;
+        if (origin == 0 || first < origin) origin = first;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool firstEvent = true;
+    for (const TraceSample& s : samples) {
+        const char* lane = s.urgent ? "urgent" : "regular";
+        char args[128];
+        snprintf(args, sizeof(args), "{\"order\":%d,\"product\":%d,\"qty\":%d,\"fulfilled\":%s}",
+                 s.orderId, s.productId, s.quantity, s.fulfilled ? "true" : "false");
+        if (s.placedAt != 0) {
+            fprintf(file, "%s{\"name\":\"queued\",\"cat\":\"%s\",\"ph\":\"b\",\"id\":%d,\"pid\":1,\"tid\":1,\"ts\":%.3f,\"args\":%s},\n",
+                    firstEvent ? "" : ",\n", lane, s.orderId, (s.placedAt - origin) / 1e3, args);
+            fprintf(file, "{\"name\":\"queued\",\"cat\":\"%s\",\"ph\":\"e\",\"id\":%d,\"pid\":1,\"tid\":1,\"ts\":%.3f}",
+                    lane, s.orderId, (s.dequeuedAt - origin) / 1e3);
+            firstEvent = false;
+        }
+        fprintf(file, "%s{\"name\":\"service\",\"cat\":\"%s\",\"ph\":\"b\",\"id\":%d,\"pid\":1,\"tid\":1,\"ts\":%.3f,\"args\":%s},\n",
+                firstEvent ? "" : ",\n", lane, s.orderId, (s.dequeuedAt - origin) / 1e3, args);
+        fprintf(file, "{\"name\":\"service\",\"cat\":\"%s\",\"ph\":\"e\",\"id\":%d,\"pid\":1,\"tid\":1,\"ts\":%.3f}",
+                lane, s.orderId, (s.completedAt - origin) / 1e3);
+        firstEvent = false;
+    }
+    fprintf(file, "\n]}\n");
+    bool ok = !ferror(file);
+    return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,88 @@
+#include "../include/PriceIndex.h"
+#include <algorithm>
+
+PriceIndex::PriceIndex() : size(0) {}
+
+int PriceIndex::blockFor(const PriceKey& key) const {
+    return (int)(lower_bound(lastKeys.begin(), lastKeys.end(), key) - lastKeys.begin());
+}
+
+void PriceIndex::insert(double price, int id) {
+    PriceKey key(price, id);
+    if (blocks.empty()) {
+        blocks.push_back(vector<PriceKey>());
+        blocks.back().reserve(2 * PRICE_INDEX_BLOCK);
+        blocks.back().push_back(key);
+        lastKeys.push_back(key);
+        size++;
+        return;
+    }
+
+    // Past the last key goes to the last block
+    int b = min(blockFor(key), (int)blocks.size() - 1);
+    vector<PriceKey>& block = blocks[b];
+    vector<PriceKey>::iterator pos = lower_bound(block.begin(), block.end(), key);
+    if (pos != block.end() && *pos == key) return;
+    block.insert(pos, key);
+    lastKeys[b] = block.back();
+    size++;
+
+    // Split a full block in half
+    if ((int)block.size() >= 2 * PRICE_INDEX_BLOCK) {
+        vector<PriceKey> upper(block.begin() + PRICE_INDEX_BLOCK, block.end());
+        upper.reserve(2 * PRICE_INDEX_BLOCK);
+        block.resize(PRICE_INDEX_BLOCK);
+        lastKeys[b] = block.back();
+        blocks.insert(blocks.begin() + b + 1, std::move(upper));
+        lastKeys.insert(lastKeys.begin() + b + 1, blocks[b + 1].back());
+    }
+}
+
+bool PriceIndex::remove(double price, int id) {
+    PriceKey key(price, id);
+    int b = blockFor(key);
+    if (b >= (int)blocks.size()) return false;
+
+    vector<PriceKey>& block = blocks[b];
+    vector<PriceKey>::iterator pos = lower_bound(block.begin(), block.end(), key);
+    if (pos == block.end() || !(*pos == key)) return false;
+    block.erase(pos);
+    size--;
+
+    if (block.empty()) {
+        blocks.erase(blocks.begin() + b);
+        lastKeys.erase(lastKeys.begin() + b);
+        return true;
+    }
+    lastKeys[b] = block.back();
+
+    // Fold a small block into its right neighbour when both fit in one
+    if (b + 1 < (int)blocks.size() && (int)(block.size() + blocks[b + 1].size()) < PRICE_INDEX_BLOCK) {
+        vector<PriceKey>& next = blocks[b + 1];
+        next.insert(next.begin(), block.begin(), block.end());
+        blocks.erase(blocks.begin() + b);
+        lastKeys.erase(lastKeys.begin() + b);
+    }
+    return true;
+}
+
+void PriceIndex::update(int id, double oldPrice, double newPrice) {
+    if (oldPrice == newPrice) return;
+    if (remove(oldPrice, id)) insert(newPrice, id);
+}
+
+void PriceIndex::range(double lo, double hi, int limit, vector<PriceKey>& out) const {
+    if (lo > hi) return;
+    PriceKey first(lo, -2147483647 - 1);
+    int found = 0;
+    for (int b = blockFor(first); b < (int)blocks.size(); b++) {
+        const vector<PriceKey>& block = blocks[b];
+        vector<PriceKey>::const_iterator it = block.begin();
+        if (block.front() < first) it = lower_bound(block.begin(), block.end(), first);
+        for (; it != block.end(); ++it) {
+            if (it->price > hi) return;
+            out.push_back(*it);
+            if (limit > 0 && ++found == limit) return;
+        }
+    }
+}
@@ -0,0 +1,269 @@
+#include "../include/ProductColumns.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// ---------- SelectionBitmap ----------
+
+SelectionBitmap::SelectionBitmap(int rowCount, bool set)
+    : words((size_t)(rowCount + 63) / 64, set ? ~0ULL : 0ULL), rows(rowCount) {
+    clearTail();
+}
+
+void SelectionBitmap::clearTail() {
+    if (rows % 64 != 0 && !words.empty()) {
+        words.back() &= (1ULL << (rows % 64)) - 1;
+    }
+}
+
+int SelectionBitmap::count() const {
+    int total = 0;
+    for (unsigned long long w : words) total += __builtin_popcountll(w);
+    return total;
+}
+
+SelectionBitmap& SelectionBitmap::operator&=(const SelectionBitmap& other) {
+    for (size_t i = 0; i < words.size(); i++) {
+        words[i] &= (i < other.words.size()) ? other.words[i] : 0ULL;
+    }
+    return *this;
+}
+
+SelectionBitmap& SelectionBitmap::operator|=(const SelectionBitmap& other) {
+    for (size_t i = 0; i < words.size() && i < other.words.size(); i++) {
+        words[i] |= other.words[i];
+    }
+    return *this;
+}
+
+SelectionBitmap& SelectionBitmap::andNot(const SelectionBitmap& other) {
+    for (size_t i = 0; i < words.size() && i < other.words.size(); i++) {
+        words[i] &= ~other.words[i];
+    }
+    return *this;
+}
+
+// ---------- scan kernels ----------
+// Each kernel fills one bitmap word from 64 consecutive values.
+
+// lo <= v <= hi, computed as NOT (lo > v OR v > hi) so no bound overflows
+static unsigned long long intRangeWord(const int* v, int lo, int hi) {
+    unsigned long long outside = 0;
+#if defined(__AVX2__)
+    __m256i l = _mm256_set1_epi32(lo), h = _mm256_set1_epi32(hi);
+    for (int i = 0; i < 64; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(v + i));
+        __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(l, x), _mm256_cmpgt_epi32(x, h));
+        outside |= (unsigned long long)(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(out)) << i;
+    }
+#elif defined(__SSE2__)
+    __m128i l = _mm_set1_epi32(lo), h = _mm_set1_epi32(hi);
+    for (int i = 0; i < 64; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(v + i));
+        __m128i out = _mm_or_si128(_mm_cmpgt_epi32(l, x), _mm_cmpgt_epi32(x, h));
+        outside |= (unsigned long long)(unsigned)_mm_movemask_ps(_mm_castsi128_ps(out)) << i;
+    }
+#else
+    for (int i = 0; i < 64; i++) {
+        if (v[i] < lo || v[i] > hi) outside |= 1ULL << i;
+    }
+#endif
+    return ~outside;
+}
+
+static unsigned long long intEqualWord(const int* v, int key) {
+    unsigned long long equal = 0;
+#if defined(__AVX2__)
+    __m256i k = _mm256_set1_epi32(key);
+    for (int i = 0; i < 64; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(v + i));
+        equal |= (unsigned long long)(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, k))) << i;
+    }
+#elif defined(__SSE2__)
+    __m128i k = _mm_set1_epi32(key);
+    for (int i = 0; i < 64; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(v + i));
+        equal |= (unsigned long long)(unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, k))) << i;
+    }
+#else
+    for (int i = 0; i < 64; i++) {
+        if (v[i] == key) equal |= 1ULL << i;
+    }
+#endif
+    return equal;
+}
+
+static unsigned long long doubleRangeWord(const double* v, double lo, double hi) {
+    unsigned long long inside = 0;
+#if defined(__AVX2__)
+    __m256d l = _mm256_set1_pd(lo), h = _mm256_set1_pd(hi);
+    for (int i = 0; i < 64; i += 4) {
+        __m256d x = _mm256_loadu_pd(v + i);
+        __m256d in = _mm256_and_pd(_mm256_cmp_pd(x, l, _CMP_GE_OQ), _mm256_cmp_pd(x, h, _CMP_LE_OQ));
+        inside |= (unsigned long long)(unsigned)_mm256_movemask_pd(in) << i;
+    }
+#elif defined(__SSE2__)
+    __m128d l = _mm_set1_pd(lo), h = _mm_set1_pd(hi);
+    for (int i = 0; i < 64; i += 2) {
+        __m128d x = _mm_loadu_pd(v + i);
+        __m128d in = _mm_and_pd(_mm_cmpge_pd(x, l), _mm_cmple_pd(x, h));
+        inside |= (unsigned long long)(unsigned)_mm_movemask_pd(in) << i;
+    }
+#else
+    for (int i = 0; i < 64; i++) {
+        if (v[i] >= lo && v[i] <= hi) inside |= 1ULL << i;
+    }
+#endif
+    return inside;
+}
+
+// Full words through the kernel, the last partial word row by row
+template <typename T, typename Kernel, typename Row>
+static SelectionBitmap scanColumn(const vector<T>& column, Kernel kernel, Row row) {
+    int n = (int)column.size();
+    SelectionBitmap result(n);
+    unsigned long long* words = result.data();
+    int full = n / 64;
+    for (int w = 0; w < full; w++) {
+        words[w] = kernel(column.data() + (size_t)w * 64);
+    }
+    for (int i = full * 64; i < n; i++) {
+        if (row(column[i])) words[full] |= 1ULL << (i - full * 64);
+    }
+    return result;
+}
+
+// ---------- ProductColumns ----------
+
+int ProductColumns::categoryId(const string& name) {
+    unordered_map<string, int>::iterator it = categoryIds.find(name);
+    if (it != categoryIds.end()) return it->second;
+    int id = (int)categoryNames.size();
+    categoryNames.push_back(name);
+    categoryIds[name] = id;
+    return id;
+}
+
+void ProductColumns::reserve(int rowCount) {
+    ids.reserve(rowCount);
+    quantities.reserve(rowCount);
+    prices.reserve(rowCount);
+    sales.reserve(rowCount);
+    categories.reserve(rowCount);
+    rowOf.reserve(rowCount);
+}
+
+// Insert or replace a product's row
+void ProductColumns::put(const Product& p) {
+    int category = categoryId(p.category);
+    unordered_map<int, int>::iterator it = rowOf.find(p.id);
+    if (it != rowOf.end()) {
+        int row = it->second;
+        quantities[row] = p.quantity;
+        prices[row] = p.price;
+        sales[row] = p.salesCount;
+        categories[row] = category;
+        return;
+    }
+    rowOf[p.id] = (int)ids.size();
+    ids.push_back(p.id);
+    quantities.push_back(p.quantity);
+    prices.push_back(p.price);
+    sales.push_back(p.salesCount);
+    categories.push_back(category);
+}
+
+// Move the last row into the erased one so the columns stay dense
+void ProductColumns::erase(int productId) {
+    unordered_map<int, int>::iterator it = rowOf.find(productId);
+    if (it == rowOf.end()) return;
+    int row = it->second;
+    int last = (int)ids.size() - 1;
+    rowOf.erase(it);
+    if (row != last) {
+        ids[row] = ids[last];
+        quantities[row] = quantities[last];
+        prices[row] = prices[last];
+        sales[row] = sales[last];
+        categories[row] = categories[last];
+        rowOf[ids[row]] = row;
+    }
+    ids.pop_back();
+    quantities.pop_back();
+    prices.pop_back();
+    sales.pop_back();
+    categories.pop_back();
+}
+
+void ProductColumns::setCounts(int productId, int quantity, int salesCount) {
+    unordered_map<int, int>::iterator it = rowOf.find(productId);
+    if (it == rowOf.end()) return;
+    quantities[it->second] = quantity;
+    sales[it->second] = salesCount;
+}
+
+void ProductColumns::setPrice(int productId, double price) {
+    unordered_map<int, int>::iterator it = rowOf.find(productId);
+    if (it == rowOf.end()) return;
+    prices[it->second] = price;
+}
+
+SelectionBitmap ProductColumns::categoryEquals(const string& category) const {
+    unordered_map<string, int>::const_iterator it = categoryIds.find(category);
+    if (it == categoryIds.end()) return SelectionBitmap(size());
+    int key = it->second;
+    return scanColumn(categories, [key](const int* v) { return intEqualWord(v, key); },
+                      [key](int v) { return v == key; });
+}
+
+SelectionBitmap ProductColumns::quantityBetween(int lo, int hi) const {
+    return scanColumn(quantities, [lo, hi](const int* v) { return intRangeWord(v, lo, hi); },
+                      [lo, hi](int v) { return v >= lo && v <= hi; });
+}
+
+SelectionBitmap ProductColumns::salesBetween(int lo, int hi) const {
+    return scanColumn(sales, [lo, hi](const int* v) { return intRangeWord(v, lo, hi); },
+                      [lo, hi](int v) { return v >= lo && v <= hi; });
+}
+
+SelectionBitmap ProductColumns::priceBetween(double lo, double hi) const {
+    return scanColumn(prices, [lo, hi](const double* v) { return doubleRangeWord(v, lo, hi); },
+                      [lo, hi](double v) { return v >= lo && v <= hi; });
+}
+
+// Scan only the bounded predicates and AND their bitmaps
+SelectionBitmap ProductColumns::select(const ProductFilter& filter) const {
+    SelectionBitmap result(size(), true);
+    if (!filter.category.empty()) result &= categoryEquals(filter.category);
+    if (filter.minQuantity != INT_MIN || filter.maxQuantity != INT_MAX) {
+        result &= quantityBetween(filter.minQuantity, filter.maxQuantity);
+    }
+    if (filter.minPrice != -DBL_MAX || filter.maxPrice != DBL_MAX) {
+        result &= priceBetween(filter.minPrice, filter.maxPrice);
+    }
+    if (filter.minSales != INT_MIN || filter.maxSales != INT_MAX) {
+        result &= salesBetween(filter.minSales, filter.maxSales);
+    }
+    return result;
+}
+
+vector<int> ProductColumns::idsOf(const SelectionBitmap& selection) const {
+    vector<int> out;
+    out.reserve(selection.count());
+    selection.forEach([this, &out](int row) {
+        if (row < (int)ids.size()) out.push_back(ids[row]);
+    });
+    return out;
+}
+
+bool ProductColumns::holds(const Product& p) const {
+    unordered_map<int, int>::const_iterator it = rowOf.find(p.id);
+    if (it == rowOf.end()) return false;
+    int row = it->second;
+    return ids[row] == p.id && quantities[row] == p.quantity && prices[row] == p.price
+        && sales[row] == p.salesCount && categoryNames[categories[row]] == p.category;
+}
@@ -0,0 +1,211 @@
+#include "../include/TraceReplayer.h"
+#include "../include/Checkpointer.h"
+#include "../include/Colors.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using namespace Colors;
+
+bool ReplayConfig::set(const string& key, const string& value) {
+    if (key == "trace") tracePath = value;
+    else if (key == "checkpoint") checkpointPath = value;
+    else if (key == "speed") speed = atof(value.c_str());
+    else if (key == "workers") workers = atoi(value.c_str());
+    else if (key == "heaps" && value == "tombstones") heapPolicy = HEAP_TOMBSTONES;
+    else if (key == "heaps" && value == "hard") heapPolicy = HEAP_HARD_DELETE;
+    else return false;
+    return true;
+}
+
+TraceReplayer::TraceReplayer(const ReplayConfig& cfg) : config(cfg), placed(0), rejected(0), fulfilled(0), failed(0) {}
+
+void TraceReplayer::apply(WarehouseSystem& warehouse, WorkStealingPool* pool, WavePlanner& waves, const TraceRecord& r) {
+    SalesEntry entry;
+    switch (r.op) {
+    case TRACE_ADD:
+        warehouse.addProduct(r.product);
+        break;
+    case TRACE_REMOVE:
+        warehouse.removeProduct((int)r.args[0]);
+        break;
+    case TRACE_STOCK:
+        warehouse.updateStock((int)r.args[0], (int)r.args[1]);
+        break;
+    case TRACE_PRICE:
+        warehouse.updatePrice((int)r.args[0], r.lo);
+        break;
+    case TRACE_SEARCH:
+        warehouse.searchProduct((int)r.args[0]);
+        break;
+    case TRACE_FREEZE:
+        warehouse.freezeCatalog();
+        break;
+    case TRACE_LIST:
+        warehouse.listProducts(r.listing);
+        break;
+    case TRACE_FILTER:
+        warehouse.filterProducts(r.filter);
+        break;
+    case TRACE_FILTER_IDS:
+        warehouse.filterProductIds(r.filter);
+        break;
+    case TRACE_PRICE_RANGE:
+        warehouse.productsInPriceRange(r.lo, r.hi, (int)r.args[0]);
+        break;
+    case TRACE_CHEAPEST:
+        warehouse.cheapestInStock((int)r.args[0]);
+        break;
+    case TRACE_NAME_SEARCH:
+        warehouse.searchByName(r.text, (int)r.args[0]);
+        break;
+    case TRACE_ORDER:
+        if (warehouse.placeOrder((int)r.args[0], (int)r.args[1], r.args[2] != 0) != 0) placed++;
+        else rejected++;
+        break;
+    case TRACE_PROCESS: {
+        bool queued = warehouse.pendingOrderCount() > 0;
+        if (warehouse.processNextOrder()) fulfilled++;
+        else if (queued) failed++;
+        break;
+    }
+    case TRACE_PROCESS_BATCH: {
+        // Without a pool the batch goes through processNextOrder, with the same outcome
+        int n = warehouse.pendingOrderCount();
+        if (r.args[0] >= 0 && r.args[0] < n) n = (int)r.args[0];
+        int done = 0;
+        if (pool != nullptr) {
+            done = warehouse.processOrdersParallel(*pool, n);
+        } else {
+            for (int i = 0; i < n; i++) {
+                if (warehouse.processNextOrder()) done++;
+            }
+        }
+        fulfilled += done;
+        failed += n - done;
+        break;
+    }
+    case TRACE_SNAPSHOT:
+        warehouse.takeSnapshot();
+        break;
+    case TRACE_LOWEST:
+        warehouse.lowestSelling(entry);
+        break;
+    case TRACE_BEST:
+        warehouse.bestSelling(entry);
+        break;
+    case TRACE_HEAP_POLICY:
+        warehouse.setHeapPolicy((HeapPolicy)r.args[0]);
+        break;
+    case TRACE_COMPACT:
+        warehouse.compactHeaps();
+        break;
+    case TRACE_RESTORE_ORDERS:
+        warehouse.restorePendingOrders(r.orders, (int)r.args[0]);
+        break;
+    case TRACE_WAVE: {
+        // Only committed waves are recorded; planned against the same queue, this one commits too
+        int n = waves.plan((int)r.args[0]);
+        int done = waves.commit();
+        if (done >= 0) {
+            fulfilled += done;
+            failed += n - done;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void printLatencyRow(const char* label, const LatencyHistogram& h) {
+    printf("  %-15s %10lld  p50 %9.2f  p99 %9.2f  p99.9 %9.2f  max %10.2f us  total %9.1f ms\n", label, h.count(),
+           h.percentile(0.50) / 1e3, h.percentile(0.99) / 1e3, h.percentile(0.999) / 1e3, h.max() / 1e3,
+           h.mean() * (double)h.count() / 1e6);
+}
+
+void TraceReplayer::printReport(long long records, long long recordedNs, double replaySeconds) {
+    cout << Theme::HEADER << "Replayed " << records << " calls: recorded over " << recordedNs / 1e9
+         << " s, replayed in " << replaySeconds << " s" << RESET << endl;
+    for (int op = 1; op < TRACE_OP_KINDS; op++) {
+        if (latency[op].count() > 0) printLatencyRow(traceOpName(op), latency[op]);
+    }
+    if (lateness.count() > 0) {
+        printf("  %-15s %10lld  p50 %9.2f  p99 %9.2f  p99.9 %9.2f  max %10.2f us (start behind schedule)\n", "lag",
+               lateness.count(), lateness.percentile(0.50) / 1e3, lateness.percentile(0.99) / 1e3,
+               lateness.percentile(0.999) / 1e3, lateness.max() / 1e3);
+    }
+    printf("  orders placed %lld, rejected %lld; fulfilled %lld, failed %lld\n", placed, rejected, fulfilled, failed);
+}
+
+int TraceReplayer::run() {
+    if (config.tracePath.empty()) {
+        cout << Theme::ERR << "Usage: warehouse replay trace=<file> [checkpoint=<file>] [speed=S] [workers=N] [heaps=tombstones]" << RESET << endl;
+        return 1;
+    }
+    TraceReader reader;
+    if (!reader.open(config.tracePath)) {
+        cout << Theme::ERR << "Could not read trace " << config.tracePath << RESET << endl;
+        return 1;
+    }
+
+    WarehouseSystem warehouse(1000, 1000, 16);
+    warehouse.setVerbose(false);
+    warehouse.setHeapPolicy(config.heapPolicy);
+
+    // The serve recorder leaves its starting state next to the trace
+    string checkpoint = config.checkpointPath;
+    if (checkpoint.empty()) {
+        FILE* start = fopen((config.tracePath + ".start").c_str(), "rb");
+        if (start != nullptr) {
+            fclose(start);
+            checkpoint = config.tracePath + ".start";
+        }
+    }
+    if (!checkpoint.empty()) {
+        if (!Checkpointer::load(checkpoint, warehouse)) {
+            cout << Theme::ERR << "Could not read checkpoint " << checkpoint << RESET << endl;
+            return 1;
+        }
+        cout << Theme::INFO << "Starting from " << warehouse.productCount() << " products and "
+             << warehouse.pendingOrderCount() << " pending orders (" << checkpoint << ")" << RESET << endl;
+    }
+
+    WorkStealingPool* pool = config.workers > 0 ? new WorkStealingPool(config.workers) : nullptr;
+    WavePlanner waves(warehouse);
+    cout << Theme::INFO << "Replaying " << config.tracePath << " (" << reader.size() << " bytes) ";
+    if (config.speed > 0) cout << "at " << config.speed << "x the recorded pace";
+    else cout << "as fast as possible";
+    cout << RESET << endl;
+
+    TraceRecord r;
+    long long records = 0;
+    long long recordedNs = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (reader.next(r)) {
+        if (config.speed > 0) {
+            chrono::steady_clock::time_point due = start + chrono::nanoseconds((long long)((double)r.at / config.speed));
+            // Sleeps overshoot by tens of microseconds, so the last stretch is spun
+            chrono::steady_clock::time_point wake = due - chrono::nanoseconds(REPLAY_SPIN_NS);
+            if (chrono::steady_clock::now() < wake) this_thread::sleep_until(wake);
+            while (chrono::steady_clock::now() < due) {}
+            lateness.record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - due).count());
+        }
+        chrono::steady_clock::time_point callStart = chrono::steady_clock::now();
+        apply(warehouse, pool, waves, r);
+        latency[r.op].record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - callStart).count());
+        records++;
+        recordedNs = r.at;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    delete pool;
+
+    printReport(records, recordedNs, seconds);
+    cout << Theme::INFO << "Ended with " << warehouse.productCount() << " products and "
+         << warehouse.pendingOrderCount() << " pending orders." << RESET << endl;
+    if (reader.damaged()) {
+        cout << Theme::WARNING << "The trace ends in a damaged or partial call; replayed up to it." << RESET << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "../include/VersionedCatalog.h"
+
+// Start with an empty, unshared page table
+VersionedCatalog::VersionedCatalog() : current(make_shared<CatalogPageTable>()), slotCount(0), version(0) {}
+
+// Copy-on-write: a page table or page referenced by a snapshot is cloned before
+// the first write, so the snapshot keeps seeing the old contents
+Product* VersionedCatalog::writableSlot(int slot, bool** usedFlag) {
+    if (current.use_count() > 1) {
+        current = make_shared<CatalogPageTable>(*current);
+    }
+
+    int pageIndex = slot / CATALOG_PAGE_SIZE;
+    int offset = slot % CATALOG_PAGE_SIZE;
+
+    while ((int)current->pages.size() <= pageIndex) {
+        current->pages.push_back(make_shared<CatalogPage>());
+    }
+
+    shared_ptr<CatalogPage>& page = current->pages[pageIndex];
+    if (page.use_count() > 1) {
+        page = make_shared<CatalogPage>(*page);
+    }
+
+    *usedFlag = &page->used[offset];
+    return &page->slots[offset];
+}
+
+// Insert or replace a product
+void VersionedCatalog::put(const Product& p) {
+    lock_guard<mutex> guard(publishLock);
+
+    int slot;
+    unordered_map<int, int>::iterator it = slotOf.find(p.id);
+    if (it != slotOf.end()) {
+        slot = it->second;
+    } else if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        slotOf[p.id] = slot;
+    } else {
+        slot = slotCount++;
+        slotOf[p.id] = slot;
+    }
+
+    bool* used;
+    Product* target = writableSlot(slot, &used);
+    if (!*used) {
+        current->productCount++;
+    }
+    *target = p;
+    *used = true;
+    version++;
+}
+
+// Remove a product, its slot is recycled by a later put
+void VersionedCatalog::erase(int productId) {
+    lock_guard<mutex> guard(publishLock);
+
+    unordered_map<int, int>::iterator it = slotOf.find(productId);
+    if (it == slotOf.end()) return;
+
+    bool* used;
+    writableSlot(it->second, &used);
+    *used = false;
+    current->productCount--;
+    freeSlots.push_back(it->second);
+    slotOf.erase(it);
+    version++;
+}
+
+// Update only the fields touched by order processing (no string copies)
+void VersionedCatalog::setCounts(int productId, int quantity, int salesCount) {
+    lock_guard<mutex> guard(publishLock);
+
+    unordered_map<int, int>::iterator it = slotOf.find(productId);
+    if (it == slotOf.end()) return;
+
+    bool* used;
+    Product* target = writableSlot(it->second, &used);
+    target->quantity = quantity;
+    target->salesCount = salesCount;
+    version++;
+}
+
+// O(1) snapshot: pin the current page table, later writes copy what they touch
+CatalogSnapshot VersionedCatalog::snapshot() {
+    lock_guard<mutex> guard(publishLock);
+    return CatalogSnapshot(current, version);
+}
+
+long long VersionedCatalog::getVersion() {
+    lock_guard<mutex> guard(publishLock);
+    return version;
+}
@@ -0,0 +1,211 @@
+#include "../include/WarehouseFederation.h"
+#include <algorithm>
+
+WarehouseSite::WarehouseSite(const string& siteName, int capacity)
+    : name(siteName), system(capacity, capacity, capacity), stopping(false), busy(0), pendingOrders(0) {
+    system.setVerbose(false);
+}
+
+// Run tasks in FIFO order until the federation shuts down
+void WarehouseFederation::workerLoop(WarehouseSite* site) {
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<mutex> guard(site->lock);
+            site->wake.wait(guard, [site]() { return site->stopping || !site->tasks.empty(); });
+            if (site->tasks.empty()) return;
+            task = std::move(site->tasks.front());
+            site->tasks.pop_front();
+        }
+        task();
+        {
+            lock_guard<mutex> guard(site->lock);
+            site->busy--;
+        }
+        site->wake.notify_all();
+    }
+}
+
+WarehouseFederation::WarehouseFederation(int siteCount, int capacityPerSite) {
+    for (int i = 0; i < siteCount; i++) {
+        WarehouseSite* site = new WarehouseSite("Site " + to_string(i + 1), capacityPerSite);
+        site->worker = thread(workerLoop, site);
+        sites.push_back(site);
+    }
+}
+
+// Finish queued work, then stop and free every site
+WarehouseFederation::~WarehouseFederation() {
+    for (WarehouseSite* site : sites) {
+        {
+            lock_guard<mutex> guard(site->lock);
+            site->stopping = true;
+        }
+        site->wake.notify_all();
+    }
+    for (WarehouseSite* site : sites) {
+        site->worker.join();
+        delete site;
+    }
+}
+
+int WarehouseFederation::siteCount() {
+    return (int)sites.size();
+}
+
+void WarehouseFederation::post(int site, function<void()> task) {
+    WarehouseSite* s = sites[site];
+    {
+        lock_guard<mutex> guard(s->lock);
+        s->tasks.push_back(std::move(task));
+        s->busy++;
+    }
+    s->wake.notify_all();
+}
+
+void WarehouseFederation::addStock(int site, const Product& p) {
+    if (site < 0 || site >= (int)sites.size() || p.quantity < 0) return;
+
+    {
+        lock_guard<mutex> guard(summaryLock);
+        unordered_map<int, SkuSummary>::iterator it = summary.find(p.id);
+        if (it == summary.end()) {
+            SkuSummary sku;
+            sku.totalAvailable = 0;
+            sku.available.assign(sites.size(), 0);
+            it = summary.emplace(p.id, sku).first;
+        }
+        it->second.available[site] += p.quantity;
+        it->second.totalAvailable += p.quantity;
+    }
+
+    WarehouseSystem* system = &sites[site]->system;
+    post(site, [system, p]() {
+        Product* existing = system->searchProduct(p.id);
+        if (existing != nullptr) {
+            system->updateStock(p.id, existing->quantity + p.quantity);
+        } else {
+            system->addProduct(p);
+        }
+    });
+}
+
+bool WarehouseFederation::route(SkuSummary& sku, int qty, vector<SiteAllocation>& out) {
+    if (sku.totalAvailable < qty) return false;
+
+    // Whole order from one site: enough stock, then lowest load
+    int best = -1;
+    int bestLoad = 0;
+    for (int s = 0; s < (int)sites.size(); s++) {
+        if (sku.available[s] < qty) continue;
+        int load = sites[s]->pendingOrders.load();
+        if (best < 0 || load < bestLoad) {
+            best = s;
+            bestLoad = load;
+        }
+    }
+    if (best >= 0) {
+        out.push_back(SiteAllocation(best, qty));
+        return true;
+    }
+
+    // Split: take from the deepest stock first to keep the number of parts small
+    vector<int> order;
+    for (int s = 0; s < (int)sites.size(); s++) {
+        if (sku.available[s] > 0) order.push_back(s);
+    }
+    sort(order.begin(), order.end(), [&sku](int a, int b) { return sku.available[a] > sku.available[b]; });
+    int remaining = qty;
+    for (int s : order) {
+        int take = min(remaining, sku.available[s]);
+        out.push_back(SiteAllocation(s, take));
+        remaining -= take;
+        if (remaining == 0) break;
+    }
+    return true;
+}
+
+vector<SiteAllocation> WarehouseFederation::placeOrder(int productId, int qty, bool urgent) {
+    vector<SiteAllocation> parts;
+    if (qty <= 0) return parts;
+
+    {
+        lock_guard<mutex> guard(summaryLock);
+        unordered_map<int, SkuSummary>::iterator it = summary.find(productId);
+        if (it == summary.end() || !route(it->second, qty, parts)) return parts;
+
+        // Reserve now so concurrent callers see the reduced availability
+        for (const SiteAllocation& a : parts) {
+            it->second.available[a.site] -= a.quantity;
+            it->second.totalAvailable -= a.quantity;
+        }
+    }
+
+    for (const SiteAllocation& a : parts) {
+        WarehouseSite* site = sites[a.site];
+        site->pendingOrders++;
+        int s = a.site;
+        int partQty = a.quantity;
+        post(s, [this, site, s, productId, partQty, urgent]() {
+            if (site->system.placeOrder(productId, partQty, urgent) == 0) {
+                site->pendingOrders--;
+                releaseReservation(productId, s, partQty);
+            }
+        });
+    }
+    return parts;
+}
+
+// Give reserved units back when a site could not take or fulfil its part
+void WarehouseFederation::releaseReservation(int productId, int site, int qty) {
+    lock_guard<mutex> guard(summaryLock);
+    unordered_map<int, SkuSummary>::iterator it = summary.find(productId);
+    if (it != summary.end()) {
+        it->second.available[site] += qty;
+        it->second.totalAvailable += qty;
+    }
+}
+
+void WarehouseFederation::processPending() {
+    for (int s = 0; s < (int)sites.size(); s++) {
+        WarehouseSite* site = sites[s];
+        post(s, [this, site, s]() {
+            Order next;
+            while (site->system.peekNextOrder(next)) {
+                if (!site->system.processNextOrder()) {
+                    // Not expected while the federation is the only writer
+                    releaseReservation(next.productId, s, next.quantity);
+                }
+                site->pendingOrders--;
+            }
+        });
+    }
+}
+
+void WarehouseFederation::waitIdle() {
+    for (WarehouseSite* site : sites) {
+        unique_lock<mutex> guard(site->lock);
+        site->wake.wait(guard, [site]() { return site->busy == 0; });
+    }
+}
+
+int WarehouseFederation::availableStock(int productId) {
+    lock_guard<mutex> guard(summaryLock);
+    unordered_map<int, SkuSummary>::iterator it = summary.find(productId);
+    return it == summary.end() ? 0 : it->second.totalAvailable;
+}
+
+vector<int> WarehouseFederation::availableBySite(int productId) {
+    lock_guard<mutex> guard(summaryLock);
+    unordered_map<int, SkuSummary>::iterator it = summary.find(productId);
+    if (it == summary.end()) return vector<int>(sites.size(), 0);
+    return it->second.available;
+}
+
+int WarehouseFederation::siteLoad(int site) {
+    return sites[site]->pendingOrders.load();
+}
+
+WarehouseSystem& WarehouseFederation::siteSystem(int site) {
+    return sites[site]->system;
+}
@@ -0,0 +1,507 @@
+#include "../include/WarehouseServer.h"
+#include "../include/Colors.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace Colors;
+
+#define SERVER_MAX_EVENTS 256
+#define SERVER_READ_CHUNK 65536
+#define SERVER_READ_BUDGET (1 << 20)   // Bytes read per connection per wakeup, keeps others responsive
+#define SERVER_OUT_HIGH_WATER (1 << 20)   // Unsent reply bytes at which a connection stops being read
+#define SERVER_MAX_LINE 65536          // Longest request line; a longer one closes the connection
+
+WarehouseServer::WarehouseServer(WarehouseSystem& system)
+    : warehouse(system), epollFd(-1), stopping(false), requestCount(0), checkpointer(nullptr), fulfilmentPool(nullptr), waves(system) {
+#ifdef __linux__
+    epollFd = epoll_create1(0);
+#endif
+}
+
+WarehouseServer::~WarehouseServer() {
+#ifdef __linux__
+    for (unordered_map<int, ServerConnection>::iterator it = connections.begin(); it != connections.end(); ++it) {
+        close(it->first);
+    }
+    for (int fd : listenFds) close(fd);
+    if (!unixPath.empty()) unlink(unixPath.c_str());
+    if (epollFd >= 0) close(epollFd);
+#endif
+}
+
+void WarehouseServer::setCheckpointer(Checkpointer* c) {
+    checkpointer = c;
+}
+
+void WarehouseServer::setFulfilmentPool(WorkStealingPool* pool) {
+    fulfilmentPool = pool;
+}
+
+// Small cursor over one request line
+struct LineReader {
+    const char* p;
+    const char* end;
+
+    LineReader(const char* s, size_t n) : p(s), end(s + n) {}
+
+    void skipSpaces() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    }
+    bool word(const char*& start, size_t& len) {
+        skipSpaces();
+        start = p;
+        while (p < end && *p != ' ' && *p != '\t' && *p != '\r') p++;
+        len = (size_t)(p - start);
+        return len > 0;
+    }
+    bool integer(int& value) {
+        const char* s;
+        size_t n;
+        if (!word(s, n)) return false;
+        char buf[32];
+        if (n >= sizeof(buf)) return false;
+        memcpy(buf, s, n);
+        buf[n] = '\0';
+        char* stop;
+        errno = 0;
+        long v = strtol(buf, &stop, 10);
+        if (*stop != '\0' || errno == ERANGE || v < INT_MIN || v > INT_MAX) return false;
+        value = (int)v;
+        return true;
+    }
+    bool number(double& value) {
+        const char* s;
+        size_t n;
+        if (!word(s, n)) return false;
+        char buf[64];
+        if (n >= sizeof(buf)) return false;
+        memcpy(buf, s, n);
+        buf[n] = '\0';
+        char* stop;
+        value = strtod(buf, &stop);
+        return *stop == '\0';
+    }
+    string rest() {
+        skipSpaces();
+        const char* e = end;
+        while (e > p && (e[-1] == '\r' || e[-1] == ' ')) e--;
+        return string(p, (size_t)(e - p));
+    }
+};
+
+static bool isCommand(const char* s, size_t n, const char* name) {
+    size_t m = strlen(name);
+    if (n != m) return false;
+    for (size_t i = 0; i < n; i++) {
+        char c = s[i];
+        if (c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+        if (c != name[i]) return false;
+    }
+    return true;
+}
+
+void WarehouseServer::handleLine(const char* line, size_t len, string& out) {
+    LineReader r(line, len);
+    const char* cmd;
+    size_t cmdLen;
+    char buf[192];
+    requestCount++;
+
+    if (!r.word(cmd, cmdLen)) {
+        out += "ERR empty request\n";
+        return;
+    }
+
+    if (isCommand(cmd, cmdLen, "PING")) {
+        out += "OK\n";
+    } else if (isCommand(cmd, cmdLen, "SEARCH")) {
+        int id;
+        if (!r.integer(id)) { out += "ERR usage: SEARCH <id>\n"; return; }
+        Product* p = warehouse.searchProduct(id);
+        if (p == nullptr) { out += "ERR not found\n"; return; }
+        snprintf(buf, sizeof(buf), "OK %d %d %.2f %d ", p->id, p->quantity, p->price, p->salesCount);
+        out += buf;
+        out += p->category;
+        out += ' ';
+        out += p->name;
+        out += '\n';
+    } else if (isCommand(cmd, cmdLen, "ORDER")) {
+        int id, qty;
+        if (!r.integer(id) || !r.integer(qty) || qty <= 0) { out += "ERR usage: ORDER <id> <qty> [U]\n"; return; }
+        const char* flag;
+        size_t flagLen;
+        bool urgent = r.word(flag, flagLen) && isCommand(flag, flagLen, "U");
+        int orderId = warehouse.placeOrder(id, qty, urgent);
+        if (orderId == 0) { out += "ERR rejected\n"; return; }
+        snprintf(buf, sizeof(buf), "OK %d\n", orderId);
+        out += buf;
+    } else if (isCommand(cmd, cmdLen, "PROCESS")) {
+        int n = 1;
+        r.integer(n);
+        int fulfilled = 0;
+        if (fulfilmentPool != nullptr) {
+            if (n > 0) fulfilled = warehouse.processOrdersParallel(*fulfilmentPool, n);
+        } else {
+            for (int i = 0; i < n && warehouse.pendingOrderCount() > 0; i++) {
+                if (warehouse.processNextOrder()) fulfilled++;
+            }
+        }
+        snprintf(buf, sizeof(buf), "OK %d\n", fulfilled);
+        out += buf;
+    } else if (isCommand(cmd, cmdLen, "WAVE")) {
+        int n = -1;
+        r.integer(n);
+        // Planned and committed back to back on this thread, so the plan cannot go stale
+        waves.plan(n);
+        int fulfilled = waves.commit();
+        snprintf(buf, sizeof(buf), "OK %d %d %d %d\n", fulfilled, waves.orderCount(), (int)waves.lines().size(),
+                 (int)waves.zones().size());
+        out += buf;
+    } else if (isCommand(cmd, cmdLen, "STOCK")) {
+        int id, qty;
+        if (!r.integer(id) || !r.integer(qty) || qty < 0) { out += "ERR usage: STOCK <id> <qty>\n"; return; }
+        if (warehouse.searchProduct(id) == nullptr) { out += "ERR not found\n"; return; }
+        warehouse.updateStock(id, qty);
+        out += "OK\n";
+    } else if (isCommand(cmd, cmdLen, "ADD")) {
+        int id, qty;
+        double price;
+        const char* cat;
+        size_t catLen;
+        if (!r.integer(id) || !r.integer(qty) || !r.number(price) || !isfinite(price) || price < 0 || !r.word(cat, catLen) ||
+            qty < 0) {
+            out += "ERR usage: ADD <id> <qty> <price> <category> <name>\n";
+            return;
+        }
+        if (warehouse.searchProduct(id) != nullptr) { out += "ERR exists\n"; return; }
+        warehouse.addProduct(Product(id, r.rest(), string(cat, catLen), qty, price));
+        out += "OK\n";
+    } else if (isCommand(cmd, cmdLen, "PRICE")) {
+        int id;
+        double price;
+        if (!r.integer(id) || !r.number(price) || !isfinite(price) || price < 0) { out += "ERR usage: PRICE <id> <price>\n"; return; }
+        if (!warehouse.updatePrice(id, price)) { out += "ERR not found\n"; return; }
+        out += "OK\n";
+    } else if (isCommand(cmd, cmdLen, "PRICES") || isCommand(cmd, cmdLen, "CHEAPEST")) {
+        vector<Product> found;
+        if (isCommand(cmd, cmdLen, "PRICES")) {
+            double lo, hi;
+            int limit = 50;
+            if (!r.number(lo) || !r.number(hi)) { out += "ERR usage: PRICES <lo> <hi> [limit]\n"; return; }
+            r.integer(limit);
+            found = warehouse.productsInPriceRange(lo, hi, limit);
+        } else {
+            int n;
+            if (!r.integer(n)) { out += "ERR usage: CHEAPEST <n>\n"; return; }
+            found = warehouse.cheapestInStock(n);
+        }
+        snprintf(buf, sizeof(buf), "OK %d", (int)found.size());
+        out += buf;
+        for (const Product& p : found) {
+            snprintf(buf, sizeof(buf), " %d:%.2f", p.id, p.price);
+            out += buf;
+        }
+        out += '\n';
+    } else if (isCommand(cmd, cmdLen, "SHIPMENTS")) {
+        OrderHistory* history = warehouse.getOrderHistory();
+        int id;
+        if (history == nullptr) { out += "ERR history disabled\n"; return; }
+        if (!r.integer(id)) { out += "ERR usage: SHIPMENTS <id> [from to]\n"; return; }
+        double from, to;
+        vector<HistoryRecord> found;
+        if (r.number(from) && r.number(to)) history->forProduct(id, (long long)from, (long long)to, found);
+        else history->forProduct(id, found);
+        long long units = 0;
+        for (const HistoryRecord& h : found) units += h.quantity;
+        snprintf(buf, sizeof(buf), "OK %d %lld\n", (int)found.size(), units);
+        out += buf;
+    } else if (isCommand(cmd, cmdLen, "FILTER")) {
+        const char* cat;
+        size_t catLen;
+        ProductFilter filter;
+        if (!r.word(cat, catLen) || !r.integer(filter.minQuantity) || !r.integer(filter.maxQuantity) ||
+            !r.number(filter.minPrice) || !r.number(filter.maxPrice)) {
+            out += "ERR usage: FILTER <category|*> <minQty> <maxQty> <minPrice> <maxPrice>\n";
+            return;
+        }
+        if (!(catLen == 1 && cat[0] == '*')) filter.category.assign(cat, catLen);
+        vector<int> ids = warehouse.filterProductIds(filter);
+        snprintf(buf, sizeof(buf), "OK %d", (int)ids.size());
+        out += buf;
+        for (size_t i = 0; i < ids.size() && i < 50; i++) {
+            snprintf(buf, sizeof(buf), " %d", ids[i]);
+            out += buf;
+        }
+        out += '\n';
+    } else if (isCommand(cmd, cmdLen, "FIND")) {
+        string text = r.rest();
+        if (text.empty()) { out += "ERR usage: FIND <text>\n"; return; }
+        vector<NameMatch> matches = warehouse.searchByName(text, 10);
+        snprintf(buf, sizeof(buf), "OK %d", (int)matches.size());
+        out += buf;
+        for (const NameMatch& m : matches) {
+            snprintf(buf, sizeof(buf), " %d", m.productId);
+            out += buf;
+        }
+        out += '\n';
+    } else if (isCommand(cmd, cmdLen, "FREEZE")) {
+        warehouse.freezeCatalog();
+        snprintf(buf, sizeof(buf), "OK %d\n", warehouse.frozenProductCount());
+        out += buf;
+    } else if (isCommand(cmd, cmdLen, "STATS")) {
+        LookupFilterStats lookups = warehouse.lookupFilterStats();
+        snprintf(buf, sizeof(buf),
+                 "OK products=%d frozen=%d pending=%d requests=%lld connections=%d lookups=%lld rejected=%lld falsepos=%lld\n",
+                 warehouse.productCount(), warehouse.frozenProductCount(), warehouse.pendingOrderCount(), requestCount,
+                 (int)connections.size(), lookups.lookups, lookups.rejected, lookups.falsePositives);
+        out += buf;
+    } else if (isCommand(cmd, cmdLen, "LATENCY")) {
+        OrderTracer* tracer = warehouse.getOrderTracer();
+        if (tracer == nullptr) { out += "ERR tracing off\n"; return; }
+        out += "OK";
+        const char* names[] = {"wait", "urgentwait", "service", "urgentservice"};
+        for (int i = 0; i < 4; i++) {
+            const LatencyHistogram& h = i < 2 ? tracer->queueWait(i == 1) : tracer->serviceTime(i == 3);
+            snprintf(buf, sizeof(buf), " %s=%lld/%lld/%lld/%lld", names[i], h.count(),
+                     h.percentile(0.50) / 1000, h.percentile(0.99) / 1000, h.max() / 1000);
+            out += buf;
+        }
+        out += "\n";
+    } else if (isCommand(cmd, cmdLen, "QUIT")) {
+        out += "OK\n";
+    } else {
+        out += "ERR unknown command\n";
+    }
+}
+
+#ifdef __linux__
+
+bool WarehouseServer::addListener(int fd) {
+    if (listen(fd, 128) < 0) {
+        close(fd);
+        return false;
+    }
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    listenFds.push_back(fd);
+    return true;
+}
+
+bool WarehouseServer::listenTcp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return false;
+    }
+    return addListener(fd);
+}
+
+bool WarehouseServer::listenUnix(const string& path) {
+    sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str());
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return false;
+    }
+    unixPath = path;
+    return addListener(fd);
+}
+
+void WarehouseServer::acceptAll(int listenFd) {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));   // Fails harmlessly on Unix sockets
+
+        ServerConnection& conn = connections[fd];
+        conn.fd = fd;
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+void WarehouseServer::watchWrites(ServerConnection& conn, bool on) {
+    epoll_event ev;
+    ev.events = 0;
+    if (on) ev.events |= EPOLLOUT;
+    if (conn.out.size() < SERVER_OUT_HIGH_WATER) ev.events |= EPOLLIN;
+    ev.data.fd = conn.fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+}
+
+void WarehouseServer::closeConnection(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
+
+// Drain the socket, run every complete line, then answer the whole batch in one
+// write. A client that does not read its replies is not read from either
+// until they drain, so neither buffer grows without bound.
+void WarehouseServer::readFrom(ServerConnection& conn) {
+    char chunk[SERVER_READ_CHUNK];
+    size_t budget = conn.out.size() < SERVER_OUT_HIGH_WATER ? SERVER_READ_BUDGET : 0;
+    while (budget > 0) {
+        ssize_t n = read(conn.fd, chunk, sizeof(chunk));
+        if (n > 0) {
+            conn.in.append(chunk, (size_t)n);
+            budget -= min(budget, (size_t)n);
+            continue;
+        }
+        if (n == 0) conn.closing = true;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) conn.closing = true;
+        break;
+    }
+
+    runLines(conn);
+    if (!conn.closing && conn.in.size() > SERVER_MAX_LINE && conn.in.find('\n') == string::npos) {
+        conn.out += "ERR line too long\n";
+        conn.in.clear();
+        conn.closing = true;
+    }
+    flush(conn);
+}
+
+// Complete lines in order, until the replies reach the high-water mark
+void WarehouseServer::runLines(ServerConnection& conn) {
+    size_t start = 0;
+    while (conn.out.size() < SERVER_OUT_HIGH_WATER) {
+        size_t nl = conn.in.find('\n', start);
+        if (nl == string::npos) break;
+        const char* line = conn.in.data() + start;
+        size_t len = nl - start;
+        handleLine(line, len, conn.out);
+
+        LineReader r(line, len);
+        const char* cmd;
+        size_t cmdLen;
+        if (r.word(cmd, cmdLen) && isCommand(cmd, cmdLen, "QUIT")) {
+            conn.closing = true;
+            start = conn.in.size();
+            break;
+        }
+        start = nl + 1;
+    }
+    conn.in.erase(0, start);
+}
+
+void WarehouseServer::flush(ServerConnection& conn) {
+    size_t sent = 0;
+    while (sent < conn.out.size()) {
+        ssize_t n = send(conn.fd, conn.out.data() + sent, conn.out.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += (size_t)n;
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0 && errno == EINTR) continue;
+        closeConnection(conn.fd);   // Peer is gone
+        return;
+    }
+    conn.out.erase(0, sent);
+
+    // Lines held back while the replies were over the high-water mark
+    if (sent > 0 && conn.out.size() < SERVER_OUT_HIGH_WATER && conn.in.find('\n') != string::npos) {
+        runLines(conn);
+        flush(conn);
+        return;
+    }
+
+    if (conn.out.empty()) {
+        if (conn.closing) {
+            closeConnection(conn.fd);
+            return;
+        }
+        watchWrites(conn, false);
+    } else {
+        watchWrites(conn, true);
+    }
+}
+
+int WarehouseServer::run() {
+    if (epollFd < 0 || listenFds.empty()) {
+        cout << Theme::ERR << "Server has nothing to listen on." << RESET << endl;
+        return 1;
+    }
+
+    epoll_event events[SERVER_MAX_EVENTS];
+    while (!stopping.load()) {
+        // Timeout only so stop() is noticed promptly
+        int n = epoll_wait(epollFd, events, SERVER_MAX_EVENTS, 200);
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            bool isListener = false;
+            for (int l : listenFds) {
+                if (l == fd) isListener = true;
+            }
+            if (isListener) {
+                acceptAll(fd);
+                continue;
+            }
+
+            unordered_map<int, ServerConnection>::iterator it = connections.find(fd);
+            if (it == connections.end()) continue;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                readFrom(it->second);
+            } else if (events[i].events & EPOLLOUT) {
+                flush(it->second);
+            }
+        }
+        if (checkpointer != nullptr) checkpointer->tick();
+        if (n == 0) warehouse.sweepHeapsWhenIdle();     // Idle: sweep heap tombstones off the request path
+    }
+    return 0;
+}
+
+#else
+
+bool WarehouseServer::listenTcp(int) { return false; }
+bool WarehouseServer::listenUnix(const string&) { return false; }
+
+int WarehouseServer::run() {
+    cout << Theme::ERR << "The socket server needs Linux (epoll)." << RESET << endl;
+    return 1;
+}
+
+#endif
+
+void WarehouseServer::stop() {
+    stopping.store(true);
+}
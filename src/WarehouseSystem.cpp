@@ -1,55 +1,128 @@
 #include "../include/WarehouseSystem.h"
 #include "../include/Colors.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
 
 using namespace Colors;
 
 // Constructor
 WarehouseSystem::WarehouseSystem(int minHeapCap, int maxHeapCap, int hashMapCap)
-    : lowSellingHeap(minHeapCap),
-      bestSellingHeap(maxHeapCap),
+    : idFilter(hashMapCap),
       productsMap(hashMapCap),
-      nextOrderId(1) {}
+      lowSellingHeap(minHeapCap),
+      bestSellingHeap(maxHeapCap),
+      nextOrderId(1),
+      verbose(true),
+      orderExporter(nullptr),
+      orderHistory(nullptr),
+      orderTracer(nullptr),
+      recorder(nullptr),
+      heapPolicy(HEAP_HARD_DELETE) {}
 
 // Add a new product to all data structures
-void WarehouseSystem::addProduct(Product p) {
+void WarehouseSystem::addProduct(const Product& p) {
+    Product copy = p;
+    addProduct(std::move(copy));
+}
+
+// Add a new product, moving it into the product store (the other structures keep copies)
+void WarehouseSystem::addProduct(Product&& p) {
+    // A NaN or infinite price has no place in the price ordering
+    if (!isfinite(p.price)) {
+        if (verbose) cout << Theme::ERR << "Invalid price for product " << p.id << "!" << RESET << endl;
+        return;
+    }
+    if (recorder != nullptr) recorder->addProduct(p);
+    if (verbose) cout << Theme::SUCCESS << "Product '" << Theme::DATA << p.name 
+         << Theme::SUCCESS << "' (ID: " << Theme::DATA << p.id 
+         << Theme::SUCCESS << ") added to warehouse." << RESET << endl;
+
+    // Re-adding an ID replaces the product, drop its old price key and name first
+    Product* existing = findProduct(p.id);
+    if (existing != nullptr) {
+        priceIndex.remove(existing->price, p.id);
+        nameIndex.remove(p.id, existing->name);
+    }
+    priceIndex.insert(p.price, p.id);
+    nameIndex.add(p.id, p.name);
+
     // Add to AVLTree for O(log n) search
     productsTree.insert(p);
     
-    // Add to HashMap for O(1) average retrieval
-    productsMap.insert(p);
-    
     // Add to heaps for O(1) retrieval of best/lowest selling products
-    lowSellingHeap.insert(p);
-    bestSellingHeap.insert(p);
-    
-    cout << Theme::SUCCESS << "Product '" << Theme::DATA << p.name 
-         << Theme::SUCCESS << "' (ID: " << Theme::DATA << p.id 
-         << Theme::SUCCESS << ") added to warehouse." << RESET << endl;
+    // (a replaced or tombstoned ID is still there, take the new sales count)
+    SalesEntry entry(p.id, p.salesCount);
+    if (!lowSellingHeap.push(entry)) lowSellingHeap.update(p.id, entry);
+    if (!bestSellingHeap.push(entry)) bestSellingHeap.update(p.id, entry);
+    heapTombstones.erase(p.id);
+
+    // Add to the versioned catalog used by reports and the filter columns
+    catalog.put(p);
+    columns.put(p);
+
+    // Store it (takes ownership of p): in place if its ID was frozen, else in the overlay
+    int id = p.id;
+    if (frozenProducts.slotOf(id) < 0) productsMap.insert(std::move(p));
+    else frozenProducts.put(std::move(p));
+
+    // A new ID goes into the filter; when it is full, rebuild it twice as large from the store
+    if (existing == nullptr && !idFilter.insert(id)) {
+        rebuildIdFilter(2 * productCount());
+    }
 }
 
-// Remove product from AVLTree and HashMap (only when quantity reaches 0)
-// Note: Product remains in heaps as they track sales history
 void WarehouseSystem::removeProduct(int productId) {
-    Product* p = productsMap.get(productId);
+    if (recorder != nullptr) recorder->call(TRACE_REMOVE, productId);
+    eraseProduct(productId);
+}
+
+// Remove product from every structure (only when quantity reaches 0); the
+// heaps drop it now or later depending on the heap policy
+void WarehouseSystem::eraseProduct(int productId) {
+    Product* p = findProduct(productId);
     if (p != nullptr) {
         // Remove from AVLTree
         productsTree.remove(productId);
         
-        // Remove from HashMap
-        productsMap.remove(productId);
-        
-        cout << Theme::WARNING << "Product '" << Theme::DATA << p->name 
+        // Remove from the versioned catalog and the filter columns
+        catalog.erase(productId);
+        columns.erase(productId);
+        priceIndex.remove(p->price, productId);
+        nameIndex.remove(productId, p->name);
+
+        if (heapPolicy == HEAP_HARD_DELETE) {
+            lowSellingHeap.remove(productId);
+            bestSellingHeap.remove(productId);
+            lowSellingHeap.shrinkToFit();
+            bestSellingHeap.shrinkToFit();
+        } else {
+            // Sweep once a quarter of the heap is dead, so each removal costs O(log n) amortized
+            heapTombstones.insert(productId);
+            if (heapTombstones.size() >= 64 && (int)heapTombstones.size() * 4 >= lowSellingHeap.size()) {
+                sweepHeapTombstones();
+            }
+        }
+
+        if (verbose) cout << Theme::WARNING << "Product '" << Theme::DATA << p->name 
              << Theme::WARNING << "' (ID: " << Theme::DATA << productId 
              << Theme::WARNING << ") removed from warehouse (out of stock)." << RESET << endl;
+
+        idFilter.remove(productId);
+
+        // Remove from the frozen table or the overlay (last, p points into it)
+        if (!frozenProducts.remove(productId)) productsMap.remove(productId);
     } else {
-        cout << Theme::ERR << "Product not found!" << RESET << endl;
+        if (verbose) cout << Theme::ERR << "Product not found!" << RESET << endl;
     }
 }
 
 // Update stock quantity in both AVLTree and HashMap
 void WarehouseSystem::updateStock(int productId, int qty) {
+    if (recorder != nullptr) recorder->call(TRACE_STOCK, productId, qty);
     // Update in HashMap
-    Product* p = productsMap.get(productId);
+    Product* p = findProduct(productId);
     if (p != nullptr) {
         p->quantity = qty;
         
@@ -58,32 +131,213 @@ void WarehouseSystem::updateStock(int productId, int qty) {
         if (treeProduct != nullptr) {
             treeProduct->quantity = qty;
         }
+        catalog.setCounts(productId, p->quantity, p->salesCount);
+        columns.setCounts(productId, p->quantity, p->salesCount);
         
-        cout << Theme::SUCCESS << "Stock updated for Product ID " << Theme::DATA << productId 
+        if (verbose) cout << Theme::SUCCESS << "Stock updated for Product ID " << Theme::DATA << productId 
              << Theme::SUCCESS << ": New quantity = " << Theme::DATA << qty << RESET << endl;
     } else {
-        cout << Theme::ERR << "Product not found!" << RESET << endl;
+        if (verbose) cout << Theme::ERR << "Product not found!" << RESET << endl;
     }
 }
 
-// Search for a product (using HashMap for O(1) average retrieval)
+// Reprice a product in every structure that holds its price
+bool WarehouseSystem::updatePrice(int productId, double price) {
+    if (!isfinite(price)) {
+        if (verbose) cout << Theme::ERR << "Invalid price!" << RESET << endl;
+        return false;
+    }
+    if (recorder != nullptr) recorder->updatePrice(productId, price);
+    Product* p = findProduct(productId);
+    if (p == nullptr) {
+        if (verbose) cout << Theme::ERR << "Product not found!" << RESET << endl;
+        return false;
+    }
+
+    priceIndex.update(productId, p->price, price);
+    p->price = price;
+    Product* treeProduct = productsTree.search(productId);
+    if (treeProduct != nullptr) {
+        treeProduct->price = price;
+    }
+    catalog.put(*p);
+    columns.setPrice(productId, price);
+
+    if (verbose) cout << Theme::SUCCESS << "Price updated for Product ID " << Theme::DATA << productId 
+         << Theme::SUCCESS << ": New price = " << Theme::DATA << price << RESET << endl;
+    return true;
+}
+
+// Search for a product (one probe in the frozen table, else the overlay HashMap)
 Product* WarehouseSystem::searchProduct(int productId) {
-    return productsMap.get(productId);
+    if (recorder != nullptr) recorder->call(TRACE_SEARCH, productId);
+    return findProduct(productId);
 }
 
-// Display all products
+Product* WarehouseSystem::findProduct(int productId) {
+    filterStats.lookups++;
+    if (!idFilter.mayContain(productId)) {
+        filterStats.rejected++;
+        return nullptr;
+    }
+    Product* p = frozenProducts.get(productId);
+    if (p == nullptr) p = productsMap.get(productId);
+    if (p == nullptr) filterStats.falsePositives++;
+    return p;
+}
+
+// Refill the filter from the stored products, sized for expectedKeys
+void WarehouseSystem::rebuildIdFilter(int expectedKeys) {
+    bool complete = false;
+    while (!complete) {
+        idFilter.reset(expectedKeys);
+        complete = true;
+        frozenProducts.forEach([this, &complete](Product& p) { complete = complete && idFilter.insert(p.id); });
+        productsMap.forEach([this, &complete](Product& p) { complete = complete && idFilter.insert(p.id); });
+        expectedKeys *= 2;
+    }
+}
+
+LookupFilterStats WarehouseSystem::lookupFilterStats() {
+    return filterStats;
+}
+
+int WarehouseSystem::productCount() {
+    return frozenProducts.size() + productsMap.getSize();
+}
+
+// Move every live product into a new frozen table; the overlay starts empty
+void WarehouseSystem::freezeCatalog() {
+    if (recorder != nullptr) recorder->call(TRACE_FREEZE);
+    vector<Product> all;
+    all.reserve(productCount());
+    frozenProducts.forEach([&all](Product& p) { all.push_back(std::move(p)); });
+    productsMap.forEach([&all](Product& p) { all.push_back(std::move(p)); });
+    productsMap.clear();
+    frozenProducts.build(all);
+
+    if (verbose) cout << Theme::SUCCESS << "Catalog frozen: " << Theme::DATA << frozenProducts.size()
+         << Theme::SUCCESS << " products in " << Theme::DATA << frozenProducts.bucketCount()
+         << Theme::SUCCESS << " hash buckets." << RESET << endl;
+}
+
+int WarehouseSystem::frozenProductCount() {
+    return frozenProducts.size();
+}
+
+int WarehouseSystem::overlayProductCount() {
+    return productsMap.getSize();
+}
+
+// Display all products from a snapshot, so the listing is never torn by order processing
 void WarehouseSystem::displayAllProducts() {
-    productsMap.display();
+    CatalogSnapshot snap = pinSnapshot();
+    if (snap.productCount() == 0) {
+        cout << "Catalog is empty." << endl;
+        return;
+    }
+
+    cout << "Products in catalog (Total: " << snap.productCount() 
+         << ", version " << snap.version() << "):" << endl;
+    snap.forEachProduct([](const Product& p) {
+        cout << "ID: " << p.id << ", Name: " << p.name 
+             << ", Category: " << p.category 
+             << ", Quantity: " << p.quantity 
+             << ", Price: $" << p.price << endl;
+    });
+}
+
+// Sorted, paginated listing (ID order from the ordered index, other orders from a snapshot)
+ListingPage WarehouseSystem::listProducts(const ListingQuery& query) {
+    if (recorder != nullptr) recorder->listProducts(query);
+    return CatalogListing::list(productsTree, pinSnapshot(), query);
+}
+
+// Scan the columns, then materialize the selected rows from the HashMap
+vector<Product> WarehouseSystem::filterProducts(const ProductFilter& filter) {
+    if (recorder != nullptr) recorder->filter(TRACE_FILTER, filter);
+    vector<int> ids = columns.idsOf(columns.select(filter));
+    sort(ids.begin(), ids.end());
+    vector<Product> out;
+    out.reserve(ids.size());
+    for (int id : ids) {
+        Product* p = findProduct(id);
+        if (p != nullptr) out.push_back(*p);
+    }
+    return out;
+}
+
+vector<int> WarehouseSystem::filterProductIds(const ProductFilter& filter) {
+    if (recorder != nullptr) recorder->filter(TRACE_FILTER_IDS, filter);
+    vector<int> ids = columns.idsOf(columns.select(filter));
+    sort(ids.begin(), ids.end());
+    return ids;
+}
+
+const ProductColumns& WarehouseSystem::productColumns() {
+    return columns;
+}
+
+vector<Product> WarehouseSystem::productsInPriceRange(double lo, double hi, int limit) {
+    if (recorder != nullptr) recorder->priceRange(lo, hi, limit);
+    vector<PriceKey> keys;
+    priceIndex.range(lo, hi, limit, keys);
+    vector<Product> out;
+    out.reserve(keys.size());
+    for (const PriceKey& k : keys) {
+        Product* p = findProduct(k.id);
+        if (p != nullptr) out.push_back(*p);
+    }
+    return out;
+}
+
+// Walk the index from the cheapest, skipping products with no stock left
+vector<Product> WarehouseSystem::cheapestInStock(int n) {
+    if (recorder != nullptr) recorder->call(TRACE_CHEAPEST, n);
+    vector<Product> out;
+    if (n <= 0) return out;
+    out.reserve(n);
+    priceIndex.ascending([this, n, &out](const PriceKey& k) {
+        Product* p = findProduct(k.id);
+        if (p != nullptr && p->quantity > 0) out.push_back(*p);
+        return (int)out.size() < n;
+    });
+    return out;
+}
+
+vector<NameMatch> WarehouseSystem::searchByName(const string& query, int limit) {
+    if (recorder != nullptr) recorder->searchByName(query, limit);
+    return nameIndex.search(query, limit);
+}
+
+CatalogSnapshot WarehouseSystem::takeSnapshot() {
+    if (recorder != nullptr) recorder->call(TRACE_SNAPSHOT);
+    return pinSnapshot();
+}
+
+// Periodic checkpoints are housekeeping, not client calls, so a replay
+// does not repeat them
+CatalogSnapshot WarehouseSystem::snapshotForCheckpoint() {
+    return pinSnapshot();
+}
+
+// Pin the current catalog version and copy the pending orders and the next
+// order ID alongside it
+CatalogSnapshot WarehouseSystem::pinSnapshot() {
+    CatalogSnapshot snap = catalog.snapshot();
+    snap.nextOrderId = nextOrderId;
+    snap.pendingOrders.reserve(orderQueue.getSize());
+    for (int i = 0; i < orderQueue.getSize(); i++) {
+        snap.pendingOrders.push_back(orderQueue.at(i));
+    }
+    return snap;
 }
 
 // Helper function to calculate total pending quantity for a product in the queue
 int WarehouseSystem::getPendingQuantity(int productId) {
     int totalPending = 0;
-    queue<Order> tempQueue = orderQueue; // Copy queue to avoid modifying original
-    
-    while (!tempQueue.empty()) {
-        Order o = tempQueue.front();
-        tempQueue.pop();
+    for (int i = 0; i < orderQueue.getSize(); i++) {
+        const Order& o = orderQueue.at(i);
         if (o.productId == productId) {
             totalPending += o.quantity;
         }
@@ -92,99 +346,264 @@ int WarehouseSystem::getPendingQuantity(int productId) {
 }
 
 // Place order (adds to queue, doesn't process yet)
-void WarehouseSystem::placeOrder(int productId, int qty) {
-    Product* p = productsMap.get(productId);
+int WarehouseSystem::placeOrder(int productId, int qty, bool urgent) {
+    if (recorder != nullptr) recorder->call(TRACE_ORDER, productId, qty, urgent ? 1 : 0);
+    Product* p = findProduct(productId);
     if (p == nullptr) {
-        cout << Theme::ERR << "Product not found!" << RESET << endl;
-        return;
+        if (verbose) cout << Theme::ERR << "Product not found!" << RESET << endl;
+        return 0;
     }
     if (p->quantity < qty) {
-        cout << Theme::ERR << "Insufficient stock! Available: " << Theme::DATA << p->quantity 
+        if (verbose) cout << Theme::ERR << "Insufficient stock! Available: " << Theme::DATA << p->quantity 
              << Theme::ERR << ", Requested: " << Theme::DATA << qty << RESET << endl;
-        return;
+        return 0;
     }
     
-    // Create order and add to back of queue (FIFO)
-    Order newOrder(nextOrderId++, productId, qty, false);
-    orderQueue.push(newOrder);
+    // Create order and add to back of queue (FIFO), urgent orders jump to the front
+    Order newOrder(nextOrderId++, productId, qty, urgent);
+    if (orderTracer != nullptr) newOrder.placedAt = OrderTracer::now();
+    orderQueue.enqueue(newOrder);
     
-    cout << Theme::SUCCESS << "Order #" << Theme::DATA << newOrder.orderId 
+    if (verbose) cout << Theme::SUCCESS << "Order #" << Theme::DATA << newOrder.orderId 
          << Theme::SUCCESS << " placed for Product ID " << Theme::DATA << productId 
          << Theme::SUCCESS << " (Qty: " << Theme::DATA << qty << Theme::SUCCESS << ")" << RESET << endl;
+    return newOrder.orderId;
+}
+
+// Re-queue checkpointed orders (front to back) without re-checking stock.
+// Urgent orders always sit ahead of normal ones, so normal orders go in as they
+// are and urgent ones are pushed to the front in reverse.
+void WarehouseSystem::restorePendingOrders(const vector<Order>& orders, int nextId) {
+    if (recorder != nullptr) recorder->restorePendingOrders(orders, nextId);
+    if (nextId > nextOrderId) nextOrderId = nextId;
+    for (const Order& o : orders) {
+        if (!o.urgent) orderQueue.enqueue(o);
+        if (o.orderId >= nextOrderId) nextOrderId = o.orderId + 1;
+    }
+    for (int i = (int)orders.size() - 1; i >= 0; i--) {
+        if (orders[i].urgent) orderQueue.enqueue(orders[i]);
+    }
+}
+
+void WarehouseSystem::setOrderExporter(OrderExporter* exporter) {
+    orderExporter = exporter;
+}
+
+void WarehouseSystem::setOrderHistory(OrderHistory* history) {
+    orderHistory = history;
+}
+
+OrderHistory* WarehouseSystem::getOrderHistory() {
+    return orderHistory;
+}
+
+void WarehouseSystem::setOrderTracer(OrderTracer* tracer) {
+    orderTracer = tracer;
+}
+
+OrderTracer* WarehouseSystem::getOrderTracer() {
+    return orderTracer;
+}
+
+void WarehouseSystem::setOperationRecorder(OperationRecorder* rec) {
+    recorder = rec;
+}
+
+void WarehouseSystem::traceOrder(const Order& o, long long dequeuedAt, bool fulfilled) {
+    if (orderTracer != nullptr) orderTracer->record(o, dequeuedAt, OrderTracer::now(), fulfilled);
 }
 
 // Process the next order: reduces quantity, updates salesCount, updates heaps
-// If quantity reaches 0, removes product from AVLTree and HashMap
-void WarehouseSystem::processNextOrder() {
-    if (orderQueue.empty()) {
-        cout << Theme::INFO << "No orders to process." << RESET << endl;
-        return;
+// If quantity reaches 0, removes the product
+bool WarehouseSystem::processNextOrder() {
+    if (recorder != nullptr) recorder->call(TRACE_PROCESS);
+    if (orderQueue.isEmpty()) {
+        if (verbose) cout << Theme::INFO << "No orders to process." << RESET << endl;
+        return false;
     }
     
-    Order o = orderQueue.front();
-    orderQueue.pop();
+    Order o = orderQueue.dequeue();
+    long long dequeuedAt = orderTracer != nullptr ? OrderTracer::now() : 0;
     
-    Product* p = productsMap.get(o.productId);
+    Product* p = findProduct(o.productId);
     if (p == nullptr) {
-        cout << Theme::ERR << "Order #" << Theme::DATA << o.orderId 
-             << Theme::ERR << " failed: Product not found!" << RESET << endl;
-        return;
+        reportMissing(o);
+        traceOrder(o, dequeuedAt, false);
+        return false;
     }
     
     // Safety check: Ensure we have enough stock (in case stock was updated externally)
     if (p->quantity < o.quantity) {
-        cout << Theme::ERR << "Order #" << Theme::DATA << o.orderId 
-             << Theme::ERR << " failed: Insufficient stock!" << RESET << endl;
-        cout << Theme::INFO << "  Available: " << Theme::DATA << p->quantity 
-             << Theme::INFO << ", Required: " << Theme::DATA << o.quantity << RESET << endl;
-        return;
+        reportShortfall(o, p->quantity);
+        traceOrder(o, dequeuedAt, false);
+        return false;
     }
     
-    // Reduce quantity
+    // Reduce quantity and update salesCount (previous sales + current order quantity)
     p->quantity -= o.quantity;
-    
-    // Update quantity in AVLTree as well
+    p->salesCount += o.quantity;
+    recordFulfilment(o, p, p->quantity, p->salesCount);
+    traceOrder(o, dequeuedAt, true);
+    return true;
+}
+
+// remaining / salesCount are the product's counts right after this order; the
+// product itself may already be further along (parallel fulfilment)
+void WarehouseSystem::recordFulfilment(const Order& o, Product* p, int remaining, int salesCount) {
+    recordSale(o, remaining, salesCount);
+    updateRankings(o.productId, salesCount);
+    journalOrder(o);
+    finishOrder(o, p, remaining, salesCount);
+}
+
+void WarehouseSystem::recordSale(const Order& o, int remaining, int salesCount) {
+    // Update quantity and salesCount in AVLTree as well
     Product* treeProduct = productsTree.search(o.productId);
     if (treeProduct != nullptr) {
-        treeProduct->quantity = p->quantity;
+        treeProduct->quantity = remaining;
+        treeProduct->salesCount = salesCount;
     }
-    
-    // Update salesCount (previous sales + current order quantity)
-    p->salesCount += o.quantity;
-    
-    // Update salesCount in AVLTree
-    if (treeProduct != nullptr) {
-        treeProduct->salesCount = p->salesCount;
+    catalog.setCounts(o.productId, remaining, salesCount);
+    columns.setCounts(o.productId, remaining, salesCount);
+}
+
+// Update heaps with new salesCount (for best/lowest selling tracking)
+void WarehouseSystem::updateRankings(int productId, int salesCount) {
+    bestSellingHeap.update(productId, SalesEntry(productId, salesCount));
+    lowSellingHeap.update(productId, SalesEntry(productId, salesCount));
+}
+
+void WarehouseSystem::journalOrder(const Order& o) {
+    if (orderExporter != nullptr) {
+        orderExporter->append(o);
     }
-    
-    // Update heaps with new salesCount (for best/lowest selling tracking)
-    bestSellingHeap.increaseSales(o.productId, p->salesCount);
-    lowSellingHeap.IncreaseSales(o.productId, p->salesCount);
-    
-    cout << Theme::SUCCESS << "Processed Order #" << Theme::DATA << o.orderId 
+    if (orderHistory != nullptr) {
+        long long now = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+        orderHistory->append(o, now);
+    }
+}
+
+void WarehouseSystem::finishOrder(const Order& o, Product* p, int remaining, int salesCount) {
+    if (verbose) cout << Theme::SUCCESS << "Processed Order #" << Theme::DATA << o.orderId 
          << Theme::SUCCESS << ": " << Theme::DATA << p->name 
          << Theme::SUCCESS << " (Qty: " << Theme::DATA << o.quantity << Theme::SUCCESS << ")" << RESET << endl;
-    cout << Theme::INFO << "  Remaining stock: " << Theme::DATA << p->quantity 
-         << Theme::INFO << ", Total sales: " << Theme::DATA << p->salesCount << RESET << endl;
+    if (verbose) cout << Theme::INFO << "  Remaining stock: " << Theme::DATA << remaining 
+         << Theme::INFO << ", Total sales: " << Theme::DATA << salesCount << RESET << endl;
     
-    // If quantity reaches 0, remove product from AVLTree and HashMap
-    // (Product stays in heaps as they track sales history)
-    if (p->quantity == 0) {
-        removeProduct(o.productId);
+    // If quantity reaches 0, remove product from the catalog and the rankings
+    if (remaining == 0) {
+        eraseProduct(o.productId);
+    }
+}
+
+void WarehouseSystem::reportMissing(const Order& o) {
+    if (verbose) cout << Theme::ERR << "Order #" << Theme::DATA << o.orderId 
+         << Theme::ERR << " failed: Product not found!" << RESET << endl;
+}
+
+void WarehouseSystem::reportShortfall(const Order& o, int available) {
+    if (verbose) cout << Theme::ERR << "Order #" << Theme::DATA << o.orderId 
+         << Theme::ERR << " failed: Insufficient stock!" << RESET << endl;
+    if (verbose) cout << Theme::INFO << "  Available: " << Theme::DATA << available 
+         << Theme::INFO << ", Required: " << Theme::DATA << o.quantity << RESET << endl;
+}
+
+// One dequeued order on its way through processOrdersParallel
+struct ParallelFulfilment {
+    Order order;
+    Product* product;   // Resolved before the parallel phase, nullptr if unknown
+    long long dequeuedAt;
+    int remaining;      // Product quantity right after this order (or when it was refused)
+    int salesCount;
+    bool fulfilled;
+};
+
+// Orders only contend on their own product, so the stock check and decrement
+// run on the pool with the product ID as ordering key: one product's orders
+// stay in queue order, different products proceed in parallel. The tasks touch
+// nothing but their product; lookups (which update filter counters) happen
+// before, and the shared structures are brought up to date afterwards on this
+// thread, in queue order.
+int WarehouseSystem::processOrdersParallel(WorkStealingPool& pool, int limit, const function<void(const Order&)>& pick) {
+    if (recorder != nullptr) recorder->call(TRACE_PROCESS_BATCH, limit);
+    int n = orderQueue.getSize();
+    if (limit >= 0 && limit < n) n = limit;
+    if (n == 0) {
+        if (verbose) cout << Theme::INFO << "No orders to process." << RESET << endl;
+        return 0;
     }
+
+    vector<ParallelFulfilment> batch(n);
+    for (int i = 0; i < n; i++) {
+        ParallelFulfilment& f = batch[i];
+        f.order = orderQueue.dequeue();
+        f.dequeuedAt = orderTracer != nullptr ? OrderTracer::now() : 0;
+        f.product = findProduct(f.order.productId);
+        f.remaining = 0;
+        f.salesCount = 0;
+        f.fulfilled = false;
+    }
+
+    const function<void(const Order&)>* pickStep = &pick;
+    for (ParallelFulfilment& f : batch) {
+        if (f.product == nullptr) continue;
+        ParallelFulfilment* job = &f;
+        pool.submit(f.order.productId, [job, pickStep]() {
+            Product* p = job->product;
+            if (p->quantity >= job->order.quantity) {
+                if (*pickStep) (*pickStep)(job->order);
+                p->quantity -= job->order.quantity;
+                p->salesCount += job->order.quantity;
+                job->fulfilled = true;
+            }
+            job->remaining = p->quantity;
+            job->salesCount = p->salesCount;
+        });
+    }
+    pool.wait();
+
+    int fulfilled = 0;
+    for (ParallelFulfilment& f : batch) {
+        const Order& o = f.order;
+        // A product sold out by an earlier order in the batch has been removed since
+        Product* p = f.product != nullptr ? findProduct(o.productId) : nullptr;
+        if (p == nullptr) {
+            reportMissing(o);
+            traceOrder(o, f.dequeuedAt, false);
+            continue;
+        }
+        if (!f.fulfilled) {
+            reportShortfall(o, f.remaining);
+            traceOrder(o, f.dequeuedAt, false);
+            continue;
+        }
+        recordFulfilment(o, p, f.remaining, f.salesCount);
+        traceOrder(o, f.dequeuedAt, true);
+        fulfilled++;
+    }
+    return fulfilled;
+}
+
+// Next order processNextOrder would take, false if the queue is empty
+bool WarehouseSystem::peekNextOrder(Order& next) {
+    if (orderQueue.isEmpty()) return false;
+    next = orderQueue.peek();
+    return true;
 }
 
-// Print all orders in queue
+int WarehouseSystem::pendingOrderCount() {
+    return orderQueue.getSize();
+}
+
+// Print all orders in queue (from a snapshot)
 void WarehouseSystem::printOrders() {
-    if (orderQueue.empty()) {
+    CatalogSnapshot snap = pinSnapshot();
+    if (snap.pendingOrders.empty()) {
         cout << Theme::INFO << "No pending orders." << RESET << endl;
         return;
     }
-    queue<Order> tmp = orderQueue;
     cout << Theme::INFO << "Pending orders:" << RESET << endl;
-    while (!tmp.empty()) {
-        Order o = tmp.front();
-        tmp.pop();
+    for (const Order& o : snap.pendingOrders) {
         cout << Theme::INFO << "Order #" << Theme::DATA << o.orderId 
              << Theme::INFO << " | Product ID: " << Theme::DATA << o.productId
              << Theme::INFO << " | Qty: " << Theme::DATA << o.quantity 
@@ -192,15 +611,217 @@ void WarehouseSystem::printOrders() {
     }
 }
 
+string WarehouseSystem::productName(int productId) {
+    Product* p = findProduct(productId);
+    return p != nullptr ? p->name : "ID " + to_string(productId);
+}
+
+bool WarehouseSystem::lowestSelling(SalesEntry& out) {
+    if (recorder != nullptr) recorder->call(TRACE_LOWEST);
+    sweepHeapTombstones();
+    if (lowSellingHeap.isEmpty()) return false;
+    out = lowSellingHeap.top();
+    return true;
+}
+
+bool WarehouseSystem::bestSelling(SalesEntry& out) {
+    if (recorder != nullptr) recorder->call(TRACE_BEST);
+    sweepHeapTombstones();
+    if (bestSellingHeap.isEmpty()) return false;
+    out = bestSellingHeap.top();
+    return true;
+}
+
+int WarehouseSystem::rankedProductCount() {
+    return lowSellingHeap.size();
+}
+
+void WarehouseSystem::setHeapPolicy(HeapPolicy policy) {
+    if (recorder != nullptr) recorder->call(TRACE_HEAP_POLICY, policy);
+    heapPolicy = policy;
+    if (policy == HEAP_HARD_DELETE) sweepHeapTombstones();
+}
+
+void WarehouseSystem::compactHeaps() {
+    if (recorder != nullptr) recorder->call(TRACE_COMPACT);
+    sweepHeapTombstones();
+}
+
+// Not a client call, so it stays out of the trace; a replay sweeps on the
+// next ranking query instead
+void WarehouseSystem::sweepHeapsWhenIdle() {
+    sweepHeapTombstones();
+}
+
+// O(log n) per tombstone, then give back storage the heaps no longer need
+void WarehouseSystem::sweepHeapTombstones() {
+    if (heapTombstones.empty()) return;
+    for (int productId : heapTombstones) {
+        lowSellingHeap.remove(productId);
+        bestSellingHeap.remove(productId);
+    }
+    unordered_set<int>().swap(heapTombstones);
+    lowSellingHeap.shrinkToFit();
+    bestSellingHeap.shrinkToFit();
+}
+
+static bool sameProduct(const Product& a, const Product& b) {
+    return a.id == b.id && a.name == b.name && a.category == b.category && a.quantity == b.quantity
+        && a.price == b.price && a.salesCount == b.salesCount;
+}
+
+bool WarehouseSystem::checkConsistency(string& problem) {
+    // The store itself: an ID lives in the frozen table or the overlay, not both
+    string mapProblem;
+    if (!productsMap.checkInvariants(mapProblem)) {
+        problem = "overlay: " + mapProblem;
+        return false;
+    }
+    map<int, const Product*> store;
+    bool duplicate = false;
+    frozenProducts.forEach([&store](Product& p) { store[p.id] = &p; });
+    productsMap.forEach([&store, &duplicate](Product& p) { duplicate = !store.emplace(p.id, &p).second || duplicate; });
+    if (duplicate || (int)store.size() != productCount()) {
+        problem = "store: an ID is both frozen and in the overlay";
+        return false;
+    }
+    int n = (int)store.size();
+
+    string treeProblem;
+    if (!productsTree.checkInvariants(treeProblem)) {
+        problem = "ID index: " + treeProblem;
+        return false;
+    }
+    vector<Product> rows;
+    productsTree.collectAfter(false, 0, 0, 0, rows);
+    if ((int)rows.size() != n) {
+        problem = "ID index: " + to_string(rows.size()) + " products, store has " + to_string(n);
+        return false;
+    }
+    int row = 0;
+    for (const pair<const int, const Product*>& entry : store) {
+        if (!sameProduct(rows[row++], *entry.second)) {
+            problem = "ID index: product " + to_string(entry.first) + " differs from the store";
+            return false;
+        }
+    }
+
+    // The filter may pass unknown IDs but must never reject a stored one
+    for (const pair<const int, const Product*>& entry : store) {
+        if (!idFilter.mayContain(entry.first)) {
+            problem = "ID filter: rejects stored product " + to_string(entry.first);
+            return false;
+        }
+    }
+    if (idFilter.size() != n) {
+        problem = "ID filter: " + to_string(idFilter.size()) + " keys, store has " + to_string(n);
+        return false;
+    }
+
+    CatalogSnapshot snap = catalog.snapshot();
+    bool catalogMatches = snap.productCount() == n;
+    snap.forEachProduct([&store, &catalogMatches](const Product& p) {
+        map<int, const Product*>::const_iterator it = store.find(p.id);
+        catalogMatches = catalogMatches && it != store.end() && sameProduct(p, *it->second);
+    });
+    if (!catalogMatches) {
+        problem = "catalog: differs from the store";
+        return false;
+    }
+
+    if (columns.size() != n) {
+        problem = "columns: " + to_string(columns.size()) + " rows, store has " + to_string(n);
+        return false;
+    }
+    for (const pair<const int, const Product*>& entry : store) {
+        if (!columns.holds(*entry.second)) {
+            problem = "columns: row of product " + to_string(entry.first) + " differs from the store";
+            return false;
+        }
+    }
+
+    bool pricesMatch = priceIndex.getSize() == n;
+    int priced = 0;
+    PriceKey previous;
+    priceIndex.ascending([&](const PriceKey& k) {
+        map<int, const Product*>::const_iterator it = store.find(k.id);
+        pricesMatch = pricesMatch && it != store.end() && it->second->price == k.price && (priced == 0 || previous < k);
+        previous = k;
+        priced++;
+        return pricesMatch;
+    });
+    if (!pricesMatch || priced != n) {
+        problem = "price index: differs from the store or out of order";
+        return false;
+    }
+
+    if (nameIndex.productCount() != n) {
+        problem = "name index: " + to_string(nameIndex.productCount()) + " products, store has " + to_string(n);
+        return false;
+    }
+
+    // Both heaps hold every live product with its sales count, plus the tombstones
+    if (!lowSellingHeap.isValid() || !bestSellingHeap.isValid()) {
+        problem = "heaps: heap order or position index broken";
+        return false;
+    }
+    if (heapPolicy == HEAP_HARD_DELETE && !heapTombstones.empty()) {
+        problem = "heaps: tombstones left under hard delete";
+        return false;
+    }
+    int ranked = n + (int)heapTombstones.size();
+    if (lowSellingHeap.size() != ranked || bestSellingHeap.size() != ranked) {
+        problem = "heaps: " + to_string(lowSellingHeap.size()) + " / " + to_string(bestSellingHeap.size())
+                + " entries, expected " + to_string(ranked);
+        return false;
+    }
+    for (const pair<const int, const Product*>& entry : store) {
+        const SalesEntry* low = lowSellingHeap.find(entry.first);
+        const SalesEntry* best = bestSellingHeap.find(entry.first);
+        if (low == nullptr || best == nullptr || low->salesCount != entry.second->salesCount
+            || best->salesCount != entry.second->salesCount) {
+            problem = "heaps: entry of product " + to_string(entry.first) + " missing or stale";
+            return false;
+        }
+    }
+    for (int productId : heapTombstones) {
+        if (store.count(productId) != 0 || !lowSellingHeap.contains(productId) || !bestSellingHeap.contains(productId)) {
+            problem = "heaps: tombstone " + to_string(productId) + " is live or not in the heaps";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Heap contents in array order, then the root (tombstones are swept first)
+template <typename SalesHeapType>
+void WarehouseSystem::printSalesHeap(const SalesHeapType& heap, const char* rootLabel) {
+    sweepHeapTombstones();
+    if (heap.isEmpty()) {
+        cout << "Heap is empty." << endl;
+        return;
+    }
+    for (int i = 0; i < heap.size(); i++)
+        cout << productName(heap.at(i).productId) << " (sales: " << heap.at(i).salesCount << ")  ";
+    cout << endl;
+    cout << "Root (" << rootLabel << "): " << productName(heap.top().productId) 
+         << " with salesCount = " << heap.top().salesCount << endl;
+}
+
 // Print heaps
 void WarehouseSystem::printLowSellingHeap() {
     cout << Theme::INFO << "Lowest selling products (by sales count): " << RESET;
-    lowSellingHeap.printHeap();
+    printSalesHeap(lowSellingHeap, "lowest selling");
 }
 
 void WarehouseSystem::printBestSellingHeap() {
     cout << Theme::SUCCESS << "Best selling products (by sales count): " << RESET;
-    bestSellingHeap.printHeap();
+    printSalesHeap(bestSellingHeap, "best selling");
+}
+
+// Turn status messages from the mutating calls on or off (reports always print)
+void WarehouseSystem::setVerbose(bool on) {
+    verbose = on;
 }
 
 // Destructor
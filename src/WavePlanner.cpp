@@ -0,0 +1,211 @@
+#include "../include/WavePlanner.h"
+#include "../include/Colors.h"
+#include <algorithm>
+#include <cstdio>
+
+using namespace Colors;
+
+WavePlanner::WavePlanner(WarehouseSystem& w)
+    : warehouse(w), slotMask(0), slotShift(28), firstOrderId(0), lastOrderId(0), fulfilled(0), picked(0), planned(false) {}
+
+// Fibonacci hashing: the top bits of the product depend on every bit of the
+// ID, the low bits only on the low bits, so strided IDs would pile up there
+int WavePlanner::lineFor(const Order& o) {
+    unsigned slot = ((unsigned)o.productId * 0x9E3779B1u) >> slotShift;
+    while (slotLines[slot] >= 0) {
+        if (slotKeys[slot] == o.productId) return slotLines[slot];
+        slot = (slot + 1) & slotMask;
+    }
+    int index = (int)waveLines.size();
+    slotKeys[slot] = o.productId;
+    slotLines[slot] = index;
+
+    // First order for this product: the only lookup it gets during planning
+    Product* p = warehouse.findProduct(o.productId);
+    WaveLine line;
+    line.productId = o.productId;
+    line.available = -1;
+    if (p != nullptr) {
+        line.name = p->name;
+        line.category = p->category;
+        line.available = p->quantity;
+    }
+    line.picked = 0;
+    line.orders = 0;
+    line.refused = 0;
+    waveLines.push_back(std::move(line));
+    lineProducts.push_back(p);
+    return index;
+}
+
+// One pass over the window. A product is looked up once, on its first order;
+// later orders only touch its line. An order fits if the stock left after the
+// earlier orders of the wave covers it, and a product that reaches zero is
+// gone for the rest of the wave, exactly as processNextOrder would remove it.
+int WavePlanner::plan(int limit) {
+    int n = warehouse.orderQueue.getSize();
+    if (limit >= 0 && limit < n) n = limit;
+
+    waveLines.clear();
+    waveZones.clear();
+    lineProducts.clear();
+    zoneOf.clear();
+    orderLine.resize(n);
+    orderLeft.resize(n);
+    unsigned slots = 16;
+    slotShift = 28;
+    while (slots < 2u * (unsigned)n) {
+        slots *= 2;
+        slotShift--;
+    }
+    if (slotLines.size() < slots) {
+        slotKeys.resize(slots);
+        slotLines.resize(slots);
+    }
+    slotMask = slots - 1;
+    fill(slotLines.begin(), slotLines.begin() + slots, -1);
+    fulfilled = 0;
+    picked = 0;
+
+    for (int i = 0; i < n; i++) {
+        const Order& o = warehouse.orderQueue.at(i);
+        int index = lineFor(o);
+        WaveLine& line = waveLines[index];
+        int left = line.available - line.picked;
+        bool soldOut = line.orders > 0 && left == 0;
+        orderLine[i] = index;
+        if (line.available >= 0 && !soldOut && left >= o.quantity) {
+            line.picked += o.quantity;
+            line.orders++;
+            orderLeft[i] = left - o.quantity;
+            fulfilled++;
+            picked += o.quantity;
+        } else {
+            line.refused++;
+            orderLeft[i] = -1;
+        }
+    }
+
+    // Products were mostly added in ID order, so their tree nodes, catalog
+    // slots and column rows are visited with far fewer cache misses by ID
+    const vector<WaveLine>& lines = waveLines;
+    lineOrder.resize(waveLines.size());
+    for (int i = 0; i < (int)lineOrder.size(); i++) lineOrder[i] = i;
+    sort(lineOrder.begin(), lineOrder.end(), [&lines](int a, int b) { return lines[a].productId < lines[b].productId; });
+
+    // Pick lists: known products by category, categories and IDs ascending
+    for (int i : lineOrder) {
+        const WaveLine& line = waveLines[i];
+        if (line.available < 0) continue;
+        pair<unordered_map<string, int>::iterator, bool> slot = zoneOf.emplace(line.category, (int)waveZones.size());
+        if (slot.second) {
+            WaveZone zone;
+            zone.category = line.category;
+            zone.picked = 0;
+            zone.orders = 0;
+            waveZones.push_back(zone);
+        }
+        WaveZone& zone = waveZones[slot.first->second];
+        zone.picked += line.picked;
+        zone.orders += line.orders;
+        zone.lines.push_back(i);
+    }
+    sort(waveZones.begin(), waveZones.end(), [](const WaveZone& a, const WaveZone& b) { return a.category < b.category; });
+
+    firstOrderId = n > 0 ? warehouse.orderQueue.at(0).orderId : 0;
+    lastOrderId = n > 0 ? warehouse.orderQueue.at(n - 1).orderId : 0;
+    planned = true;
+    return n;
+}
+
+// The window must still head the queue (urgent orders jump in at the front)
+// and every planned product must still be there with the stock it had
+bool WavePlanner::stillValid() {
+    int n = (int)orderLine.size();
+    if (warehouse.orderQueue.getSize() < n) return false;
+    if (n > 0 && (warehouse.orderQueue.at(0).orderId != firstOrderId || warehouse.orderQueue.at(n - 1).orderId != lastOrderId)) {
+        return false;
+    }
+    for (int i = 0; i < (int)waveLines.size(); i++) {
+        Product* p = warehouse.findProduct(waveLines[i].productId);
+        if (p == nullptr ? waveLines[i].available >= 0 : p->quantity != waveLines[i].available) return false;
+        lineProducts[i] = p;
+    }
+    return true;
+}
+
+int WavePlanner::commit() {
+    if (!planned || !stillValid()) return -1;
+    planned = false;
+    int n = (int)orderLine.size();
+    if (warehouse.recorder != nullptr) warehouse.recorder->call(TRACE_WAVE, n);
+    if (n == 0) return 0;
+
+    // Stock and sales, then every copy and both rankings, once per product
+    for (int i : lineOrder) {
+        const WaveLine& line = waveLines[i];
+        if (line.orders == 0) continue;
+        Product* p = lineProducts[i];
+        p->quantity -= line.picked;
+        p->salesCount += line.picked;
+        Order key(0, line.productId, line.picked);
+        warehouse.recordSale(key, p->quantity, p->salesCount);
+        warehouse.updateRankings(line.productId, p->salesCount);
+    }
+
+    long long dequeuedAt = warehouse.orderTracer != nullptr ? OrderTracer::now() : 0;
+    for (int i = 0; i < n; i++) {
+        Order o = warehouse.orderQueue.dequeue();
+        if (orderLeft[i] >= 0) {
+            warehouse.journalOrder(o);
+            warehouse.traceOrder(o, dequeuedAt, true);
+            continue;
+        }
+        const WaveLine& line = waveLines[orderLine[i]];
+        if (line.available < 0) warehouse.reportMissing(o);
+        else warehouse.reportShortfall(o, line.available - line.picked);
+        warehouse.traceOrder(o, dequeuedAt, false);
+    }
+
+    for (int i : lineOrder) {
+        const WaveLine& line = waveLines[i];
+        if (line.orders > 0 && line.available == line.picked) warehouse.eraseProduct(line.productId);
+    }
+    if (warehouse.verbose) {
+        cout << Theme::SUCCESS << "Wave committed: " << Theme::DATA << fulfilled << Theme::SUCCESS << " of "
+             << Theme::DATA << n << Theme::SUCCESS << " orders fulfilled, " << Theme::DATA << picked
+             << Theme::SUCCESS << " units from " << Theme::DATA << waveLines.size() << Theme::SUCCESS
+             << " products" << RESET << endl;
+    }
+    return fulfilled;
+}
+
+void WavePlanner::printPickLists(int maxLines) {
+    if (!planned) {
+        cout << Theme::INFO << "No wave planned." << RESET << endl;
+        return;
+    }
+    cout << Theme::HEADER << "Wave of " << orderLine.size() << " orders: " << fulfilled << " fit, "
+         << picked << " units in " << waveZones.size() << " pick lists" << RESET << endl;
+    for (const WaveZone& zone : waveZones) {
+        cout << Theme::INFO << zone.category << ": " << Theme::DATA << zone.picked << Theme::INFO << " units for "
+             << Theme::DATA << zone.orders << Theme::INFO << " orders" << RESET << endl;
+        int shown = 0;
+        for (int index : zone.lines) {
+            const WaveLine& line = waveLines[index];
+            if (maxLines > 0 && shown++ == maxLines) {
+                cout << Theme::INFO << "  ... " << zone.lines.size() - maxLines << " more" << RESET << endl;
+                break;
+            }
+            printf("  %8d  %-24s pick %6d of %6d  (%d orders", line.productId, line.name.c_str(), line.picked,
+                   line.available, line.orders);
+            if (line.refused > 0) printf(", %d refused", line.refused);
+            printf(")\n");
+        }
+    }
+    int unknown = 0;
+    for (const WaveLine& line : waveLines) {
+        if (line.available < 0) unknown += line.refused;
+    }
+    if (unknown > 0) cout << Theme::WARNING << unknown << " orders name unknown products" << RESET << endl;
+}
@@ -0,0 +1,180 @@
+#include "../include/WorkStealingPool.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Pool and index of the worker running on this thread, so tasks submitted from
+// inside a task go to that worker's own deque
+static thread_local WorkStealingPool* currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+WorkStealingPool::WorkStealingPool(int workerCount, bool pinToCpus)
+    : queued(0), unfinished(0), nextWorker(0), stopping(false) {
+    if (workerCount <= 0) workerCount = (int)thread::hardware_concurrency();
+    if (workerCount <= 0) workerCount = 1;
+
+    // Every worker exists before any of them can try to steal
+    for (int i = 0; i < workerCount; i++) workers.push_back(new PoolWorker());
+    for (int i = 0; i < workerCount; i++) workers[i]->worker = thread(workerLoop, this, i);
+
+#ifdef __linux__
+    if (pinToCpus) {
+        // Spread the workers round-robin over the CPUs this process is allowed on
+        cpu_set_t allowed;
+        vector<int> cpus;
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+            }
+        }
+        for (int i = 0; i < workerCount && !cpus.empty(); i++) {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(cpus[i % cpus.size()], &one);
+            workers[i]->pinned = pthread_setaffinity_np(workers[i]->worker.native_handle(), sizeof(one), &one) == 0;
+        }
+    }
+#else
+    (void)pinToCpus;
+#endif
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        lock_guard<mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (PoolWorker* w : workers) {
+        w->worker.join();
+        delete w;
+    }
+}
+
+int WorkStealingPool::pinnedCount() {
+    int n = 0;
+    for (PoolWorker* w : workers) {
+        if (w->pinned) n++;
+    }
+    return n;
+}
+
+// Own deque from a worker of this pool, otherwise round-robin
+void WorkStealingPool::push(PoolTask&& task) {
+    int target = currentPool == this ? currentWorker : (int)(nextWorker++ % workers.size());
+    PoolWorker* w = workers[target];
+    {
+        lock_guard<mutex> guard(w->lock);
+        w->tasks.push_back(std::move(task));
+    }
+    queued++;
+    {
+        // Taking the lock orders this with a worker that is about to sleep
+        lock_guard<mutex> guard(sleepLock);
+    }
+    wake.notify_one();
+}
+
+void WorkStealingPool::submit(function<void()> task) {
+    unfinished++;
+    push(PoolTask(std::move(task), 0, false));
+}
+
+void WorkStealingPool::submit(int key, function<void()> task) {
+    unfinished++;
+    PoolKeyShard& shard = keyShards[(unsigned)key % POOL_KEY_SHARDS];
+    {
+        lock_guard<mutex> guard(shard.lock);
+        unordered_map<int, deque<function<void()>>>::iterator it = shard.waiting.find(key);
+        if (it != shard.waiting.end()) {
+            // A task for this key is queued or running, it will hand this one on
+            it->second.push_back(std::move(task));
+            return;
+        }
+        shard.waiting[key];
+    }
+    push(PoolTask(std::move(task), key, true));
+}
+
+// Newest task from the own deque (still warm in cache), else the oldest from another
+bool WorkStealingPool::take(int index, PoolTask& out) {
+    PoolWorker* own = workers[index];
+    {
+        lock_guard<mutex> guard(own->lock);
+        if (!own->tasks.empty()) {
+            out = std::move(own->tasks.back());
+            own->tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    int n = (int)workers.size();
+    for (int i = 1; i < n; i++) {
+        PoolWorker* victim = workers[(index + i) % n];
+        lock_guard<mutex> guard(victim->lock);
+        if (!victim->tasks.empty()) {
+            out = std::move(victim->tasks.front());
+            victim->tasks.pop_front();
+            queued--;
+            own->stolen++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::finished() {
+    if (--unfinished == 0) {
+        lock_guard<mutex> guard(sleepLock);
+        idle.notify_all();
+    }
+}
+
+// Run a task; for a keyed one keep running the tasks parked behind it until its key is free
+void WorkStealingPool::execute(int index, PoolTask& task) {
+    PoolWorker* w = workers[index];
+    task.run();
+    w->executed++;
+    finished();
+    if (!task.keyed) return;
+
+    PoolKeyShard& shard = keyShards[(unsigned)task.key % POOL_KEY_SHARDS];
+    while (true) {
+        function<void()> next;
+        {
+            lock_guard<mutex> guard(shard.lock);
+            unordered_map<int, deque<function<void()>>>::iterator it = shard.waiting.find(task.key);
+            if (it->second.empty()) {
+                shard.waiting.erase(it);
+                return;
+            }
+            next = std::move(it->second.front());
+            it->second.pop_front();
+        }
+        next();
+        w->executed++;
+        finished();
+    }
+}
+
+void WorkStealingPool::workerLoop(WorkStealingPool* pool, int index) {
+    currentPool = pool;
+    currentWorker = index;
+    PoolTask task;
+    while (true) {
+        if (pool->take(index, task)) {
+            pool->execute(index, task);
+            continue;
+        }
+        unique_lock<mutex> guard(pool->sleepLock);
+        pool->wake.wait(guard, [pool]() { return pool->stopping || pool->queued.load() > 0; });
+        if (pool->stopping && pool->queued.load() == 0) return;
+    }
+}
+
+void WorkStealingPool::wait() {
+    unique_lock<mutex> guard(sleepLock);
+    idle.wait(guard, [this]() { return unfinished.load() == 0; });
+}
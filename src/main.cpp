@@ -1,15 +1,37 @@
 #include "../include/WarehouseSystem.h"
 #include "../include/Colors.h"
 #include "../src/Product.cpp"
-#include "../src/MinHeap.cpp"
-#include "../src/MaxHeap.cpp"
 #include "../src/HashMap.cpp"
+#include "../src/FrozenCatalog.cpp"
+#include "../src/CuckooFilter.cpp"
 #include "../src/AVLTree.cpp"
+#include "../src/BPlusTree.cpp"
 #include "../src/OrderQueue.cpp"
+#include "../src/VersionedCatalog.cpp"
+#include "../src/CatalogListing.cpp"
+#include "../src/ColumnarExport.cpp"
+#include "../src/OperationTrace.cpp"
+#include "../src/OrderHistory.cpp"
+#include "../src/OrderTracing.cpp"
+#include "../src/ProductColumns.cpp"
+#include "../src/PriceIndex.cpp"
+#include "../src/NameIndex.cpp"
+#include "../src/WorkStealingPool.cpp"
+#include "../src/OrderPipeline.cpp"
+#include "../src/WavePlanner.cpp"
+#include "../src/Benchmarks.cpp"
+#include "../src/AllocationCheck.cpp"
+#include "../src/DifferentialCheck.cpp"
+#include "../src/LoadSimulator.cpp"
+#include "../src/WarehouseFederation.cpp"
+#include "../src/Checkpointer.cpp"
+#include "../src/TraceReplayer.cpp"
+#include "../src/WarehouseServer.cpp"
 #include "../src/WarehouseSystem.cpp"
 
 #include <iostream>
 #include <iomanip>
+#include <csignal>
 
 using namespace std;
 using namespace Colors;
@@ -127,12 +149,38 @@ void updateStockMenu(WarehouseSystem &warehouse)
 
 void searchProductMenu(WarehouseSystem &warehouse)
 {
-    int id;
+    string text;
     cout << "\n" << Theme::HEADER << "--- Search Product ---" << RESET << endl;
-    cout << Theme::PROMPT << "Enter Product ID: " << RESET;
-    cin >> id;
+    cout << Theme::PROMPT << "Enter Product ID or name: " << RESET;
+    cin >> ws;
+    while (cin.peek() != '\n' && cin.peek() != EOF) // Leave the newline, like cin >> id did
+        text += (char)cin.get();
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\r'))
+        text.pop_back();
+
+    // Anything but a plain number is a name query: list the best matches
+    if (text.empty() || text.find_first_not_of("0123456789") != string::npos)
+    {
+        vector<NameMatch> matches = warehouse.searchByName(text, 10);
+        if (matches.empty())
+        {
+            cout << Theme::ERR << "No products match '" << text << "'" << RESET << endl;
+            return;
+        }
+        cout << "\n" << Theme::HEADER << "--- Matching Products ---" << RESET << endl;
+        for (const NameMatch &m : matches)
+        {
+            Product *p = warehouse.searchProduct(m.productId);
+            if (p == nullptr)
+                continue;
+            cout << Theme::INFO << "ID: " << Theme::DATA << p->id << Theme::INFO << "  Name: " << Theme::DATA << p->name
+                 << Theme::INFO << "  Qty: " << Theme::DATA << p->quantity << fixed << setprecision(2)
+                 << Theme::INFO << "  Price: $" << Theme::DATA << p->price << RESET << endl;
+        }
+        return;
+    }
 
-    Product *p = warehouse.searchProduct(id);
+    Product *p = warehouse.searchProduct(atoi(text.c_str()));
     if (p == nullptr)
     {
         cout << Theme::ERR << "Product not found!" << RESET << endl;
@@ -148,6 +196,55 @@ void searchProductMenu(WarehouseSystem &warehouse)
     cout << Theme::INFO << "Total Sales: " << Theme::DATA << p->salesCount << RESET << endl;
 }
 
+void listProductsMenu(WarehouseSystem &warehouse)
+{
+    ListingQuery query;
+    int sortChoice;
+    char desc;
+
+    cout << "\n" << Theme::HEADER << "--- All Products ---" << RESET << endl;
+    cout << Theme::PROMPT << "Sort by (1) ID (2) Name (3) Price (4) Quantity (5) Sales: " << RESET;
+    cin >> sortChoice;
+    if (sortChoice < 1 || sortChoice > 5)
+    {
+        cout << Theme::ERR << "Invalid sort option!" << RESET << endl;
+        return;
+    }
+    query.sortBy = (ListingSort)(sortChoice - 1);
+
+    cout << Theme::PROMPT << "Descending order? (y/n): " << RESET;
+    cin >> desc;
+    query.descending = (desc == 'y' || desc == 'Y');
+
+    cout << Theme::PROMPT << "Page size (0 = all): " << RESET;
+    cin >> query.limit;
+    if (query.limit < 0)
+    {
+        cout << Theme::ERR << "Invalid page size!" << RESET << endl;
+        return;
+    }
+
+    while (true)
+    {
+        ListingPage page = warehouse.listProducts(query);
+        if (page.rows.empty())
+        {
+            cout << Theme::INFO << "No products to display." << RESET << endl;
+            return;
+        }
+        CatalogListing::print(page);
+        if (!page.hasMore)
+            return;
+
+        char more;
+        cout << Theme::PROMPT << "Show next page? (y/n): " << RESET;
+        cin >> more;
+        if (more != 'y' && more != 'Y')
+            return;
+        query.cursor = page.next;
+    }
+}
+
 void placeOrderMenu(WarehouseSystem &warehouse)
 {
     int id, qty;
@@ -177,14 +274,348 @@ void placeOrderMenu(WarehouseSystem &warehouse)
     warehouse.placeOrder(id, qty);
 }
 
-int main()
+// Server started by "serve", stopped by Ctrl+C
+static WarehouseServer *activeServer = nullptr;
+
+static void stopServer(int)
+{
+    if (activeServer != nullptr)
+        activeServer->stop();
+}
+
+// serve [port=N] [unix=/path] [checkpoint=/path every=s rate=MB/s] [orders=/path format=csv] [history]
+//       [heaps=tombstones] [workers=N [pin]] [trace[=/path.json] sample=N]:
+// line-protocol server, restored from the checkpoint file if one exists,
+// optionally streaming processed orders to an export file and keeping their history
+int serve(int argc, char *argv[])
 {
+    int port = 7070;
+    string unixPath;
+    string checkpointPath;
+    double checkpointEvery = 60;
+    double checkpointRate = 0;
+    string ordersPath;
+    ExportFormat format = EXPORT_COLUMNAR;
+    bool keepHistory = false;
+    HeapPolicy heapPolicy = HEAP_HARD_DELETE;
+    int workers = 0;
+    bool pinWorkers = false;
+    bool tracing = false;
+    string tracePath;
+    int traceSample = 100;
+    string recordPath;
+    for (int i = 0; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg.compare(0, 5, "port=") == 0)
+            port = atoi(arg.c_str() + 5);
+        else if (arg.compare(0, 5, "unix=") == 0)
+            unixPath = arg.substr(5);
+        else if (arg.compare(0, 11, "checkpoint=") == 0)
+            checkpointPath = arg.substr(11);
+        else if (arg.compare(0, 6, "every=") == 0)
+            checkpointEvery = atof(arg.c_str() + 6);
+        else if (arg.compare(0, 5, "rate=") == 0)
+            checkpointRate = atof(arg.c_str() + 5);
+        else if (arg.compare(0, 7, "orders=") == 0)
+            ordersPath = arg.substr(7);
+        else if (arg == "format=csv")
+            format = EXPORT_CSV;
+        else if (arg == "history")
+            keepHistory = true;
+        else if (arg == "heaps=tombstones")
+            heapPolicy = HEAP_TOMBSTONES;
+        else if (arg.compare(0, 8, "workers=") == 0)
+            workers = atoi(arg.c_str() + 8);
+        else if (arg == "pin")
+            pinWorkers = true;
+        else if (arg == "trace")
+            tracing = true;
+        else if (arg.compare(0, 6, "trace=") == 0)
+        {
+            tracing = true;
+            tracePath = arg.substr(6);
+        }
+        else if (arg.compare(0, 7, "sample=") == 0)
+            traceSample = atoi(arg.c_str() + 7);
+        else if (arg.compare(0, 7, "record=") == 0)
+            recordPath = arg.substr(7);
+        else
+        {
+            cout << Theme::ERR << "Unknown server option: " << arg << RESET << endl;
+            return 1;
+        }
+    }
+
+    WarehouseSystem warehouse(1000, 1000, 16);
+    warehouse.setVerbose(false);
+    warehouse.setHeapPolicy(heapPolicy);
+    WarehouseServer server(warehouse);
+
+    // Only a missing file is a fresh start: serving from a damaged one would
+    // overwrite the last good checkpoint with partial state
+    if (!checkpointPath.empty())
+    {
+        bool missing = false;
+        if (Checkpointer::load(checkpointPath, warehouse, &missing))
+            cout << Theme::INFO << "Restored " << warehouse.productCount() << " products and "
+                 << warehouse.pendingOrderCount() << " pending orders from " << checkpointPath << RESET << endl;
+        else if (missing)
+            cout << Theme::INFO << "No checkpoint at " << checkpointPath << " yet, starting empty" << RESET << endl;
+        else
+        {
+            cout << Theme::ERR << "Could not read checkpoint " << checkpointPath
+                 << " (unreadable or damaged); not serving over it" << RESET << endl;
+            return 1;
+        }
+    }
+
+    if (port > 0 && !server.listenTcp(port))
+    {
+        cout << Theme::ERR << "Could not listen on 127.0.0.1:" << port << RESET << endl;
+        return 1;
+    }
+    if (!unixPath.empty() && !server.listenUnix(unixPath))
+    {
+        cout << Theme::ERR << "Could not listen on " << unixPath << RESET << endl;
+        return 1;
+    }
+
+    Checkpointer *checkpointer = nullptr;
+    if (!checkpointPath.empty())
+    {
+        checkpointer = new Checkpointer(warehouse, checkpointPath, checkpointEvery, (long long)(checkpointRate * 1e6));
+        server.setCheckpointer(checkpointer);
+    }
+
+    OrderExporter *orderExporter = nullptr;
+    if (!ordersPath.empty())
+    {
+        orderExporter = new OrderExporter(ordersPath, format);
+        if (!orderExporter->isOpen())
+        {
+            cout << Theme::ERR << "Could not open " << ordersPath << RESET << endl;
+            delete orderExporter;
+            delete checkpointer;
+            return 1;
+        }
+        warehouse.setOrderExporter(orderExporter);
+    }
+
+    OrderHistory history;
+    if (keepHistory)
+        warehouse.setOrderHistory(&history);
+
+    // Samples are only kept when there is a file to dump them to
+    OrderTracer tracer(tracePath.empty() ? 0 : traceSample);
+    if (tracing)
+        warehouse.setOrderTracer(&tracer);
+
+    WorkStealingPool *pool = nullptr;
+    if (workers > 0)
+    {
+        pool = new WorkStealingPool(workers, pinWorkers);
+        server.setFulfilmentPool(pool);
+        cout << Theme::INFO << "Fulfilling orders on " << workers << " workers";
+        if (pinWorkers)
+            cout << " (" << pool->pinnedCount() << " pinned)";
+        cout << RESET << endl;
+    }
+
+    // The starting state goes next to the trace, so a replay can begin where the recording did
+    OperationRecorder *recorder = nullptr;
+    if (!recordPath.empty())
+    {
+        recorder = new OperationRecorder(recordPath);
+        if (!recorder->isOpen() || !Checkpointer::write(warehouse.takeSnapshot(), recordPath + ".start", 0, nullptr))
+        {
+            cout << Theme::ERR << "Could not open " << recordPath << " or write " << recordPath << ".start" << RESET << endl;
+            delete recorder;
+            delete pool;
+            delete orderExporter;
+            delete checkpointer;
+            return 1;
+        }
+        warehouse.setOperationRecorder(recorder);
+        cout << Theme::INFO << "Recording calls to " << recordPath << " (starting state in " << recordPath << ".start)" << RESET << endl;
+    }
+
+    cout << Theme::INFO << "Serving on";
+    if (port > 0)
+        cout << " 127.0.0.1:" << port;
+    if (!unixPath.empty())
+        cout << " " << unixPath;
+    cout << " (Ctrl+C to stop)" << RESET << endl;
+
+    activeServer = &server;
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+    int code = server.run();
+    activeServer = nullptr;
+    delete pool;
+
+    if (recorder != nullptr)
+    {
+        warehouse.setOperationRecorder(nullptr);
+        long long calls = recorder->recordCount();
+        if (recorder->close())
+            cout << Theme::INFO << "Recorded " << calls << " calls (" << recorder->bytesWritten() << " bytes) to " << recordPath << RESET << endl;
+        else
+        {
+            cout << Theme::ERR << "Could not write " << recordPath << RESET << endl;
+            code = 1;
+        }
+        delete recorder;
+    }
+
+    // Final checkpoint on shutdown
+    if (checkpointer != nullptr)
+    {
+        checkpointer->waitIdle();
+        checkpointer->checkpointNow();
+        checkpointer->waitIdle();
+        delete checkpointer;
+    }
+    warehouse.setOrderHistory(nullptr);
+    if (tracing)
+    {
+        warehouse.setOrderTracer(nullptr);
+        tracer.printSummary();
+        if (!tracePath.empty())
+        {
+            if (tracer.writeChromeTrace(tracePath))
+                cout << Theme::INFO << "Wrote " << tracer.sampleCount() << " sampled orders to " << tracePath << RESET << endl;
+            else
+            {
+                cout << Theme::ERR << "Could not write " << tracePath << RESET << endl;
+                code = 1;
+            }
+        }
+    }
+    if (orderExporter != nullptr)
+    {
+        warehouse.setOrderExporter(nullptr);
+        if (!orderExporter->close())
+            code = 1;
+        delete orderExporter;
+    }
+    return code;
+}
+
+// export checkpoint=/path products=/path [format=csv]: catalog of a checkpoint for analytics
+int exportCatalog(int argc, char *argv[])
+{
+    string checkpointPath, productsPath;
+    ExportFormat format = EXPORT_COLUMNAR;
+    for (int i = 0; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg.compare(0, 11, "checkpoint=") == 0)
+            checkpointPath = arg.substr(11);
+        else if (arg.compare(0, 9, "products=") == 0)
+            productsPath = arg.substr(9);
+        else if (arg == "format=csv")
+            format = EXPORT_CSV;
+        else
+        {
+            cout << Theme::ERR << "Unknown export option: " << arg << RESET << endl;
+            return 1;
+        }
+    }
+    if (checkpointPath.empty() || productsPath.empty())
+    {
+        cout << "Usage: export checkpoint=<file> products=<file> [format=csv]" << endl;
+        return 1;
+    }
+
+    WarehouseSystem warehouse(1000, 1000, 16);
+    warehouse.setVerbose(false);
+    if (!Checkpointer::load(checkpointPath, warehouse))
+    {
+        cout << Theme::ERR << "Could not read checkpoint " << checkpointPath << RESET << endl;
+        return 1;
+    }
+    if (!ColumnarExport::exportCatalog(warehouse.takeSnapshot(), productsPath, format))
+    {
+        cout << Theme::ERR << "Could not write " << productsPath << RESET << endl;
+        return 1;
+    }
+    cout << Theme::SUCCESS << "Exported " << warehouse.productCount() << " products to " << productsPath << RESET << endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Non-interactive modes
+    if (argc > 1 && string(argv[1]) == "bench")
+    {
+        return Benchmarks::run(argc - 2, argv + 2);
+    }
+    if (argc > 1 && string(argv[1]) == "simulate")
+    {
+        SimulationConfig config;
+        for (int i = 2; i < argc; i++)
+        {
+            string arg = argv[i];
+            size_t eq = arg.find('=');
+            if (eq == string::npos || !config.set(arg.substr(0, eq), arg.substr(eq + 1)))
+            {
+                cout << Theme::ERR << "Unknown simulation option: " << arg << RESET << endl;
+                return 1;
+            }
+        }
+        return LoadSimulator(config).run();
+    }
+    if (argc > 1 && string(argv[1]) == "alloc-check")
+    {
+        return AllocationCheck::run(argc > 2 ? atoi(argv[2]) : 1000000);
+    }
+    if (argc > 1 && string(argv[1]) == "verify")
+    {
+        VerifyConfig config;
+        for (int i = 2; i < argc; i++)
+        {
+            string arg = argv[i];
+            size_t eq = arg.find('=');
+            if (eq == string::npos || !config.set(arg.substr(0, eq), arg.substr(eq + 1)))
+            {
+                cout << Theme::ERR << "Unknown verify option: " << arg << RESET << endl;
+                return 1;
+            }
+        }
+        return DifferentialCheck(config).run();
+    }
+    if (argc > 1 && string(argv[1]) == "replay")
+    {
+        ReplayConfig config;
+        for (int i = 2; i < argc; i++)
+        {
+            string arg = argv[i];
+            size_t eq = arg.find('=');
+            if (eq == string::npos || !config.set(arg.substr(0, eq), arg.substr(eq + 1)))
+            {
+                cout << Theme::ERR << "Unknown replay option: " << arg << RESET << endl;
+                return 1;
+            }
+        }
+        return TraceReplayer(config).run();
+    }
+    if (argc > 1 && string(argv[1]) == "export")
+    {
+        return exportCatalog(argc - 2, argv + 2);
+    }
+    if (argc > 1 && string(argv[1]) == "serve")
+    {
+        return serve(argc - 2, argv + 2);
+    }
+
     // Enable ANSI colors on Windows
     enableColors();
     
     // Initialize warehouse system with default capacities
-    // Note: HashMap will automatically resize when needed (load factor > 0.75)
-    // Heaps have fixed capacity, so we set a reasonable default
+    // Note: HashMap will automatically resize when needed (load factor > 0.75),
+    // spreading the rehash over the following inserts and removes
+    // Heaps grow on demand too; these are just their initial capacities
     const int DEFAULT_MIN_HEAP_CAP = 1000;  // For lowest selling products
     const int DEFAULT_MAX_HEAP_CAP = 1000;  // For best selling products
     const int DEFAULT_HASHMAP_CAP = 16;      // Will auto-resize dynamically
@@ -192,9 +623,9 @@ int main()
     cout << Theme::HEADER << "========== WAREHOUSE MANAGEMENT SYSTEM ==========" << RESET << endl;
     cout << Theme::INFO << "Initializing system with default capacities..." << RESET << endl;
     cout << Theme::INFO << "  MinHeap: " << Theme::DATA << DEFAULT_MIN_HEAP_CAP 
-         << Theme::INFO << " (lowest selling products)" << RESET << endl;
+         << Theme::INFO << " (lowest selling products, grows as needed)" << RESET << endl;
     cout << Theme::INFO << "  MaxHeap: " << Theme::DATA << DEFAULT_MAX_HEAP_CAP 
-         << Theme::INFO << " (best selling products)" << RESET << endl;
+         << Theme::INFO << " (best selling products, grows as needed)" << RESET << endl;
     cout << Theme::INFO << "  HashMap: " << Theme::DATA << DEFAULT_HASHMAP_CAP 
          << Theme::INFO << " (auto-resizes dynamically)" << RESET << endl;
 
@@ -229,8 +660,7 @@ int main()
             break;
 
         case 5:
-            cout << "\n" << Theme::HEADER << "--- All Products ---" << RESET << endl;
-            warehouse.displayAllProducts();
+            listProductsMenu(warehouse);
             break;
 
         case 6: